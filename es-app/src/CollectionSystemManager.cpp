@@ -382,6 +382,14 @@ void CollectionSystemManager::updateSystemsList()
 	// remove all Collection Systems
 	removeCollectionsFromDisplayedSystems();
 
+	// Fill the enabled auto collections & "all games", which is always needed, in a single pass on the games
+	std::vector<CollectionSystemData*> autoCollections;
+	for (auto& it : mAutoCollectionSystemsData)
+		if (!it.second.isPopulated && (it.second.isEnabled || it.second.decl.type == AUTO_ALL_GAMES))
+			autoCollections.push_back(&it.second);
+
+	populateAutoCollections(autoCollections);
+
 	std::unordered_map<std::string, FileData*> map;
 	getAllGamesCollection()->getRootFolder()->createChildrenByFilenameMap(map);
 
@@ -432,11 +440,10 @@ void CollectionSystemManager::refreshCollectionSystems(FileData* file)
 	if (!file->getSystem()->isGameSystem() || file->getType() != GAME)
 		return;
 
-	std::map<std::string, CollectionSystemData> allCollections;
-	allCollections.insert(mAutoCollectionSystemsData.cbegin(), mAutoCollectionSystemsData.cend());
-	allCollections.insert(mCustomCollectionSystemsData.cbegin(), mCustomCollectionSystemsData.cend());
+	for (auto& sys : mAutoCollectionSystemsData)
+		updateCollectionSystem(file, sys.second);
 
-	for (auto sys : allCollections)
+	for (auto& sys : mCustomCollectionSystemsData)
 		updateCollectionSystem(file, sys.second);
 }
 
@@ -445,13 +452,16 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, const Colle
 	if (!sysData.isPopulated)
 		return;
 
-	// collection files use the full path as key, to avoid clashes
-	std::string key = file->getFullPath();
-
 	SystemData* curSys = sysData.system;
-	FileData*   collectionEntry = curSys->getRootFolder()->FindByPath(key);
+	FileData*   collectionEntry = CollectionFileData::getCollectionEntry(file, curSys);
 	FolderData* rootFolder = curSys->getRootFolder();
-	std::string name = curSys->getName();
+	const std::string& name = curSys->getName();
+
+	bool isRecent = (name == "recent");
+
+	// Only "favorites" & "recent" can gain a game : nothing changes in other collections which don't contain it
+	if (collectionEntry == nullptr && !isRecent && name != "favorites")
+		return;
 
 	auto view = ViewController::get()->getGameListView(curSys, false);
 
@@ -479,25 +489,56 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, const Colle
 	else
 	{
 		// we didn't find it here - we need to check if we should add it
-		if (name == "recent" && file->getMetadata(MetaDataId::PlayCount) > "0" && includeFileInAutoCollections(file) ||
+		if (isRecent && file->getMetadata(MetaDataId::PlayCount) > "0" && includeFileInAutoCollections(file) ||
 			name == "favorites" && file->getFavorite())
 		{
 			auto newGame = new CollectionFileData(file, curSys);
 			rootFolder->addChild(newGame);
 			curSys->addToIndex(newGame);
+
+			if (isRecent)
+				collectionEntry = newGame;
 		}
+		else
+			return;
 	}
 
 	curSys->updateDisplayedGameCount();
 
-	if (name == "recent")
+	if (isRecent && collectionEntry != nullptr)
 	{
-		sortLastPlayed(curSys);
+		// The list is already sorted : only the changed game has to move
+		insertLastPlayed(rootFolder, collectionEntry);
 		trimCollectionCount(rootFolder, LAST_PLAYED_MAX);
 	}
 	
 	if (view != nullptr)
-		view->onFileChanged(rootFolder, name == "recent" || collectionEntry == nullptr ? FILE_METADATA_CHANGED : FILE_SORTED);
+		view->onFileChanged(rootFolder, isRecent || collectionEntry == nullptr ? FILE_METADATA_CHANGED : FILE_SORTED);
+}
+
+void CollectionSystemManager::insertLastPlayed(FolderData* rootFolder, FileData* entry)
+{
+	SystemData* system = rootFolder->getSystem();
+	if (system->getSortId() != FileSorts::LASTPLAYED_DESCENDING)
+	{
+		sortLastPlayed(system);
+		return;
+	}
+
+	const FileSorts::SortType& sort = FileSorts::getSortTypes().at(system->getSortId());
+
+	std::vector<FileData*>& childs = (std::vector<FileData*>&) rootFolder->getChildren();
+
+	auto it = std::find(childs.begin(), childs.end(), entry);
+	if (it != childs.end())
+		childs.erase(it);
+
+	FileSorts::prepareSortKeys(childs, sort.id);
+	FileSorts::prepareSortKeys({ entry }, sort.id);
+
+	// Most recent first : insert before the first older game
+	auto pos = std::upper_bound(childs.begin(), childs.end(), entry, [&sort](FileData* a, FileData* b) { return sort.comparisonFunction(b, a); });
+	childs.insert(pos, entry);
 }
 
 void CollectionSystemManager::sortLastPlayed(SystemData* system)
@@ -511,6 +552,7 @@ void CollectionSystemManager::sortLastPlayed(SystemData* system)
 	const FileSorts::SortType& sort = FileSorts::getSortTypes().at(system->getSortId());
 
 	std::vector<FileData*>& childs = (std::vector<FileData*>&) rootFolder->getChildren();
+	FileSorts::prepareSortKeys(childs, sort.id);
 	std::sort(childs.begin(), childs.end(), sort.comparisonFunction);
 	if (!sort.ascending)
 		std::reverse(childs.begin(), childs.end());
@@ -535,26 +577,19 @@ void CollectionSystemManager::trimCollectionCount(FolderData* rootFolder, int li
 // deletes all collection files from collection systems related to the source file
 void CollectionSystemManager::deleteCollectionFiles(FileData* file)
 {
-	// collection files use the full path as key, to avoid clashes
-	std::string key = file->getFullPath();
-
 	// find games in collection systems
-	std::map<std::string, CollectionSystemData> allCollections;
-	allCollections.insert(mAutoCollectionSystemsData.cbegin(), mAutoCollectionSystemsData.cend());
-	allCollections.insert(mCustomCollectionSystemsData.cbegin(), mCustomCollectionSystemsData.cend());
-
-	for (auto sysDataIt = allCollections.begin(); sysDataIt != allCollections.end(); sysDataIt++)
+	for (auto collectionEntry : CollectionFileData::getCollectionEntries(file))
 	{
-		if (!sysDataIt->second.isPopulated)
+		if (collectionEntry->getParent() == nullptr)
 			continue;
 
-		FileData* collectionEntry = (sysDataIt->second.system)->getRootFolder()->FindByPath(key);
-		if (collectionEntry == nullptr)
+		CollectionSystemData* sysData = getCollectionSystemData(collectionEntry->getSystem());
+		if (sysData == nullptr || !sysData->isPopulated)
 			continue;
-		
-		sysDataIt->second.needsSave = true;
 
-		SystemData* systemViewToUpdate = getSystemToView(sysDataIt->second.system);
+		sysData->needsSave = true;
+
+		SystemData* systemViewToUpdate = getSystemToView(sysData->system);
 		if (systemViewToUpdate == nullptr)
 			continue;
 
@@ -566,6 +601,19 @@ void CollectionSystemManager::deleteCollectionFiles(FileData* file)
 	}
 }
 
+CollectionSystemData* CollectionSystemManager::getCollectionSystemData(SystemData* system)
+{
+	auto it = mAutoCollectionSystemsData.find(system->getName());
+	if (it != mAutoCollectionSystemsData.end() && it->second.system == system)
+		return &it->second;
+
+	it = mCustomCollectionSystemsData.find(system->getName());
+	if (it != mCustomCollectionSystemsData.end() && it->second.system == system)
+		return &it->second;
+
+	return nullptr;
+}
+
 std::string CollectionSystemManager::getValidNewCollectionName(std::string inName, int index)
 {
 	std::string name = inName;
@@ -943,16 +991,81 @@ SystemData* CollectionSystemManager::createNewCollectionEntry(std::string name,
 	return newSys;
 }
 
+// evaluates the rule of an Automatic Collection System, for a game already accepted by includeFileInAutoCollections
+static bool isInAutoCollection(FileData* game, const CollectionSystemDecl& sysDecl, bool isArcade)
+{
+	switch (sysDecl.type)
+	{
+	case AUTO_ALL_GAMES:
+#ifdef _ENABLEEMUELEC
+		return !(game->getSystemName() == "setup") && !(game->getSystemName() == "imageviewer") && !(game->getSystemName() == "mediaplayer");
+#else
+		return true;
+#endif
+	case AUTO_VERTICALARCADE:
+		return game->isVerticalArcadeGame();
+	case AUTO_LIGHTGUN:
+		return game->isLightGunGame();
+	case AUTO_WHEEL:
+		return game->isWheelGame();
+	case AUTO_RETROACHIEVEMENTS:
+		return game->hasCheevos();
+	case AUTO_LAST_PLAYED:
+		return game->getMetadata(MetaDataId::PlayCount) > "0";
+	case AUTO_NEVER_PLAYED:
+		return !(game->getMetadata(MetaDataId::PlayCount) > "0");
+	case AUTO_FAVORITES:
+		// we may still want to add files we don't want in auto collections in "favorites"
+		return game->getFavorite();
+	case AUTO_ARCADE:
+		return isArcade;
+	case AUTO_AT2PLAYERS: 
+	case AUTO_AT4PLAYERS:
+	{
+		std::string players = game->getMetadata(MetaDataId::Players);
+		if (players.empty())
+			return false;
+
+		auto range = game->parsePlayersRange();
+
+		int val = (sysDecl.type == AUTO_AT2PLAYERS ? 2 : 4);
+		return range.first <= 0 ? (val == range.second) : (range.first <= val && val <= range.second);
+	}
+
+	default:
+		if (!sysDecl.isCustom && !sysDecl.displayIfEmpty)
+		{
+			if (sysDecl.isGenreCollection())
+				return Genres::genreExists(&game->getMetadata(), ((int)sysDecl.type) - 10000);
+			
+			if (sysDecl.isArcadeSubSystem())
+				return isArcade && game->getMetadata(MetaDataId::ArcadeSystemName) == sysDecl.themeFolder;
+		}
+
+		break;
+	}
+
+	return true;
+}
+
 // populates an Automatic Collection System
 void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysData)
 {
-	SystemData* newSys = sysData->system;
-	CollectionSystemDecl sysDecl = sysData->decl;
-	FolderData* rootFolder = newSys->getRootFolder();
+	populateAutoCollections({ sysData });
+}
+
+// populates several Automatic Collection Systems at once : games are enumerated a single time, and the rules
+// of every collection are evaluated for each game. Systems are scanned in parallel with ThreadedLoading.
+void CollectionSystemManager::populateAutoCollections(const std::vector<CollectionSystemData*>& collections)
+{
+	if (collections.empty())
+		return;
 
 	bool hiddenSystemsShowGames = Settings::HiddenSystemsShowGames();
 	auto hiddenSystems = Utils::String::split(Settings::getInstance()->getString("HiddenSystems"), ';');
 
+	std::vector<SystemData*> systems;
+
 	for (auto& system : SystemData::sSystemVector)
 	{
 		// we won't iterate all collections
@@ -962,6 +1075,16 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 		if (!hiddenSystemsShowGames && std::find(hiddenSystems.cbegin(), hiddenSystems.cend(), system->getName()) != hiddenSystems.cend())
 			continue;
 
+		systems.push_back(system);
+	}
+
+	// Games of each system to add to each collection, in gamelist order
+	std::vector<std::vector<std::vector<FileData*>>> matches(systems.size(), std::vector<std::vector<FileData*>>(collections.size()));
+
+	auto scanSystem = [this, &systems, &collections, &matches](size_t index)
+	{
+		SystemData* system = systems[index];
+
 		std::vector<PlatformIds::PlatformId> platforms = system->getPlatformIds();
 		bool isArcade = std::find(platforms.begin(), platforms.end(), PlatformIds::ARCADE) != platforms.end();
 
@@ -975,8 +1098,7 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 			if (system->isGroupSystem() && game->getSystem() != system)
 				continue;
 
-			bool include = includeFileInAutoCollections(game);
-			if (!include)
+			if (!includeFileInAutoCollections(game))
 				continue;
 
 			if (hiddenExts.size() > 0 && game->getType() == GAME)
@@ -986,83 +1108,53 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 					continue;
 			}
 
-			switch (sysDecl.type)
-			{
-			case AUTO_ALL_GAMES:
-#ifdef _ENABLEEMUELEC
-				include = !(game->getSystemName() == "setup") && !(game->getSystemName() == "imageviewer") && !(game->getSystemName() == "mediaplayer");
-#endif
-				break;
-			case AUTO_VERTICALARCADE:
-				include = game->isVerticalArcadeGame();
-				break;
-			case AUTO_LIGHTGUN:
-				include = game->isLightGunGame();
-				break;
-			case AUTO_WHEEL:
-				include = game->isWheelGame();
-				break;
-			case AUTO_RETROACHIEVEMENTS:
-				include = game->hasCheevos();
-				break;
-			case AUTO_LAST_PLAYED:
-				include = game->getMetadata(MetaDataId::PlayCount) > "0";
-				break;
-			case AUTO_NEVER_PLAYED:
-				include = !(game->getMetadata(MetaDataId::PlayCount) > "0");
-				break;
-			case AUTO_FAVORITES:
-				// we may still want to add files we don't want in auto collections in "favorites"
-				include = game->getFavorite();
-				break;
-			case AUTO_ARCADE:
-				include = isArcade;
-				break;
-			case AUTO_AT2PLAYERS: 
-			case AUTO_AT4PLAYERS:
-			{
-				std::string players = game->getMetadata(MetaDataId::Players);
-				if (players.empty())
-					include = false;
-				else
-				{
-					auto range = game->parsePlayersRange();
+			for (size_t i = 0; i < collections.size(); i++)
+				if (isInAutoCollection(game, collections[i]->decl, isArcade))
+					matches[index][i].push_back(game);
+		}
+	};
 
-					int val = (sysDecl.type == AUTO_AT2PLAYERS ? 2 : 4);
-					include = range.first <= 0 ? (val == range.second) : (range.first <= val && val <= range.second);
-				}
-			}
-			break;
+	if (systems.size() > 1 && Settings::getInstance()->getBool("ThreadedLoading"))
+	{
+		Utils::ThreadPool pool;
 
-			default:
-				if (!sysDecl.isCustom && !sysDecl.displayIfEmpty)
-				{
-					if (sysDecl.isGenreCollection())
-						include = Genres::genreExists(&game->getMetadata(), ((int)sysDecl.type) - 10000);
-					else if (sysDecl.isArcadeSubSystem())
-						include = isArcade && game->getMetadata(MetaDataId::ArcadeSystemName) == sysDecl.themeFolder;
-				}
+		for (size_t i = 0; i < systems.size(); i++)
+			pool.queueWorkItem([&scanSystem, i] { scanSystem(i); });
 
-				break;
-			}
+		pool.wait();
+	}
+	else
+	{
+		for (size_t i = 0; i < systems.size(); i++)
+			scanSystem(i);
+	}
+
+	for (size_t i = 0; i < collections.size(); i++)
+	{
+		CollectionSystemData* sysData = collections[i];
 
-			if (include)
+		SystemData* newSys = sysData->system;
+		FolderData* rootFolder = newSys->getRootFolder();
+
+		for (auto& systemMatches : matches)
+		{
+			for (auto game : systemMatches[i])
 			{
 				CollectionFileData* newGame = new CollectionFileData(game, newSys);
 				rootFolder->addChild(newGame);
 				newSys->addToIndex(newGame);
 			}
 		}
-	}
 
-	if (sysDecl.type == AUTO_LAST_PLAYED)
-	{
-		sortLastPlayed(newSys);
-		trimCollectionCount(rootFolder, LAST_PLAYED_MAX);
-	}
+		if (sysData->decl.type == AUTO_LAST_PLAYED)
+		{
+			sortLastPlayed(newSys);
+			trimCollectionCount(rootFolder, LAST_PLAYED_MAX);
+		}
 
-	sysData->isPopulated = true;
-	updateCollectionFolderMetadata(newSys);
+		sysData->isPopulated = true;
+		updateCollectionFolderMetadata(newSys);
+	}
 }
 
 // populates a Custom Collection System
@@ -1193,29 +1285,32 @@ void CollectionSystemManager::removeCollectionsFromDisplayedSystems()
 
 void CollectionSystemManager::addEnabledCollectionsToDisplayedSystems(std::map<std::string, CollectionSystemData>* colSystemData, std::unordered_map<std::string, FileData*>* pMap)
 {
-	if (Settings::getInstance()->getBool("ThreadedLoading"))
+	std::vector<CollectionSystemData*> autoCollections;
+	std::vector<CollectionSystemData*> customCollections;
+
+	for (auto it = colSystemData->begin(); it != colSystemData->end(); it++)
 	{
-		std::vector<CollectionSystemData*> collectionsToPopulate;
-		for (auto it = colSystemData->begin(); it != colSystemData->end(); it++)
-			if (it->second.isEnabled && !it->second.isPopulated)
-				collectionsToPopulate.push_back(&(it->second));
+		if (!it->second.isEnabled || it->second.isPopulated)
+			continue;
 
-		if (collectionsToPopulate.size() > 1)
-		{
-			getAllGamesCollection();
+		if (it->second.decl.isCustom)
+			customCollections.push_back(&(it->second));
+		else
+			autoCollections.push_back(&(it->second));
+	}
 
-			Utils::ThreadPool pool;
+	populateAutoCollections(autoCollections);
 
-			for (auto collection : collectionsToPopulate)
-			{
-				if (collection->decl.isCustom)
-					pool.queueWorkItem([this, collection, pMap] { populateCustomCollection(collection, pMap); });
-				else
-					pool.queueWorkItem([this, collection, pMap] { populateAutoCollection(collection); });
-			}
+	if (customCollections.size() > 1 && Settings::getInstance()->getBool("ThreadedLoading"))
+	{
+		getAllGamesCollection();
 
-			pool.wait();
-		}
+		Utils::ThreadPool pool;
+
+		for (auto collection : customCollections)
+			pool.queueWorkItem([this, collection, pMap] { populateCustomCollection(collection, pMap); });
+
+		pool.wait();
 	}
 
 	// add auto enabled ones
@@ -40,8 +40,8 @@ struct CollectionSystemDecl
 	bool isCustom;	
     bool displayIfEmpty;
 
-	bool isArcadeSubSystem() { return (int)type >= 1000 && (int)type < 10000; }
-	bool isGenreCollection() { return (int)type >= 10000 && (int)type < 20000; }
+	bool isArcadeSubSystem() const { return (int)type >= 1000 && (int)type < 10000; }
+	bool isGenreCollection() const { return (int)type >= 10000 && (int)type < 20000; }
 };
 
 struct CollectionSystemData
@@ -92,6 +92,7 @@ public:
 
 	void reloadCollection(const std::string collectionName, bool repopulateGamelist = true);
     void populateAutoCollection(CollectionSystemData* sysData);
+	void populateAutoCollections(const std::vector<CollectionSystemData*>& collections);
 	bool deleteCustomCollection(CollectionSystemData* data);
 
 	bool isCustomCollection(const std::string collectionName);
@@ -127,6 +128,9 @@ private:
 
 	void trimCollectionCount(FolderData* rootFolder, int limit);
 	void sortLastPlayed(SystemData* system);
+	void insertLastPlayed(FolderData* rootFolder, FileData* entry);
+
+	CollectionSystemData* getCollectionSystemData(SystemData* system);
 
 	bool themeFolderExists(std::string folder);
 
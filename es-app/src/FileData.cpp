@@ -29,10 +29,12 @@
 #include "SaveStateRepository.h"
 #include "Genres.h"
 #include "TextToSpeech.h"
+#include "LocalArtIndex.h"
 #include "LocaleES.h"
 #include "guis/GuiMsgBox.h"
 #include "Paths.h"
 #include "resources/TextureData.h"
+#include <mutex>
 
 using namespace Utils::Platform;
 
@@ -60,7 +62,7 @@ static std::map<std::string, std::function<BindableProperty(FileData*)>> propert
 FileData* FileData::mRunningGame = nullptr;
 
 FileData::FileData(FileType type, const std::string& path, SystemData* system)
-	: mPath(path), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mMetadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: mPath(path), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mMetadata(type == GAME ? GAME_METADATA : FOLDER_METADATA), mSortKeys(nullptr) // metadata is REALLY set in the constructor!
 {
 #ifdef _ENABLEEMUELEC
     mSortName = nullptr;
@@ -71,6 +73,7 @@ FileData::FileData(FileType type, const std::string& path, SystemData* system)
 		mMetadata.set(MetaDataId::Name, getDisplayName());
 	
 	mMetadata.resetChangedFlag();
+	mMetadata.setOwner(this);
 }
 
 const std::string FileData::getPath() const
@@ -133,9 +136,14 @@ std::string FileData::getSystemName() const
 
 FileData::~FileData()
 {
+	mMetadata.setOwner(nullptr);
+
 	if (mDisplayName)
 		delete mDisplayName;
 
+	if (mSortKeys)
+		delete mSortKeys;
+
 #ifdef _ENABLEEMUELEC
     if (mSortName)
         delete mSortName;
@@ -171,21 +179,24 @@ std::string FileData::findLocalArt(const std::string& type, std::vector<std::str
 {
 	if (Settings::getInstance()->getBool("LocalArt"))
 	{
+		std::string images = getSystemEnvData()->mStartPath + "/images";
+		std::string videos = getSystemEnvData()->mStartPath + "/videos";
+
 		for (auto ext : exts)
 		{
-			std::string path = getSystemEnvData()->mStartPath + "/images/" + getDisplayName() + (type.empty() ? "" :  "-" + type) + ext;
-			if (Utils::FileSystem::exists(path))
-				return path;
+			std::string name = getDisplayName() + (type.empty() ? "" :  "-" + type) + ext;
+			if (LocalArtIndex::exists(images, name))
+				return images + "/" + name;
 
 			if (type == "video")
 			{
-				path = getSystemEnvData()->mStartPath + "/videos/" + getDisplayName() + "-" + type + ext;
-				if (Utils::FileSystem::exists(path))
-					return path;
+				name = getDisplayName() + "-" + type + ext;
+				if (LocalArtIndex::exists(videos, name))
+					return videos + "/" + name;
 
-				path = getSystemEnvData()->mStartPath + "/videos/" + getDisplayName() + ext;
-				if (Utils::FileSystem::exists(path))
-					return path;
+				name = getDisplayName() + ext;
+				if (LocalArtIndex::exists(videos, name))
+					return videos + "/" + name;
 			}
 		}
 	}
@@ -238,12 +249,12 @@ const std::string FileData::getThumbnailPath(bool fallbackWithImage)
 
 const bool FileData::getFavorite() const
 {
-	return getMetadata(MetaDataId::Favorite) == "true";
+	return getMetadata().getBool(MetaDataId::Favorite);
 }
 
 const bool FileData::getHidden() const
 {
-	return getMetadata(MetaDataId::Hidden) == "true";
+	return getMetadata().getBool(MetaDataId::Hidden);
 }
 
 const bool FileData::getKidGame() const
@@ -254,7 +265,7 @@ const bool FileData::getKidGame() const
 
 const bool FileData::hasCheevos()
 {
-	if (Utils::String::toInteger(getMetadata(MetaDataId::CheevosId)) > 0)
+	if (getMetadata().getInt(MetaDataId::CheevosId) > 0)
 		return getSourceFileData()->getSystem()->isCheevosSupported();
 
 	return false;
@@ -320,7 +331,37 @@ std::vector<std::string> FileData::getFileMedias()
 
 void FileData::resetSettings() 
 {
-	
+	FileSorts::resetSortKeys();
+}
+
+const FileSorts::SortKeys& FileData::getSortKeys() const
+{
+	static const FileSorts::SortKeys emptyKeys;
+
+	// Collection entries share the keys of their source file
+	FileData* source = ((FileData*)this)->getSourceFileData();
+	if (source != this)
+		return source->getSortKeys();
+
+	if (mSortKeys == nullptr)
+		return emptyKeys;
+
+	return *mSortKeys;
+}
+
+void FileData::updateSortKeys(unsigned int fields)
+{
+	FileData* source = getSourceFileData();
+	if (source != this)
+	{
+		source->updateSortKeys(fields);
+		return;
+	}
+
+	if (mSortKeys == nullptr)
+		mSortKeys = new FileSorts::SortKeys();
+
+	FileSorts::updateSortKeys(this, *mSortKeys, fields);
 }
 
 const std::string& FileData::getName()
@@ -963,11 +1004,45 @@ void FileData::deleteGameFiles()
 		Utils::FileSystem::removeFile(contentFile);
 }
 
+static std::unordered_map<FileData*, std::vector<CollectionFileData*>> sCollectionEntries;
+static std::mutex sCollectionEntriesLock;
+
 CollectionFileData::CollectionFileData(FileData* file, SystemData* system)
 	: FileData(file->getSourceFileData()->getType(), "", system)
 {
 	mSourceFileData = file->getSourceFileData();
 	mParent = NULL;	
+
+	// Custom collections are populated in parallel
+	std::unique_lock<std::mutex> lock(sCollectionEntriesLock);
+	sCollectionEntries[mSourceFileData].push_back(this);
+}
+
+std::vector<CollectionFileData*> CollectionFileData::getCollectionEntries(FileData* source)
+{
+	std::unique_lock<std::mutex> lock(sCollectionEntriesLock);
+
+	auto it = sCollectionEntries.find(source->getSourceFileData());
+	if (it == sCollectionEntries.cend())
+		return std::vector<CollectionFileData*>();
+
+	return it->second;
+}
+
+CollectionFileData* CollectionFileData::getCollectionEntry(FileData* source, SystemData* collection)
+{
+	std::unique_lock<std::mutex> lock(sCollectionEntriesLock);
+
+	auto it = sCollectionEntries.find(source->getSourceFileData());
+	if (it == sCollectionEntries.cend())
+		return nullptr;
+
+	// Entries outside of the collection tree are being deleted
+	for (auto entry : it->second)
+		if (entry->getSystem() == collection && entry->getParent() != nullptr)
+			return entry;
+
+	return nullptr;
 }
 
 SystemEnvironmentData* CollectionFileData::getSystemEnvData() const
@@ -992,6 +1067,19 @@ CollectionFileData::~CollectionFileData()
 		mParent->removeChild(this);
 
 	mParent = NULL;
+
+	std::unique_lock<std::mutex> lock(sCollectionEntriesLock);
+
+	auto it = sCollectionEntries.find(mSourceFileData);
+	if (it != sCollectionEntries.cend())
+	{
+		auto entry = std::find(it->second.begin(), it->second.end(), this);
+		if (entry != it->second.end())
+			it->second.erase(entry);
+
+		if (it->second.empty())
+			sCollectionEntries.erase(it);
+	}
 }
 
 std::string CollectionFileData::getKey() 
@@ -1011,6 +1099,23 @@ const std::string& CollectionFileData::getName()
 
 const std::vector<FileData*> FolderData::getChildrenListToDisplay() 
 {
+	auto sys = CollectionSystemManager::get()->getSystemToView(mSystem);
+
+	FileFilterIndex* idx = sys->getIndex(false);
+	if (idx != nullptr && !idx->isFiltered())
+		idx = nullptr;
+
+	// UI mode changes are settings changes
+	unsigned int filterVersion = (idx != nullptr ? idx->getFilterVersion() : 0);
+	unsigned int settingsVersion = Settings::getVersion();
+	unsigned int metadataVersion = MetaDataList::getGlobalVersion();
+	unsigned int treeVersion = getTreeVersion();
+
+	if (mDisplayListCache != nullptr && mDisplayListCache->system == sys && mDisplayListCache->sortId == sys->getSortId() &&
+		mDisplayListCache->filterVersion == filterVersion && mDisplayListCache->settingsVersion == settingsVersion &&
+		mDisplayListCache->metadataVersion == metadataVersion && mDisplayListCache->treeVersion == treeVersion)
+		return mDisplayListCache->items;
+
 	std::vector<FileData*> ret;
 
 	std::string showFoldersMode = getSystem()->getFolderViewMode();
@@ -1032,16 +1137,10 @@ const std::vector<FileData*> FolderData::getChildrenListToDisplay()
 			filterKidGame = true;
 	}
 
-	auto sys = CollectionSystemManager::get()->getSystemToView(mSystem);
-
 	std::vector<std::string> hiddenExts;
 	if (mSystem->isGameSystem() && !mSystem->isCollection())
 		hiddenExts = Utils::String::split(Utils::String::toLower(Settings::getInstance()->getString(mSystem->getName() + ".HiddenExt")), ';');
 
-	FileFilterIndex* idx = sys->getIndex(false);
-	if (idx != nullptr && !idx->isFiltered())
-		idx = nullptr;
-
   	std::vector<FileData*>* items = &mChildren;
 	
 	std::vector<FileData*> flatGameList;
@@ -1117,6 +1216,7 @@ const std::vector<FileData*> FolderData::getChildrenListToDisplay()
 		currentSortId = 0;
 
 	const FileSorts::SortType& sort = FileSorts::getSortTypes().at(currentSortId);
+	FileSorts::prepareSortKeys(ret, sort.id);
 
 	if (idx != nullptr && idx->hasRelevency())
 	{
@@ -1150,6 +1250,17 @@ const std::vector<FileData*> FolderData::getChildrenListToDisplay()
 			});
 	}
 
+	if (mDisplayListCache == nullptr)
+		mDisplayListCache = new DisplayListCache();
+
+	mDisplayListCache->system = sys;
+	mDisplayListCache->sortId = sys->getSortId();
+	mDisplayListCache->filterVersion = filterVersion;
+	mDisplayListCache->settingsVersion = settingsVersion;
+	mDisplayListCache->metadataVersion = metadataVersion;
+	mDisplayListCache->treeVersion = treeVersion;
+	mDisplayListCache->items = ret;
+
 	return ret;
 }
 
@@ -1315,6 +1426,17 @@ std::vector<FileData*> FolderData::getFilesRecursive(unsigned int typeMask, bool
 	return out;
 }
 
+std::atomic<unsigned int> FolderData::sTreeVersion(1);
+
+// Versions are unique across systems : a system reloaded at the same address never matches the indexes of the previous one
+void FolderData::onTreeChanged()
+{
+	unsigned int version = ++sTreeVersion;
+
+	if (mSystem != nullptr)
+		mSystem->setTreeVersion(version);
+}
+
 void FolderData::addChild(FileData* file, bool assignParent)
 {
 #if DEBUG
@@ -1322,6 +1444,7 @@ void FolderData::addChild(FileData* file, bool assignParent)
 #endif
 
 	mChildren.push_back(file);
+	onTreeChanged();
 
 	if (assignParent)
 		file->setParent(this);	
@@ -1340,6 +1463,7 @@ void FolderData::removeChild(FileData* file)
 		{
 			file->setParent(NULL);
 			mChildren.erase(it);
+			onTreeChanged();
 			return;
 		}
 	}
@@ -1740,11 +1864,15 @@ FolderData::FolderData(const std::string& startpath, SystemData* system, bool ow
 {
 	mIsDisplayableAsVirtualFolder = false;
 	mOwnsChildrens = ownsChildrens;
+	mDisplayListCache = nullptr;
 }
 
 FolderData::~FolderData()
 {
 	clear();
+
+	if (mDisplayListCache)
+		delete mDisplayListCache;
 }
 
 void FolderData::clear()
@@ -1756,6 +1884,7 @@ void FolderData::clear()
 	}
 
 	mChildren.clear();
+	onTreeChanged();
 }
 
 void FolderData::removeFromVirtualFolders(FileData* game)
@@ -1771,6 +1900,7 @@ void FolderData::removeFromVirtualFolders(FileData* game)
 		if ((*it) == game)
 		{
 			mChildren.erase(it);
+			onTreeChanged();
 			return;
 		}
 	}
@@ -6,6 +6,7 @@
 #include "MetaData.h"
 #include <unordered_map>
 #include <memory>
+#include <atomic>
 #include <vector>
 #include <stack>
 #include "KeyboardMapping.h"
@@ -71,9 +72,13 @@ struct LaunchGameOptions
 
 class FolderData;
 
+namespace FileSorts { struct SortKeys; }
+
 // A tree node that holds information for a file.
 class FileData : public IKeyboardMapContainer, public IBindable
 {
+	friend class SystemData;
+
 public:
 	FileData(FileType type, const std::string& path, SystemData* system);
 	virtual ~FileData();
@@ -187,11 +192,17 @@ public:
 
 	std::string getGenre();
 
+	// Collation keys used by FileSorts comparators. They are computed by FileSorts::prepareSortKeys before sorting
+	const FileSorts::SortKeys& getSortKeys() const;
+	void updateSortKeys(unsigned int fields);
+
 private:
 	std::string getKeyboardMappingFilePath();
 	std::string getMessageFromExitCode(int exitCode);
 	MetaDataList mMetadata;
 
+	FileSorts::SortKeys* mSortKeys;
+
 protected:	
 	std::string  findLocalArt(const std::string& type = "", std::vector<std::string> exts = { ".png", ".jpg" });
 
@@ -224,6 +235,10 @@ public:
 	virtual MetaDataList& getMetadata() { return mSourceFileData->getMetadata(); }
 	virtual std::string& getDisplayName() { return mSourceFileData->getDisplayName(); }
 
+	// Reverse index : entries of a source game, maintained by the constructor & the destructor
+	static std::vector<CollectionFileData*> getCollectionEntries(FileData* source);
+	static CollectionFileData* getCollectionEntry(FileData* source, SystemData* collection);
+
 private:
 	// needs to be updated when metadata changes
 	FileData* mSourceFileData;
@@ -264,13 +279,37 @@ public:
 	void removeVirtualFolders();
 	void removeFromVirtualFolders(FileData* game);
 
+	// Changes each time a child is added to or removed from any folder, so that indexes of the trees know when they are outdated
+	static unsigned int getTreeVersion() { return sTreeVersion; }
+
 private:
 	void getFilesRecursiveWithContext(std::vector<FileData*>& out, unsigned int typeMask, GetFileContext* filter, bool displayedOnly, SystemData* system, bool includeVirtualStorage) const;
 
+	void onTreeChanged();
+
+	static std::atomic<unsigned int> sTreeVersion;
+
+	// Last result of getChildrenListToDisplay : reused while the system viewed, its sort & filters, the settings,
+	// the metadata and the trees are unchanged
+	struct DisplayListCache
+	{
+		DisplayListCache() : system(nullptr), sortId(0), filterVersion(0), settingsVersion(0), metadataVersion(0), treeVersion(0) { }
+
+		SystemData*		system;
+		unsigned int	sortId;
+		unsigned int	filterVersion;
+		unsigned int	settingsVersion;
+		unsigned int	metadataVersion;
+		unsigned int	treeVersion;
+
+		std::vector<FileData*> items;
+	};
 
 	std::vector<FileData*> mChildren;
 	bool	mOwnsChildrens;
 	bool	mIsDisplayableAsVirtualFolder;
+
+	DisplayListCache* mDisplayListCache;
 };
 
 #endif // ES_APP_FILE_DATA_H
@@ -15,12 +15,18 @@
 #include "Genres.h"
 #include "SystemConf.h"
 
+#include <algorithm>
+
 #define UNKNOWN_LABEL "UNKNOWN"
 #define INCLUDE_UNKNOWN false;
 
+std::atomic<unsigned int> FileFilterIndex::sFilterVersion(0);
+
 FileFilterIndex::FileFilterIndex()
 	: filterByFavorites(false), filterByGenre(false), filterByKidGame(false), filterByPlayers(false), filterByPubDev(false), filterByRatings(false), filterByYear(false)
 	, filterByLightGun(false), filterByWheel(false), filterByVertical(false), filterByCheevos(false), filterByPlayed(false), filterByRegion(false), filterByLang(false), filterByFamily(false), filterByHasMedia(false), filterByMissingMedia(false)
+	, mTextQueryValid(false), mTextScoresVersion(0), mTextScoresValid(false)
+	, mFacetVersion(0), mFacetMatchesVersion(0), mFacetMatchesFilterVersion(0), mFacetMatchesValid(false), mFilterVersion(++sFilterVersion)
 {
 	clearAllFilters();
 	FilterDataDecl filterDecls[] = 
@@ -90,6 +96,8 @@ void FileFilterIndex::copyFrom(FileFilterIndex* indexToImport)
 
 		*src->second.filteredByRef = *decl.second.filteredByRef;
 	}
+
+	mFilterVersion = ++sFilterVersion;
 }
 
 void FileFilterIndex::importIndex(FileFilterIndex* indexToImport)
@@ -145,6 +153,9 @@ void FileFilterIndex::resetIndex()
 	mTextFilter = "";
 	clearAllFilters();
 
+	mTextIndex.clear();
+	clearFacets();
+
 	clearIndex(genreIndexAllKeys);
 	clearIndex(familyIndexAllKeys);
 	clearIndex(playersIndexAllKeys);
@@ -405,6 +416,9 @@ void FileFilterIndex::addToIndex(FileData* game)
 {
 	game->detectLanguageAndRegion(false);
 
+	mTextIndex.add(game);
+	addToFacets(game);
+
 	manageGenreEntryInIndex(game);
 	manageFamilyEntryInIndex(game);
 	managePlayerEntryInIndex(game);
@@ -416,6 +430,9 @@ void FileFilterIndex::addToIndex(FileData* game)
 
 void FileFilterIndex::removeFromIndex(FileData* game)
 {
+	mTextIndex.remove(game);
+	removeFromFacets(game);
+
 	manageGenreEntryInIndex(game, true);
 	manageFamilyEntryInIndex(game, true);
 	managePlayerEntryInIndex(game, true);
@@ -442,6 +459,8 @@ void FileFilterIndex::setFilter(FilterIndexType type, std::vector<std::string>*
 	*(filterData.filteredByRef) = values != nullptr && values->size() > 0;
 	filterData.currentFilteredKeys->clear();
 
+	mFilterVersion = ++sFilterVersion;
+
 	if (values == nullptr)
 		return;
 
@@ -475,7 +494,8 @@ void FileFilterIndex::clearAllFilters()
 		*(filterData.filteredByRef) = false;
 		filterData.currentFilteredKeys->clear();
 	}
-	return;
+
+	mFilterVersion = ++sFilterVersion;
 }
 
 void FileFilterIndex::resetFilters()
@@ -499,427 +519,552 @@ void FileFilterIndex::setUIModeFilters()
 
 void FileFilterIndex::setTextFilter(const std::string text, bool useRelevancy) 
 { 
+	if (mTextFilter == text && mUseRelevency == useRelevancy)
+		return;
+
 	mTextFilter = text;
 	mUseRelevency = useRelevancy;
+	mFilterVersion = ++sFilterVersion;
 }
 
-float jw_distance(std::string s1, std::string s2, bool caseSensitive = true) {
-	float m = 0;
-	int low, high, range;
-	int k = 0, numTrans = 0;
+int FileFilterIndex::showFile(FileData* game)
+{
+	// this shouldn't happen, but just in case let's get it out of the way
+	if (!isFiltered())
+		return 1;
+
+	// if folder, needs further inspection - i.e. see if folder contains at least one element
+	// that should be shown
+	if (game->getType() == FOLDER) 
+	{
+		// iterate through all of the children, until there's a match
+		for (auto child : ((FolderData*)game)->getChildren())
+			if (showFile(child))
+				return 1;
 
-	// Exit early if either are empty
-	if (s1.length() == 0 || s2.length() == 0) {
 		return 0;
 	}
 
-	// Convert to lower if case-sensitive is false
-	if (caseSensitive == false) {
-		transform(s1.begin(), s1.end(), s1.begin(), ::tolower);
-		transform(s2.begin(), s2.end(), s2.begin(), ::tolower);
-	}
+	// Indexed filters are answered by the facet bitmaps, unless the game changed since it was indexed
+	int facetMatch = matchFacets(game);
+	if (facetMatch == 0)
+		return 0;
 
-	// Exit early if they're an exact match.
-	if (s1 == s2) {
-		return 1;
+	bool keepGoing = false;
+	
+	int textScore = 0;
+
+	if (!mTextFilter.empty())
+	{
+		textScore = getTextScore(game);
+		keepGoing = (textScore != 0);
 	}
 
-	range = (std::max(s1.length(), s2.length()) / 2) - 1;
-	int s1Matches[65000] = {};
-	int s2Matches[65000] = {};
+	bool hasFilter = false;
 
-	for (int i = 0; i < s1.length(); i++) {
+	for (auto& it : mFilterDecl)
+	{
+		FilterDataDecl& filterData = it.second;
+		if (!(*(filterData.filteredByRef)))
+			continue;
+		
+		hasFilter = true;
 
-		// Low Value;
-		if (i >= range) {
-			low = i - range;
-		}
-		else {
-			low = 0;
+		if (facetMatch > 0 && isFacetIndexed(filterData.type))
+		{
+			keepGoing = true;
+			continue;
 		}
 
-		// High Value;
-		if (i + range <= (s2.length() - 1)) {
-			high = i + range;
-		}
-		else {
-			high = s2.length() - 1;
-		}
+		if (!matchFilter(game, filterData))
+			return 0;
 
-		for (int j = low; j <= high; j++) {
-			if (s1Matches[i] != 1 && s2Matches[j] != 1 && s1[i] == s2[j]) {
-				m += 1;
-				s1Matches[i] = 1;
-				s2Matches[j] = 1;
-				break;
-			}
-		}
+		keepGoing = true;
 	}
 
-	// Exit early if no matches were found
-	if (m == 0) {
+	if (keepGoing && !mTextFilter.empty())
+		return textScore;
+	
+	if (mTextFilter.empty() && !hasFilter)
 		return 0;
-	}
+	
+	return keepGoing ? 1 : 0;
+}
+
+// Whether the game passes one of the active filters
+bool FileFilterIndex::matchFilter(FileData* game, FilterDataDecl& filterData)
+{
+	bool filterValid = false;
+
+	if (filterData.type == HASMEDIA_FILTER)
+	{
+		auto it = mFilterDecl.find(HASMEDIA_FILTER);
+		if (it == mFilterDecl.cend())
+			return false;
+
+		auto keys = it->second.currentFilteredKeys;
+		if (keys == nullptr)
+			return false;
 
-	// Count the transpositions.
-	for (int i = 0; i < s1.length(); i++) {
-		if (s1Matches[i] == 1) {
-			int j;
-			for (j = k; j < s2.length(); j++) {
-				if (s2Matches[j] == 1) {
-					k = j + 1;
+		for (auto it : *keys)			
+		{
+			if (it == "FALSE" || it == "TRUE") // Here for Retrocompatibility
+			{
+				if (game->hasAnyMedia() == (it == "TRUE"))
+				{
+					filterValid = true;
+					break;
+				}
+			}				
+			else 
+			{
+				std::string path = game->getMetadata().get(it);
+				if (!path.empty() && Utils::FileSystem::exists(path))
+				{
+					filterValid = true;
 					break;
 				}
 			}
 
-			if (s1[i] != s2[j]) {
-				numTrans += 1;
+		}
+	}
+	else if (filterData.type == MISSING_MEDIA_FILTER)
+	{
+		auto it = mFilterDecl.find(MISSING_MEDIA_FILTER);
+		if (it == mFilterDecl.cend())
+			return false;
+
+		auto keys = it->second.currentFilteredKeys;
+		if (keys == nullptr)
+			return false;
+
+		for (auto it : *keys)
+		{
+			std::string path = game->getMetadata().get(it);
+			if (path.empty() || !Utils::FileSystem::exists(path))
+			{
+				filterValid = true;
+				break;
 			}
 		}
 	}
+	else if (filterData.type == GENRE_FILTER)
+	{
+		for (auto val : Genres::getGenreFiltersNames(&game->getMetadata()))
+		{
+			if (isKeyBeingFilteredBy(val, filterData.type))
+			{
+				filterValid = true;
+				break;
+			}
+		}
+	}
+	else if (filterData.type == PLAYER_FILTER)
+	{
+		auto range = game->parsePlayersRange();
 
-	float weight = (m / s1.length() + m / s2.length() + (m - (numTrans / 2)) / m) / 3;
-	float l = 0;
-	float p = 0.1;
-	if (weight > 0.7) {
-		while (s1[l] == s2[l] && l < 4) {
-			l += 1;
+		if (range.first <= 0 && range.second > 0)
+			filterValid = isKeyBeingFilteredBy(std::to_string(range.second), filterData.type);
+		else if (range.second > 0)
+		{
+			auto it = mFilterDecl.find(PLAYER_FILTER);
+			if (it != mFilterDecl.cend())
+			{
+				auto fltKeys = it->second.currentFilteredKeys;					
+				if (fltKeys != nullptr)
+				{
+					for (auto flt : *fltKeys)
+					{
+						int val = Utils::String::toInteger(flt);
+						if (range.first <= val && val <= range.second)
+						{
+							filterValid = true;
+							break;
+						}
+					}
+				}
+			}
+		}			
+	}
+	else
+	{
+		// try to find a match
+		std::string key = getIndexableKey(game, filterData.type, false);
+
+		if (filterData.type == LANG_FILTER || filterData.type == REGION_FILTER)
+		{
+			for (auto val : Utils::String::split(key, ','))
+				if (isKeyBeingFilteredBy(val, filterData.type))
+					filterValid = true;
 		}
+		else
+			filterValid = isKeyBeingFilteredBy(key, filterData.type);
 
-		weight += l * p * (1 - weight);
+		// if we didn't find a match, try for secondary keys - i.e. publisher and dev, or first genre
+		if (!filterValid)
+		{
+			if (!filterData.hasSecondaryKey)
+				return false;
+
+			std::string secKey = getIndexableKey(game, filterData.type, true);
+			if (secKey != UNKNOWN_LABEL)
+				filterValid = isKeyBeingFilteredBy(secKey, filterData.type);
+		}
 	}
-	return weight;
+
+	return filterValid;
 }
 
-int FileFilterIndex::showFile(FileData* game)
+int FileFilterIndex::getTextScore(FileData* game)
 {
-	// this shouldn't happen, but just in case let's get it out of the way
-	if (!isFiltered())
-		return 1;
+	std::unique_lock<std::mutex> lock(mTextScoresLock);
 
-	// if folder, needs further inspection - i.e. see if folder contains at least one element
-	// that should be shown
-	if (game->getType() == FOLDER) 
+	// mTextFilter is also assigned directly (copyFrom, load...) : the query is checked against it on each call
+	if (!mTextQueryValid || mTextQuery.text != mTextFilter || mTextQuery.useRelevancy != mUseRelevency)
 	{
-		std::vector<FileData*> children = ((FolderData*)game)->getChildren();
-		// iterate through all of the children, until there's a match
+		std::string language = SystemConf::getInstance()->get("system.language");
+		bool isChinese = (language == "zh_CN" || language == "zh_TW");
 
-		for (std::vector<FileData*>::const_iterator it = children.cbegin(); it != children.cend(); ++it )
-			if (showFile(*it))
-				return 1;
+		mTextQuery = TextSearchIndex::createQuery(mTextFilter, mUseRelevency, isChinese);
+		mTextQueryValid = true;
+		mTextScoresValid = false;
+	}
 
-		return 0;
+	if (!mTextIndex.isIndexed(game))
+	{
+		TextSearchIndex::Entry entry;
+		TextSearchIndex::createEntry(game, entry);
+		return TextSearchIndex::getScore(entry, mTextQuery);
 	}
 
-	bool keepGoing = false;
-	
-	int textScore = 0;
+	if (!mTextScoresValid || mTextScoresVersion != mTextIndex.getVersion())
+	{
+		mTextScores.clear();
+		mTextIndex.search(mTextQuery, mTextScores);
+		mTextScoresVersion = mTextIndex.getVersion();
+		mTextScoresValid = true;
+	}
 
-	if (!mTextFilter.empty())
+	auto it = mTextScores.find(game);
+	return it == mTextScores.cend() ? 0 : it->second;
+}
+
+bool FileFilterIndex::isFacetIndexed(FilterIndexType type)
+{
+	// Medias are checked on disk
+	return type != HASMEDIA_FILTER && type != MISSING_MEDIA_FILTER;
+}
+
+// The values that make the game pass the filter, the same way showFile evaluates it
+bool FileFilterIndex::getFacetKeys(FileData* game, FilterIndexType type, std::vector<std::string>& keys)
+{
+	if (type == GENRE_FILTER)
 	{
-		auto name = game->getSourceFileData()->getName();
-		std::string language = SystemConf::getInstance()->get("system.language");
-		bool isChinese = (language == "zh_CN" || language == "zh_TW");
+		for (auto val : Genres::getGenreFiltersNames(&game->getMetadata()))
+			keys.push_back(val);
+
+		return true;
+	}
+
+	if (type == PLAYER_FILTER)
+	{
+		// "=n" : games matching the filter value, "~n" : games whose range contains the filter value
+		auto range = game->parsePlayersRange();
 
-		if (!mUseRelevency)
+		if (range.first <= 0 && range.second > 0)
+			keys.push_back("=" + std::to_string(range.second));
+		else if (range.second > 0)
 		{
-			if (mTextFilter.find(',') == std::string::npos)
-			{
-				if (Utils::String::containsIgnoreCase(name, mTextFilter))
-				{
-					textScore = 1;
-					keepGoing = true;
-				}
-				else if (isChinese && Utils::String::containsIgnoreCasePinyin(name, mTextFilter)) {
-					textScore = 2;
-					keepGoing = true;
-				}
-			}
-			else
-			{
-				for (auto token : Utils::String::split(mTextFilter, ',', true))
-				{
-					if (Utils::String::containsIgnoreCase(name, Utils::String::trim(token)))
-					{
-						textScore = 1;
-						keepGoing = true;
-						break;  // score=1 need break
-					}
-					else if (isChinese && Utils::String::containsIgnoreCasePinyin(name, Utils::String::trim(token)))
-					{
-						textScore = 2;
-						keepGoing = true;
-					}
-				}
-			}
+			if (range.second - range.first > 32)
+				return false;
+
+			for (int i = range.first; i <= range.second; i++)
+				keys.push_back("~" + std::to_string(i));
 		}
-		else
+
+		return true;
+	}
+
+	auto decl = mFilterDecl.find(type);
+	if (decl == mFilterDecl.cend())
+		return true;
+
+	std::string key = getIndexableKey(game, type, false);
+
+	if (type == LANG_FILTER || type == REGION_FILTER)
+	{
+		for (auto val : Utils::String::split(key, ','))
+			keys.push_back(val);
+	}
+	else
+		keys.push_back(key);
+
+	if (decl->second.hasSecondaryKey)
+	{
+		std::string secKey = getIndexableKey(game, type, true);
+		if (secKey != UNKNOWN_LABEL)
+			keys.push_back(secKey);
+	}
+
+	return true;
+}
+
+void FileFilterIndex::addToFacets(FileData* game)
+{
+	if (mFacetOrdinals.find(game) != mFacetOrdinals.cend())
+		removeFromFacets(game);
+
+	uint32_t ordinal;
+	if (mFreeFacetOrdinals.size() > 0)
+	{
+		ordinal = mFreeFacetOrdinals.back();
+		mFreeFacetOrdinals.pop_back();
+	}
+	else
+	{
+		ordinal = (uint32_t)mFacetGames.size();
+		mFacetGames.push_back(FacetGame());
+	}
+
+	FacetGame& facetGame = mFacetGames[ordinal];
+	facetGame.game = game;
+	facetGame.version = game->getMetadata().getVersion();
+	facetGame.exact = true;
+
+	std::vector<std::string> keys;
+
+	for (auto& it : mFilterDecl)
+	{
+		FilterIndexType type = it.second.type;
+		if (!isFacetIndexed(type))
+			continue;
+
+		keys.clear();
+		if (!getFacetKeys(game, type, keys))
 		{
-			if (Utils::String::compareIgnoreCase(name, mTextFilter) == 0)
-			{
-				keepGoing = true;
-				textScore = 1;
-			}
-			else if (Utils::String::startsWithIgnoreCase(name, mTextFilter))
-			{
-				keepGoing = true;
-				textScore = 2;
-			}
-			else if (mTextFilter.find(' ') == std::string::npos && Utils::String::containsIgnoreCase(name, mTextFilter))
-			{
-				keepGoing = true;
-				textScore = 3;
-			}
-			else if (mTextFilter.find(' ') != std::string::npos)
-			{
-				auto simplify = [](const std::string& text)
-				{
-					auto s = Utils::String::toLower(text);
-					s = Utils::String::replace(s, ":", "");
-					s = Utils::String::replace(s, ".", "");
-					s = Utils::String::replace(s, " - ", " ");
-					s = Utils::String::replace(s, "- ", " ");				
+			facetGame.exact = false;
+			break;
+		}
 
-					std::vector<std::string> ret;
+		for (auto& key : keys)
+			facetGame.keys.push_back(std::pair<int, std::string>(type, key));
+	}
 
-					for (auto v : Utils::String::split(s, ' '))
-					{
-						if (v.empty() || v.length() <= 2 || v == "and" || v == "not" || v == "for" || v == "the" || v == "les" || v == "des")
-							continue;
+	if (facetGame.exact)
+	{
+		for (auto& key : facetGame.keys)
+			mFacets[key.first][key.second].add(ordinal);
 
-						ret.push_back(v);
-					}
+		mFacetIndexedGames.add(ordinal);
+	}
+	else
+		facetGame.keys.clear();
 
-					return ret;
-				};
+	mFacetOrdinals[game] = ordinal;
+	mFacetVersion++;
+}
 
-				auto filters = simplify(mTextFilter);
-				auto words = simplify(name);
+void FileFilterIndex::removeFromFacets(FileData* game)
+{
+	auto it = mFacetOrdinals.find(game);
+	if (it == mFacetOrdinals.cend())
+		return;
 
-				int totalWords = 0;
-				int commonWords = 0;
-				
-				for (int i = 0; i < filters.size(); i++)
-				{
-					auto filter = filters[i];
+	uint32_t ordinal = it->second;
+	FacetGame& facetGame = mFacetGames[ordinal];
 
-					for (auto word : words)
-					{
-						if (word == filter)
-						{
-							commonWords++;
-							break;
-						}
-					}
+	for (auto& key : facetGame.keys)
+	{
+		auto& values = mFacets[key.first];
 
-					totalWords++;
-				}
-				
-				int continuousWords = 0;
-				int maxContinuousWords = 0;
-				int wordsAtStart = 0;
-				bool countStart = true;
+		auto value = values.find(key.second);
+		if (value == values.cend())
+			continue;
 
-				for (int j = 0 ; j < words.size(); j++)
-				{
-					auto word = words[j];
+		value->second.remove(ordinal);
+		if (value->second.empty())
+			values.erase(value);
+	}
 
-					for (int i = 0; i < filters.size(); i++)
-					{
-						auto filter = filters[i];
+	mFacetIndexedGames.remove(ordinal);
+	facetGame = FacetGame();
 
-						if (word == filter)
-						{
-							if (countStart && i == j)
-								wordsAtStart++;
-							else
-								countStart = false;
+	mFacetOrdinals.erase(it);
+	mFreeFacetOrdinals.push_back(ordinal);
+	mFacetVersion++;
+}
 
-							continuousWords++;
+void FileFilterIndex::clearFacets()
+{
+	mFacetOrdinals.clear();
+	mFacetGames.clear();
+	mFreeFacetOrdinals.clear();
+	mFacets.clear();
+	mFacetIndexedGames.clear();
+	mFacetVersion++;
+}
 
-							if (maxContinuousWords < continuousWords)
-								maxContinuousWords = continuousWords;
+void FileFilterIndex::getFacetValueGames(FilterIndexType type, const std::string& key, Utils::RoaringBitmap& games)
+{
+	auto facet = mFacets.find(type);
+	if (facet == mFacets.cend())
+		return;
 
-							j++;
+	auto unite = [&facet, &games](const std::string& value)
+	{
+		auto it = facet->second.find(value);
+		if (it != facet->second.cend())
+			games |= it->second;
+	};
 
-							if (j < words.size())
-								word = words[j];
-							else
-								break;
+	if (type == PLAYER_FILTER)
+	{
+		unite("=" + key);
+		unite("~" + std::to_string(Utils::String::toInteger(key)));
+	}
+	else
+		unite(key);
+}
 
-							continue;
-						}
-						else
-							countStart = false;
+void FileFilterIndex::getFacetMatches(Utils::RoaringBitmap& matches, FilterIndexType excludedType)
+{
+	matches = mFacetIndexedGames;
 
-						continuousWords = 0;
-					}					
-				}
-				
-				if (commonWords > 0)
-				{
-					if (commonWords > 1 || (commonWords > 0 && filters.size() == 1))
-					{
-						int sc = ((wordsAtStart * 2) + (maxContinuousWords * 3) + commonWords);
-						textScore = 1000 - sc;
-						keepGoing = true;
-					}
-					else
-					{
-						auto dist = jw_distance(mTextFilter, name, false);
-						if (dist > 0.66)
-						{
-							textScore = 1500 - (500 * dist);
-							keepGoing = true;
-						}
-					}
-				}
-			}
-		}
+	for (auto& it : mFilterDecl)
+	{
+		FilterDataDecl& filterData = it.second;
+		if (!(*(filterData.filteredByRef)) || filterData.type == excludedType || !isFacetIndexed(filterData.type))
+			continue;
+
+		Utils::RoaringBitmap games;
+		for (auto& key : *filterData.currentFilteredKeys)
+			getFacetValueGames(filterData.type, key, games);
+
+		matches &= games;
+	}
+}
+
+// Returns 1 if the game passes every indexed filter, 0 if not, -1 if the bitmaps can't tell
+int FileFilterIndex::matchFacets(FileData* game)
+{
+	auto it = mFacetOrdinals.find(game);
+	if (it == mFacetOrdinals.cend())
+		return -1;
+
+	const FacetGame& facetGame = mFacetGames[it->second];
+	if (!facetGame.exact || facetGame.version != game->getMetadata().getVersion())
+		return -1;
+
+	std::unique_lock<std::mutex> lock(mFacetMatchesLock);
+
+	if (!mFacetMatchesValid || mFacetMatchesVersion != mFacetVersion || mFacetMatchesFilterVersion != mFilterVersion)
+	{
+		getFacetMatches(mFacetMatches, NONE);
+		mFacetMatchesVersion = mFacetVersion;
+		mFacetMatchesFilterVersion = mFilterVersion;
+		mFacetMatchesValid = true;
 	}
 
-	bool hasFilter = false;
+	return mFacetMatches.contains(it->second) ? 1 : 0;
+}
+
+// Whether the game passes every active filter but the excluded one. Facet filters are skipped when the bitmaps already answered them
+bool FileFilterIndex::matchOtherFilters(FileData* game, FilterIndexType excludedType, bool checkFacets)
+{
+	if (!mTextFilter.empty() && getTextScore(game) == 0)
+		return false;
 
 	for (auto& it : mFilterDecl)
 	{
 		FilterDataDecl& filterData = it.second;
-		if (!(*(filterData.filteredByRef)))
+		if (!(*(filterData.filteredByRef)) || filterData.type == excludedType)
 			continue;
-		
-		hasFilter = true;
 
-		bool filterValid = false;
+		if (!checkFacets && isFacetIndexed(filterData.type))
+			continue;
 
-		if (filterData.type == HASMEDIA_FILTER)
-		{
-			auto it = mFilterDecl.find(HASMEDIA_FILTER);
-			if (it == mFilterDecl.cend())
-				break;
+		if (!matchFilter(game, filterData))
+			return false;
+	}
 
-			auto keys = it->second.currentFilteredKeys;
-			if (keys == nullptr)
-				break;
+	return true;
+}
 
-			for (auto it : *keys)			
-			{
-				if (it == "FALSE" || it == "TRUE") // Here for Retrocompatibility
-				{
-					if (game->hasAnyMedia() == (it == "TRUE"))
-					{
-						filterValid = true;
-						break;
-					}
-				}				
-				else 
-				{
-					std::string path = game->getMetadata().get(it);
-					if (!path.empty() && Utils::FileSystem::exists(path))
-					{
-						filterValid = true;
-						break;
-					}
-				}
+// Whether the game would pass a filter on this single value
+bool FileFilterIndex::hasFacetValue(FileData* game, FilterIndexType type, const std::string& key)
+{
+	if (type == PLAYER_FILTER)
+	{
+		auto range = game->parsePlayersRange();
+		int val = Utils::String::toInteger(key);
 
-			}
-		}
-		else if (filterData.type == MISSING_MEDIA_FILTER)
-		{
-			auto it = mFilterDecl.find(MISSING_MEDIA_FILTER);
-			if (it == mFilterDecl.cend())
-				break;
+		if (range.first <= 0 && range.second > 0)
+			return range.second == val;
 
-			auto keys = it->second.currentFilteredKeys;
-			if (keys == nullptr)
-				break;
+		return range.second > 0 && range.first <= val && val <= range.second;
+	}
 
-			for (auto it : *keys)
-			{
-				std::string path = game->getMetadata().get(it);
-				if (path.empty() || !Utils::FileSystem::exists(path))
-				{
-					filterValid = true;
-					break;
-				}
-			}
-		}
-		else if (filterData.type == GENRE_FILTER)
-		{
-			for (auto val : Genres::getGenreFiltersNames(&game->getMetadata()))
-			{
-				if (isKeyBeingFilteredBy(val, filterData.type))
-				{
-					filterValid = true;
-					break;
-				}
-			}
-		}
-		else if (filterData.type == PLAYER_FILTER)
-		{
-			auto range = game->parsePlayersRange();
+	std::vector<std::string> keys;
+	getFacetKeys(game, type, keys);
+	return std::find(keys.cbegin(), keys.cend(), key) != keys.cend();
+}
 
-			if (range.first <= 0 && range.second > 0)
-				filterValid = isKeyBeingFilteredBy(std::to_string(range.second), filterData.type);
-			else if (range.second > 0)
-			{
-				auto it = mFilterDecl.find(PLAYER_FILTER);
-				if (it != mFilterDecl.cend())
-				{
-					auto fltKeys = it->second.currentFilteredKeys;					
-					if (fltKeys != nullptr)
-					{
-						for (auto flt : *fltKeys)
-						{
-							int val = Utils::String::toInteger(flt);
-							if (range.first <= val && val <= range.second)
-							{
-								filterValid = true;
-								break;
-							}
-						}
-					}
-				}
-			}			
-		}
-		else
-		{
-			// try to find a match
-			std::string key = getIndexableKey(game, filterData.type, false);
+std::map<std::string, int> FileFilterIndex::getFacetCounts(FilterIndexType type)
+{
+	std::map<std::string, int> ret;
 
-			if (filterData.type == LANG_FILTER || filterData.type == REGION_FILTER)
-			{
-				for (auto val : Utils::String::split(key, ','))
-					if (isKeyBeingFilteredBy(val, filterData.type))
-						filterValid = true;
-			}
-			else
-				filterValid = isKeyBeingFilteredBy(key, filterData.type);
+	auto decl = mFilterDecl.find(type);
+	if (decl == mFilterDecl.cend() || !isFacetIndexed(type))
+		return ret;
 
-			// if we didn't find a match, try for secondary keys - i.e. publisher and dev, or first genre
-			if (!filterValid)
-			{
-				if (!filterData.hasSecondaryKey)
-					return 0;
+	// Games edited since they were indexed would be counted under their old values
+	std::vector<FileData*> changed;
+	for (auto& it : mFacetOrdinals)
+		if (mFacetGames[it.second].version != it.first->getMetadata().getVersion())
+			changed.push_back(it.first);
 
-				std::string secKey = getIndexableKey(game, filterData.type, true);
-				if (secKey != UNKNOWN_LABEL)
-					filterValid = isKeyBeingFilteredBy(secKey, filterData.type);
-			}
-		}
+	for (auto game : changed)
+		addToFacets(game);
 
-		// if still nothing, then it's not a match
-		if (!filterValid)
-			return 0;		
+	Utils::RoaringBitmap others;
+	getFacetMatches(others, type);
 
-		keepGoing = true;
+	// The text and media filters aren't in the bitmaps : drop the games failing them
+	bool otherFilters = !mTextFilter.empty();
+	for (auto& it : mFilterDecl)
+		if (*(it.second.filteredByRef) && it.second.type != type && !isFacetIndexed(it.second.type))
+			otherFilters = true;
+
+	if (otherFilters)
+	{
+		Utils::RoaringBitmap passing;
+
+		for (auto& it : mFacetOrdinals)
+			if (others.contains(it.second) && matchOtherFilters(it.first, type, false))
+				passing.add(it.second);
+
+		others = passing;
 	}
 
-	if (keepGoing && !mTextFilter.empty())
-		return textScore;
-	
-	if (mTextFilter.empty() && !hasFilter)
-		return 0;
-	
-	return keepGoing ? 1 : 0;
+	for (auto& key : *decl->second.allIndexKeys)
+	{
+		Utils::RoaringBitmap games;
+		getFacetValueGames(type, key.first, games);
+		ret[key.first] = (int)Utils::RoaringBitmap::andCardinality(others, games);
+	}
+
+	// Games the bitmaps can't hold are counted one by one
+	for (auto& it : mFacetOrdinals)
+	{
+		if (mFacetGames[it.second].exact || !matchOtherFilters(it.first, type, true))
+			continue;
+
+		for (auto& key : *decl->second.allIndexKeys)
+			if (hasFacetValue(it.first, type, key.first))
+				ret[key.first]++;
+	}
+
+	return ret;
 }
 
 bool FileFilterIndex::isKeyBeingFilteredBy(std::string key, FilterIndexType type)
@@ -1082,6 +1227,8 @@ bool CollectionFilter::createFromSystem(const std::string name, SystemData* syst
 		*(filterData.filteredByRef) = (filterData.currentFilteredKeys->size() > 0);
 	}
 
+	mFilterVersion = ++sFilterVersion;
+
 	mName = name;
 	mPath = getCollectionsFolder() + "/" + mName + ".xcc";
 	
@@ -1174,6 +1321,8 @@ bool CollectionFilter::load(const std::string file)
 		*(filterData.filteredByRef) = (filterData.currentFilteredKeys->size() > 0);
 	}
 
+	mFilterVersion = ++sFilterVersion;
+
 	return true;
 }
 
@@ -5,7 +5,12 @@
 #include <map>
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
 #include <string>
+#include <mutex>
+#include <atomic>
+#include "TextSearchIndex.h"
+#include "utils/RoaringBitmap.h"
 
 class FileData;
 class SystemData;
@@ -82,14 +87,34 @@ public:
 	inline const std::string getTextFilter() { return mTextFilter; }
 	inline bool hasRelevency() { return !mTextFilter.empty() && mUseRelevency; }
 
+	// Changes each time the filters change. Versions are unique across indexes
+	inline unsigned int getFilterVersion() { return mFilterVersion; }
+
 	std::string getDisplayLabel(bool includeText = false);
 
+	// Number of games having each value of a filter, among the games matching the other filters
+	std::map<std::string, int> getFacetCounts(FilterIndexType type);
+
 protected:
 	//std::vector<FilterDataDecl> filterDataDecl;
 	std::map<int, FilterDataDecl> mFilterDecl;
 
 	std::string getIndexableKey(FileData* game, FilterIndexType type, bool getSecondary);
 
+	int getTextScore(FileData* game);
+	bool matchFilter(FileData* game, FilterDataDecl& filterData);
+	bool matchOtherFilters(FileData* game, FilterIndexType excludedType, bool checkFacets);
+
+	static bool isFacetIndexed(FilterIndexType type);
+	bool getFacetKeys(FileData* game, FilterIndexType type, std::vector<std::string>& keys);
+	void addToFacets(FileData* game);
+	void removeFromFacets(FileData* game);
+	void clearFacets();
+	int matchFacets(FileData* game);
+	void getFacetMatches(Utils::RoaringBitmap& matches, FilterIndexType excludedType);
+	void getFacetValueGames(FilterIndexType type, const std::string& key, Utils::RoaringBitmap& games);
+	bool hasFacetValue(FileData* game, FilterIndexType type, const std::string& key);
+
 	void manageGenreEntryInIndex(FileData* game, bool remove = false);
 	void manageFamilyEntryInIndex(FileData* game, bool remove = false);
 	void managePlayerEntryInIndex(FileData* game, bool remove = false);
@@ -158,6 +183,44 @@ protected:
 
 	std::string mTextFilter;
 	bool		mUseRelevency;
+
+	TextSearchIndex mTextIndex;
+
+	// Scores of the indexed games for the current text filter, computed with the index on first use
+	std::mutex mTextScoresLock;
+	TextSearchIndex::Query mTextQuery;
+	bool mTextQueryValid;
+	std::unordered_map<FileData*, int> mTextScores;
+	unsigned int mTextScoresVersion;
+	bool mTextScoresValid;
+
+	// Facets : for each filter value, the ordinals of the games having it
+	struct FacetGame
+	{
+		FacetGame() : game(nullptr), version(0), exact(false) { }
+
+		FileData* game;
+		unsigned int version;
+		bool exact; // false if a filter can't be answered from the bitmaps (too large players range)
+		std::vector<std::pair<int, std::string>> keys;
+	};
+
+	std::unordered_map<FileData*, uint32_t> mFacetOrdinals;
+	std::vector<FacetGame> mFacetGames;
+	std::vector<uint32_t> mFreeFacetOrdinals;
+	std::map<int, std::unordered_map<std::string, Utils::RoaringBitmap>> mFacets;
+	Utils::RoaringBitmap mFacetIndexedGames;
+	unsigned int mFacetVersion;
+
+	// Games matching the current filters, computed on first use
+	std::mutex mFacetMatchesLock;
+	Utils::RoaringBitmap mFacetMatches;
+	unsigned int mFacetMatchesVersion;
+	unsigned int mFacetMatchesFilterVersion;
+	bool mFacetMatchesValid;
+	unsigned int mFilterVersion;
+
+	static std::atomic<unsigned int> sFilterVersion;
 };
 
 class CollectionFilter : public FileFilterIndex
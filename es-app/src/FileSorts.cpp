@@ -4,6 +4,10 @@
 #include "utils/StringUtil.h"
 #include "LocaleES.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
 #ifdef _ENABLEEMUELEC
 	#include <climits>
 #endif
@@ -26,6 +30,7 @@ namespace FileSorts
 			delete sInstance;
 
 		sInstance = nullptr;
+		resetSortKeys();
 	}
 
 	const std::vector<SortType>& getSortTypes()
@@ -44,6 +49,8 @@ namespace FileSorts
 
 	Singleton::Singleton()
 	{
+		mArticles = Utils::String::commaStringToVector(_("A,AN,THE"));
+
 		mSortTypes.push_back(SortType(FILENAME_ASCENDING, &compareName, true, _("FILENAME, ASCENDING"), _U("\uF15d ")));
 		mSortTypes.push_back(SortType(FILENAME_DESCENDING, &compareName, false, _("FILENAME, DESCENDING"), _U("\uF15e ")));
 		mSortTypes.push_back(SortType(RATING_ASCENDING, &compareRating, true, _("RATING, ASCENDING"), _U("\uF165 ")));
@@ -79,8 +86,20 @@ namespace FileSorts
 #endif
 	}
 
+	static std::atomic<unsigned int> sGeneration(1);
+
+	void resetSortKeys()
+	{
+		sGeneration++;
+	}
+
+	bool SortKeys::isUpToDate(const MetaDataList& metadata) const
+	{
+		return generation == sGeneration && metadataVersion == metadata.getVersion();
+	}
+
 #ifdef _ENABLEEMUELEC
-	int _digitPrefixLength(const std::string s)
+	static int _digitPrefixLength(const std::string& s)
 	{
 		int l = s.size();
 		int i = 0;
@@ -96,85 +115,175 @@ namespace FileSorts
 		return 0;
 	}
 
-	bool _comparePrefixDigits(std::string name1, std::string name2)
+	// Names starting with a number sort first, longest numbers first, then by value.
+	// The rule is encoded as a 5 bytes prefix, so that the whole key compares as a plain string
+	static std::string _digitPrefixKey(const std::string& name)
 	{
-		int p1 = _digitPrefixLength(name1);
-		int p2 = _digitPrefixLength(name2);
-		if (p1 != p2)
-			return p1 > p2;
-
-		int i1 = std::atoi(name1.c_str());
-		int i2 = std::atoi(name2.c_str());
-		if (i1 == 0) i1 = INT_MAX;
-		if (i2 == 0) i2 = INT_MAX;
-		//if (i1 != i2)
-		return i1 < i2;
-	}
+		int length = _digitPrefixLength(name);
 
-	bool _compareNames(std::string name1, std::string name2)
-	{
-		const bool ignoreArticles = Settings::getInstance()->getBool("IgnoreLeadingArticles");
-		if (ignoreArticles)
+		long long number = INT_MAX;
+		if (length > 0)
 		{
-			const auto articles = Utils::String::commaStringToVector(_("A,AN,THE"));
-			name1 = stripLeadingArticle(name1, articles);
-			name2 = stripLeadingArticle(name2, articles);
+			number = std::strtoll(name.c_str(), nullptr, 10);
+			if (number <= 0 || number > INT_MAX)
+				number = INT_MAX;
 		}
-		return Utils::String::compareIgnoreCase(name1, name2) < 0;
+
+		std::string key(5, '\0');
+		key[0] = (char)(255 - std::min(length, 254));
+		key[1] = (char)((number >> 24) & 0xFF);
+		key[2] = (char)((number >> 16) & 0xFF);
+		key[3] = (char)((number >> 8) & 0xFF);
+		key[4] = (char)(number & 0xFF);
+		return key;
 	}
+#endif
 
-	//returns if file1 should come before file2
-	bool compareName(const FileData* file1, const FileData* file2)
+	static std::string _nameKey(const std::string& name)
 	{
-		if (file1->getType() != file2->getType())
+		std::string key;
+
+#ifdef _ENABLEEMUELEC
+		key = _digitPrefixKey(name);
+#endif
+
+		if (Settings::IgnoreLeadingArticles())
+			return key + Utils::String::toSortKey(stripLeadingArticle(name, getInstance()->mArticles));
+
+		return key + Utils::String::toSortKey(name);
+	}
+
+	static unsigned int getSortKeyFields(unsigned int sortId)
+	{
+		switch (sortId)
 		{
-			return file1->getType() == FOLDER;
+		case FILENAME_ASCENDING:
+		case FILENAME_DESCENDING:
+			return SORTKEY_NAME;
+		case LASTPLAYED_ASCENDING:
+		case LASTPLAYED_DESCENDING:
+			return SORTKEY_LASTPLAYED;
+		case RELEASEDATE_ASCENDING:
+		case RELEASEDATE_DESCENDING:
+			return SORTKEY_RELEASEDATE;
+		case GENRE_ASCENDING:
+		case GENRE_DESCENDING:
+			return SORTKEY_GENRE;
+		case DEVELOPER_ASCENDING:
+		case DEVELOPER_DESCENDING:
+			return SORTKEY_DEVELOPER;
+		case PUBLISHER_ASCENDING:
+		case PUBLISHER_DESCENDING:
+			return SORTKEY_PUBLISHER;
+		case SYSTEM_ASCENDING:
+		case SYSTEM_DESCENDING:
+			return SORTKEY_SYSTEM;
+		case SYSTEM_RELEASEDATE_ASCENDING:
+		case SYSTEM_RELEASEDATE_DESCENDING:
+		case RELEASEDATE_SYSTEM_ASCENDING:
+		case RELEASEDATE_SYSTEM_DESCENDING:
+			return SORTKEY_SYSTEM | SORTKEY_RELEASEDATE | SORTKEY_TITLE;
+#ifdef _ENABLEEMUELEC
+		case SORTNAME_ASCENDING:
+		case SORTNAME_DESCENDING:
+			return SORTKEY_SORTNAME;
+#endif
 		}
 
-		// we compare the actual metadata name, as collection files have the system appended which messes up the order
-		const std::string name1 = ((FileData *) file1)->getName();
-		const std::string name2 = ((FileData *) file2)->getName();
-
-		if (_digitPrefixLength(name1) || _digitPrefixLength(name2))
-			return _comparePrefixDigits(name1, name2);
-		
-		return _compareNames(name1, name2);
+		// Numbers only
+		return 0;
 	}
 
-	bool compareSortName(const FileData* file1, const FileData* file2)
+	void updateSortKeys(FileData* file, SortKeys& keys, unsigned int fields)
 	{
-		if (file1->getType() != file2->getType())
+		const MetaDataList& metadata = file->getMetadata();
+
+		if (!keys.isUpToDate(metadata))
 		{
-			return file1->getType() == FOLDER;
+			keys = SortKeys();
+			keys.metadataVersion = metadata.getVersion();
+			keys.generation = sGeneration;
+
+			keys.rating = metadata.getFloat(MetaDataId::Rating);
+			keys.playCount = metadata.getInt(MetaDataId::PlayCount);
+			keys.gameTime = metadata.getInt(MetaDataId::GameTime);
+			keys.players = metadata.getInt(MetaDataId::Players);
+			keys.isGame = metadata.getType() == GAME_METADATA;
 		}
 
-    std::string name1 = (std::string) ((FileData *) file1)->getSortOrName();
-    std::string name2 = (std::string) ((FileData *) file2)->getSortOrName();
+		// Keys already computed may be read by another sort : only the missing ones are written
+		fields &= ~keys.fields;
+		if (fields == 0)
+			return;
 
-		if (_digitPrefixLength(name1) || _digitPrefixLength(name2))
-			return _comparePrefixDigits(name1, name2);
+		// we use the actual metadata name, as collection files have the system appended which messes up the order
+		if (fields & (SORTKEY_NAME | SORTKEY_TITLE))
+		{
+			const std::string& name = file->getName();
 
-		return _compareNames(name1, name2);
+			if (fields & SORTKEY_NAME)
+				keys.name = _nameKey(name);
+
+			if (fields & SORTKEY_TITLE)
+				keys.title = Utils::String::toSortKey(name);
+		}
+
+#ifdef _ENABLEEMUELEC
+		if (fields & SORTKEY_SORTNAME)
+			keys.sortName = _nameKey(file->getSortOrName());
+#endif
+		if (fields & SORTKEY_SYSTEM)
+			keys.system = Utils::String::toSortKey(file->getSourceFileData()->getSystemName());
+
+		if (fields & SORTKEY_GENRE)
+			keys.genre = Utils::String::toSortKey(metadata.get(MetaDataId::Genre));
+
+		if (fields & SORTKEY_DEVELOPER)
+			keys.developer = Utils::String::toSortKey(metadata.get(MetaDataId::Developer));
+
+		if (fields & SORTKEY_PUBLISHER)
+			keys.publisher = Utils::String::toSortKey(metadata.get(MetaDataId::Publisher));
+
+		// Dates are stored as ISO strings (YYYYMMDDTHHMMSS) : they compare as strings
+		if (fields & SORTKEY_RELEASEDATE)
+			keys.releaseDate = metadata.get(MetaDataId::ReleaseDate);
+
+		if (fields & SORTKEY_LASTPLAYED)
+			keys.lastPlayed = metadata.get(MetaDataId::LastPlayed);
+
+		keys.fields |= fields;
+	}
+
+	static std::mutex sSortKeysLock;
+
+	void prepareSortKeys(const std::vector<FileData*>& files, unsigned int sortId)
+	{
+		unsigned int fields = getSortKeyFields(sortId);
+
+		std::unique_lock<std::mutex> lock(sSortKeysLock);
+
+		for (auto file : files)
+			file->updateSortKeys(fields);
 	}
 
-#else
 	//returns if file1 should come before file2
 	bool compareName(const FileData* file1, const FileData* file2)
 	{
-		// we compare the actual metadata name, as collection files have the system appended which messes up the order
-		const std::string& name1 = ((FileData *) file1)->getName();
-		const std::string& name2 = ((FileData *) file2)->getName();
+#ifdef _ENABLEEMUELEC
+		if (file1->getType() != file2->getType())
+			return file1->getType() == FOLDER;
+#endif
 
-		if (Settings::IgnoreLeadingArticles())
-		{
-			static auto articles = Utils::String::commaStringToVector(_("A,AN,THE"));
-			auto name1a = stripLeadingArticle(name1, articles);
-			auto name2a = stripLeadingArticle(name2, articles);
+		return file1->getSortKeys().name < file2->getSortKeys().name;
+	}
 
-			return Utils::String::compareIgnoreCase(name1a, name2a) < 0;
-		}
+#ifdef _ENABLEEMUELEC
+	bool compareSortName(const FileData* file1, const FileData* file2)
+	{
+		if (file1->getType() != file2->getType())
+			return file1->getType() == FOLDER;
 
-		return Utils::String::compareIgnoreCase(name1, name2) < 0;
+		return file1->getSortKeys().sortName < file2->getSortKeys().sortName;
 	}
 #endif
 
@@ -199,81 +308,79 @@ namespace FileSorts
 
 	bool compareRating(const FileData* file1, const FileData* file2)
 	{
-		return file1->getMetadata().getFloat(MetaDataId::Rating) < file2->getMetadata().getFloat(MetaDataId::Rating);
+		return file1->getSortKeys().rating < file2->getSortKeys().rating;
 	}
 
 	bool compareTimesPlayed(const FileData* file1, const FileData* file2)
 	{
+		auto& keys1 = file1->getSortKeys();
+		auto& keys2 = file2->getSortKeys();
+
 		//only games have playcount metadata
-		if (file1->getMetadata().getType() == GAME_METADATA && file2->getMetadata().getType() == GAME_METADATA)
-			return (file1)->getMetadata().getInt(MetaDataId::PlayCount) < (file2)->getMetadata().getInt(MetaDataId::PlayCount);
+		if (keys1.isGame && keys2.isGame)
+			return keys1.playCount < keys2.playCount;
 
 		return false;
 	}
 
 	bool compareGameTime(const FileData* file1, const FileData* file2)
 	{
+		auto& keys1 = file1->getSortKeys();
+		auto& keys2 = file2->getSortKeys();
+
 		//only games have playcount metadata
-		if (file1->getMetadata().getType() == GAME_METADATA && file2->getMetadata().getType() == GAME_METADATA)
-			return (file1)->getMetadata().getInt(MetaDataId::GameTime) < (file2)->getMetadata().getInt(MetaDataId::GameTime);
+		if (keys1.isGame && keys2.isGame)
+			return keys1.gameTime < keys2.gameTime;
 
 		return false;
 	}
 
 	bool compareLastPlayed(const FileData* file1, const FileData* file2)
 	{
-		// since it's stored as an ISO string (YYYYMMDDTHHMMSS), we can compare as a string
-		// as it's a lot faster than the time casts and then time comparisons
-		return (file1)->getMetadata().get(MetaDataId::LastPlayed) < (file2)->getMetadata().get(MetaDataId::LastPlayed);
+		return file1->getSortKeys().lastPlayed < file2->getSortKeys().lastPlayed;
 	}
 
 	bool compareNumPlayers(const FileData* file1, const FileData* file2)
 	{
-		return (file1)->getMetadata().getInt(MetaDataId::Players) < (file2)->getMetadata().getInt(MetaDataId::Players);
+		return file1->getSortKeys().players < file2->getSortKeys().players;
 	}
 
-	bool compareSystemReleaseYear(const FileData* file1, const FileData* file2)
+	static int compareReleaseYears(const SortKeys& keys1, const SortKeys& keys2)
 	{
-		std::string system1 = ((FileData*)file1)->getSourceFileData()->getSystemName();
-		std::string system2 = ((FileData*)file2)->getSourceFileData()->getSystemName();
+		return keys1.releaseDate.compare(0, 4, keys2.releaseDate, 0, 4);
+	}
 
-		if (system1 == system2)
-		{
-			std::string year1 = file1->getMetadata().get(MetaDataId::ReleaseDate).substr(0, 4);
-			std::string year2 = file2->getMetadata().get(MetaDataId::ReleaseDate).substr(0, 4);
+	bool compareSystemReleaseYear(const FileData* file1, const FileData* file2)
+	{
+		auto& keys1 = file1->getSortKeys();
+		auto& keys2 = file2->getSortKeys();
 
-			if (year1 == year2)
-				return Utils::String::compareIgnoreCase(((FileData*)file1)->getName(), ((FileData*)file2)->getName()) < 0;
+		int cmp = keys1.system.compare(keys2.system);
+		if (cmp == 0)
+			cmp = compareReleaseYears(keys1, keys2);
+		if (cmp == 0)
+			return keys1.title < keys2.title;
 
-			return year1 < year2;
-		}
-		return Utils::String::compareIgnoreCase(system1, system2) < 0;
+		return cmp < 0;
 	}
 
 	bool compareReleaseYearSystem(const FileData* file1, const FileData* file2)
 	{
-		std::string year1 = file1->getMetadata().get(MetaDataId::ReleaseDate).substr(0, 4);
-		std::string year2 = file2->getMetadata().get(MetaDataId::ReleaseDate).substr(0, 4);
+		auto& keys1 = file1->getSortKeys();
+		auto& keys2 = file2->getSortKeys();
 
-		if (year1 == year2)
-		{
-			std::string system1 = ((FileData*)file1)->getSourceFileData()->getSystemName();
-			std::string system2 = ((FileData*)file2)->getSourceFileData()->getSystemName();
-
-			if (system1 == system2)
-				return Utils::String::compareIgnoreCase(((FileData*)file1)->getName(), ((FileData*)file2)->getName()) < 0;
-
-			return Utils::String::compareIgnoreCase(system1, system2) < 0;
-		}
+		int cmp = compareReleaseYears(keys1, keys2);
+		if (cmp == 0)
+			cmp = keys1.system.compare(keys2.system);
+		if (cmp == 0)
+			return keys1.title < keys2.title;
 
-		return year1 < year2;
+		return cmp < 0;
 	}
 
 	bool compareReleaseDate(const FileData* file1, const FileData* file2)
 	{
-		// since it's stored as an ISO string (YYYYMMDDTHHMMSS), we can compare as a string
-		// as it's a lot faster than the time casts and then time comparisons
-		return (file1)->getMetadata().get(MetaDataId::ReleaseDate) < (file2)->getMetadata().get(MetaDataId::ReleaseDate);
+		return file1->getSortKeys().releaseDate < file2->getSortKeys().releaseDate;
 	}
 
 	bool compareFileCreationDate(const FileData* file1, const FileData* file2)
@@ -286,29 +393,21 @@ namespace FileSorts
 
 	bool compareGenre(const FileData* file1, const FileData* file2)
 	{
-		std::string genre1 = file1->getMetadata().get(MetaDataId::Genre);
-		std::string genre2 = file2->getMetadata().get(MetaDataId::Genre);
-		return Utils::String::compareIgnoreCase(genre1, genre2) < 0;
+		return file1->getSortKeys().genre < file2->getSortKeys().genre;
 	}
 
 	bool compareDeveloper(const FileData* file1, const FileData* file2)
 	{
-		std::string developer1 = file1->getMetadata().get(MetaDataId::Developer);
-		std::string developer2 = file2->getMetadata().get(MetaDataId::Developer);
-		return Utils::String::compareIgnoreCase(developer1, developer2) < 0;
+		return file1->getSortKeys().developer < file2->getSortKeys().developer;
 	}
 
 	bool comparePublisher(const FileData* file1, const FileData* file2)
 	{
-		std::string publisher1 = file1->getMetadata().get(MetaDataId::Publisher);
-		std::string publisher2 = file2->getMetadata().get(MetaDataId::Publisher);
-		return Utils::String::compareIgnoreCase(publisher1, publisher2) < 0;
+		return file1->getSortKeys().publisher < file2->getSortKeys().publisher;
 	}
 
 	bool compareSystem(const FileData* file1, const FileData* file2)
 	{
-		std::string system1 = ((FileData*)file1)->getSourceFileData()->getSystemName();
-		std::string system2 = ((FileData*)file2)->getSourceFileData()->getSystemName();
-		return Utils::String::compareIgnoreCase(system1, system2) < 0;		
+		return file1->getSortKeys().system < file2->getSortKeys().system;
 	}
 };
@@ -44,6 +44,60 @@ namespace FileSorts
 #endif
 	};
 
+	// Text keys of SortKeys, only computed for the sorts that compare them
+	enum SortKeyField : unsigned int
+	{
+		SORTKEY_NAME = 1,
+		SORTKEY_TITLE = 2,
+		SORTKEY_SORTNAME = 4,
+		SORTKEY_SYSTEM = 8,
+		SORTKEY_GENRE = 16,
+		SORTKEY_DEVELOPER = 32,
+		SORTKEY_PUBLISHER = 64,
+		SORTKEY_RELEASEDATE = 128,
+		SORTKEY_LASTPLAYED = 256
+	};
+
+	// Collation keys of a file, computed once per metadata change instead of on every comparison.
+	// Text keys are upper-cased UTF-8 : their byte order is the order of Utils::String::compareIgnoreCase
+	struct SortKeys
+	{
+		SortKeys() : metadataVersion(0), generation(0), fields(0), rating(0), playCount(0), gameTime(0), players(0), isGame(false) { }
+
+		bool isUpToDate(const MetaDataList& metadata) const;
+
+		unsigned int metadataVersion;
+		unsigned int generation;
+		unsigned int fields;	// SortKeyField computed for this version
+
+		std::string name;		// Leading article & digit prefix rules applied
+		std::string title;
+#ifdef _ENABLEEMUELEC
+		std::string sortName;
+#endif
+		std::string system;
+		std::string genre;
+		std::string developer;
+		std::string publisher;
+		std::string releaseDate;
+		std::string lastPlayed;
+
+		float rating;
+		int playCount;
+		int gameTime;
+		int players;
+		bool isGame;
+	};
+
+	void updateSortKeys(FileData* file, SortKeys& keys, unsigned int fields);
+
+	// Computes the keys the sort compares before sorting the files, so that comparators only read them.
+	// Collections sorted in parallel share their source files : the keys are written under a lock
+	void prepareSortKeys(const std::vector<FileData*>& files, unsigned int sortId);
+
+	// Sort settings changed (leading articles, file names...) : outdates every SortKeys
+	void resetSortKeys();
+
 	typedef bool ComparisonFunction(const FileData* a, const FileData* b);
 
 	struct SortType
@@ -64,6 +118,7 @@ namespace FileSorts
 		Singleton();
 	
 		std::vector<SortType> mSortTypes;
+		std::vector<std::string> mArticles;
 	};
 
 	void reset();
@@ -73,7 +128,6 @@ namespace FileSorts
 	bool compareName(const FileData* file1, const FileData* file2);
 #ifdef _ENABLEEMUELEC
 	bool compareSortName(const FileData* file1, const FileData* file2);
-	bool compareNames(std::string name1, std::string name2);
 #endif
 	bool compareRating(const FileData* file1, const FileData* file2);
 	bool compareTimesPlayed(const FileData* file1, const FileData* fil2);
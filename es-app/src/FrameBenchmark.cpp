@@ -0,0 +1,165 @@
+#include "FrameBenchmark.h"
+
+#include "views/gamelist/IGameListView.h"
+#include "views/ViewController.h"
+#include "SystemData.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#define BENCHMARK_MAX_SYSTEMS	8
+#define BENCHMARK_SCROLL_STEPS	20
+
+FrameBenchmark::FrameBenchmark(Window* window, int framesPerStep) : mWindow(window), mStep(0), mStepFrame(0)
+{
+	int systemCount = 0;
+
+	for (auto system : SystemData::sSystemVector)
+	{
+		if (!system->isVisible())
+			continue;
+
+		if (systemCount++ >= BENCHMARK_MAX_SYSTEMS)
+			break;
+
+		addStep("systemview", [system] { ViewController::get()->goToSystemView(system); }, framesPerStep);
+		addStep("gamelist", [system] { ViewController::get()->goToGameList(system); }, framesPerStep);
+
+		for (int i = 0; i < BENCHMARK_SCROLL_STEPS; i++)
+		{
+			addStep("scroll", [system, i]
+			{
+				auto view = ViewController::get()->getGameListView(system, false);
+				if (view == nullptr)
+					return;
+
+				auto entries = view->getFileDataEntries();
+				if (!entries.empty())
+					view->setCursor(entries[i % entries.size()]);
+
+			}, std::max(1, framesPerStep / 4));
+		}
+	}
+
+	mFrames.reserve(mSteps.size() * framesPerStep);
+
+	LOG(LogInfo) << "FrameBenchmark : " << mSteps.size() << " steps on " << std::min(systemCount, BENCHMARK_MAX_SYSTEMS) << " systems";
+}
+
+void FrameBenchmark::addStep(const std::string& kind, const std::function<void()>& action, int frames)
+{
+	Step step;
+	step.kind = kind;
+	step.action = action;
+	step.frames = frames;
+	mSteps.push_back(step);
+}
+
+bool FrameBenchmark::beginFrame()
+{
+	if (mStep >= mSteps.size())
+		return false;
+
+	mFrameStart = std::chrono::steady_clock::now();
+
+	// The action is part of the measured frame : opening a view for the first time has a cost
+	if (mStepFrame == 0)
+		mSteps[mStep].action();
+
+	return true;
+}
+
+void FrameBenchmark::endFrame()
+{
+	if (mStep >= mSteps.size())
+		return;
+
+	Frame frame;
+	frame.kind = mSteps[mStep].kind;
+	frame.time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mFrameStart).count();
+	frame.statistics = Renderer::getStatistics();
+	mFrames.push_back(frame);
+
+	if (++mStepFrame >= mSteps[mStep].frames)
+	{
+		mStep++;
+		mStepFrame = 0;
+	}
+}
+
+static double getPercentile(const std::vector<double>& sortedTimes, double percentile)
+{
+	if (sortedTimes.empty())
+		return 0;
+
+	size_t index = (size_t)(percentile * sortedTimes.size());
+	return sortedTimes[std::min(index, sortedTimes.size() - 1)];
+}
+
+void FrameBenchmark::reportFrames(const std::string& kind, const std::vector<const Frame*>& frames)
+{
+	if (frames.empty())
+		return;
+
+	std::vector<double> times;
+	times.reserve(frames.size());
+
+	double drawCalls = 0;
+	double stateChanges = 0;
+	double uploadedBytes = 0;
+
+	for (auto frame : frames)
+	{
+		times.push_back(frame->time);
+		drawCalls += frame->statistics.drawCalls;
+		stateChanges += frame->statistics.stateChanges;
+		uploadedBytes += frame->statistics.uploadedBytes;
+	}
+
+	std::sort(times.begin(), times.end());
+
+	std::stringstream ss;
+	ss << std::fixed << std::setprecision(2)
+		<< std::left << std::setw(12) << kind
+		<< " frames: " << frames.size()
+		<< " p50: " << getPercentile(times, 0.50) << "ms"
+		<< " p99: " << getPercentile(times, 0.99) << "ms"
+		<< " max: " << times.back() << "ms"
+		<< " draw calls: " << drawCalls / frames.size()
+		<< " state changes: " << stateChanges / frames.size()
+		<< " uploaded: " << uploadedBytes / frames.size() / 1024.0 << "KB";
+
+	LOG(LogInfo) << "FrameBenchmark : " << ss.str();
+	std::cout << ss.str() << "\n";
+}
+
+void FrameBenchmark::report()
+{
+	std::vector<std::string> kinds;
+	for (auto& step : mSteps)
+		if (std::find(kinds.cbegin(), kinds.cend(), step.kind) == kinds.cend())
+			kinds.push_back(step.kind);
+
+	std::vector<const Frame*> all;
+	all.reserve(mFrames.size());
+
+	for (auto& kind : kinds)
+	{
+		std::vector<const Frame*> frames;
+
+		for (auto& frame : mFrames)
+			if (frame.kind == kind)
+				frames.push_back(&frame);
+
+		reportFrames(kind, frames);
+	}
+
+	for (auto& frame : mFrames)
+		all.push_back(&frame);
+
+	reportFrames("all", all);
+	std::cout.flush();
+}
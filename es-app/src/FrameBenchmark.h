@@ -0,0 +1,59 @@
+#pragma once
+#ifndef ES_APP_FRAME_BENCHMARK_H
+#define ES_APP_FRAME_BENCHMARK_H
+
+#include "renderers/Renderer.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+class Window;
+
+// Scripted navigation through the system & gamelist views, started with --benchmark [frames] (usually with --headless).
+// Each step of the script is rendered for a fixed number of frames with a constant frame time, so that runs can be compared.
+// The CPU time of every frame (update, render & swap) is reported by step kind when the script is complete.
+class FrameBenchmark
+{
+public:
+	static const int FRAME_TIME = 16;
+
+	FrameBenchmark(Window* window, int framesPerStep);
+
+	// Returns false when the script is complete
+	bool beginFrame();
+	void endFrame();
+
+	void report();
+
+private:
+	struct Step
+	{
+		std::string kind;
+		std::function<void()> action;
+		int frames;
+	};
+
+	struct Frame
+	{
+		std::string kind;
+		double time; // ms
+		Renderer::Statistics statistics;
+	};
+
+	void addStep(const std::string& kind, const std::function<void()>& action, int frames);
+	void reportFrames(const std::string& kind, const std::vector<const Frame*>& frames);
+
+	Window* mWindow;
+
+	std::vector<Step> mSteps;
+	std::vector<Frame> mFrames;
+
+	size_t mStep;
+	int mStepFrame;
+
+	std::chrono::steady_clock::time_point mFrameStart;
+};
+
+#endif // ES_APP_FRAME_BENCHMARK_H
@@ -8,7 +8,10 @@
 #include "Settings.h"
 #include "SystemData.h"
 #include <pugixml/src/pugixml.hpp>
+#include <unordered_set>
 #include "Genres.h"
+#include "GamelistSnapshot.h"
+#include "GamelistJournal.h"
 #include "Paths.h"
 
 #ifdef WIN32
@@ -208,10 +211,15 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 	return ret;
 }
 
-void clearTemporaryGamelistRecovery(SystemData* system)
+void clearTemporaryGamelistRecovery(SystemData* system, uint64_t journalPosition = UINT64_MAX)
 {	
 	auto path = getGamelistRecoveryPath(system);
 	Utils::FileSystem::deleteDirectoryFiles(path, true);
+
+	if (journalPosition == UINT64_MAX)
+		GamelistJournal::clear(system);
+	else
+		GamelistJournal::clear(system, journalPosition);
 }
 
 void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap)
@@ -222,25 +230,33 @@ void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*
 	if (size != 0)
 		loadGamelistFile(xmlpath, system, fileMap, SIZE_MAX, true);
 
+	if (size != SIZE_MAX)
+		system->setGamelistHash(size);
+
+	parseGamelistRecovery(system, fileMap);
+}
+
+void parseGamelistRecovery(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap)
+{
+	// Recovery files written by previous versions
 	auto files = Utils::FileSystem::getDirContent(getGamelistRecoveryPath(system), true);
 	for (auto file : files)
-		loadGamelistFile(file, system, fileMap, size, true);
+		loadGamelistFile(file, system, fileMap, system->getGamelistHash(), true);
 
-	if (size != SIZE_MAX)
-		system->setGamelistHash(size);	
+	GamelistJournal::replay(system, fileMap);
 }
 
-bool addFileDataNode(pugi::xml_node& parent, FileData* file, const char* tag, SystemData* system, bool fullPaths = false)
+bool addMetadataNode(pugi::xml_node& parent, const MetaDataList& mdl, const std::string& filePath, FileType type, const std::string& displayName, const std::string& startPath, bool fullPaths)
 {
 	//create game and add to parent node
-	pugi::xml_node newNode = parent.append_child(tag);
+	pugi::xml_node newNode = parent.append_child(type == GAME ? "game" : "folder");
 
 	//write metadata
-	file->getMetadata().appendToXML(newNode, true, system->getStartPath(), fullPaths);
+	mdl.appendToXML(newNode, true, startPath, fullPaths);
 
 	if(newNode.children().begin() == newNode.child("name") //first element is name
 		&& ++newNode.children().begin() == newNode.children().end() //theres only one element
-		&& newNode.child("name").text().get() == file->getDisplayName()) //the name is the default
+		&& newNode.child("name").text().get() == displayName) //the name is the default
 	{
 		//if the only info is the default name, don't bother with this node
 		//delete it and ultimately do nothing
@@ -249,13 +265,13 @@ bool addFileDataNode(pugi::xml_node& parent, FileData* file, const char* tag, Sy
 	}
 
 	if (fullPaths)
-		newNode.prepend_child("path").text().set(file->getPath().c_str());
+		newNode.prepend_child("path").text().set(filePath.c_str());
 	else
 	{
 		// there's something useful in there so we'll keep the node, add the path
 		// try and make the path relative if we can so things still work if we change the rom folder location in the future
-		std::string path = Utils::FileSystem::createRelativePath(file->getPath(), system->getStartPath(), false).c_str();
-		if (path.empty() && file->getType() == FOLDER)
+		std::string path = Utils::FileSystem::createRelativePath(filePath, startPath, false).c_str();
+		if (path.empty() && type == FOLDER)
 			path = ".";
 
 		newNode.prepend_child("path").text().set(path.c_str());
@@ -263,6 +279,39 @@ bool addFileDataNode(pugi::xml_node& parent, FileData* file, const char* tag, Sy
 	return true;	
 }
 
+bool addFileDataNode(pugi::xml_node& parent, FileData* file, const char* tag, SystemData* system, bool fullPaths = false)
+{
+	return addMetadataNode(parent, file->getMetadata(), file->getPath(), file->getType(), file->getDisplayName(), system->getStartPath(), fullPaths);
+}
+
+std::map<std::string, pugi::xml_node> findGamelistNodes(pugi::xml_node& root, const std::string& startPath, const std::vector<std::string>& paths)
+{
+	std::map<std::string, pugi::xml_node> xmlMap;
+
+	// Canonical paths resolve symlinks, which costs a stat per folder level : only the nodes that can match are resolved
+	std::unordered_set<std::string> fileNames;
+	for (auto& path : paths)
+	{
+		fileNames.insert(Utils::FileSystem::getFileName(path));
+		fileNames.insert(Utils::FileSystem::getFileName(Utils::FileSystem::getCanonicalPath(path)));
+	}
+
+	for (pugi::xml_node fileNode : root.children())
+	{
+		pugi::xml_node path = fileNode.child("path");
+		if (!path)
+			continue;
+
+		std::string nodePath = Utils::FileSystem::resolveRelativePath(path.text().get(), startPath, true);
+		if (fileNames.find(Utils::FileSystem::getFileName(nodePath)) == fileNames.cend())
+			continue;
+
+		xmlMap[Utils::FileSystem::getCanonicalPath(nodePath)] = fileNode;
+	}
+
+	return xmlMap;
+}
+
 bool saveToXml(FileData* file, const std::string& fileName, bool fullPaths)
 {
 	SystemData* system = file->getSourceFileData()->getSystem();
@@ -304,14 +353,7 @@ bool saveToGamelistRecovery(FileData* file)
 	if (!Settings::HiddenSystemsShowGames() && !system->isVisible())
 		return false;
 
-	std::string fp = file->getFullPath();
-	fp = Utils::FileSystem::createRelativePath(file->getFullPath(), system->getRootFolder()->getFullPath(), true);
-	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
-
-	std::string path = Utils::FileSystem::getAbsolutePath(fp, getGamelistRecoveryPath(system));
-	path = Utils::FileSystem::getCanonicalPath(path);
-
-	return saveToXml(file, path);
+	return GamelistJournal::append(file->getSourceFileData());
 }
 
 bool removeFromGamelistRecovery(FileData* file)
@@ -320,6 +362,9 @@ bool removeFromGamelistRecovery(FileData* file)
 	if (system == nullptr)
 		return false;
 
+	GamelistJournal::appendRemoved(file->getSourceFileData());
+
+	// Recovery file written by a previous version
 	std::string fp = file->getFullPath();
 	fp = Utils::FileSystem::createRelativePath(file->getFullPath(), system->getRootFolder()->getFullPath(), true);
 	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
@@ -342,8 +387,8 @@ bool hasDirtyFile(SystemData* system)
 	if (rootFolder == nullptr)
 		return false;
 
-	for (auto file : rootFolder->getFilesRecursive(GAME | FOLDER))
-		if (file->getMetadata().wasChanged())
+	for (auto file : system->getDirtyFiles())
+		if (file != rootFolder && (file->getType() == GAME || file->getType() == FOLDER))
 			return true;
 
 	return false;
@@ -369,16 +414,28 @@ void updateGamelist(SystemData* system)
 		return;
 	}
 
+	// The journal may be compacting into the same file
+	std::unique_lock<std::mutex> lock(GamelistJournal::getGamelistLock());
+
+	// Other threads (scrapers, hashers) can change metadata while the file is written : the records they journal
+	// from now on are kept, and the files they change stay dirty
+	uint64_t journalPosition = GamelistJournal::getPosition(system);
+
 	std::vector<FileData*> dirtyFiles;
+	std::vector<unsigned int> dirtyVersions;
 	
-	auto files = rootFolder->getFilesRecursive(GAME | FOLDER, false, nullptr, false);
-	for (auto file : files)
-		if (file->getSystem() == system && file->getMetadata().wasChanged())
+	for (auto file : system->getDirtyFiles())
+	{
+		if (file != rootFolder && (file->getType() == GAME || file->getType() == FOLDER))
+		{
 			dirtyFiles.push_back(file);
+			dirtyVersions.push_back(file->getMetadata().getVersion());
+		}
+	}
 
 	if (dirtyFiles.size() == 0)
 	{
-		clearTemporaryGamelistRecovery(system);
+		clearTemporaryGamelistRecovery(system, journalPosition);
 		return;
 	}
 
@@ -405,17 +462,11 @@ void updateGamelist(SystemData* system)
 	else //set up an empty gamelist to append to		
 		root = doc.append_child("gameList");
 
-	std::map<std::string, pugi::xml_node> xmlMap;
+	std::vector<std::string> dirtyPaths;
+	for (auto file : dirtyFiles)
+		dirtyPaths.push_back(file->getPath());
 
-	for (pugi::xml_node fileNode : root.children())
-	{
-		pugi::xml_node path = fileNode.child("path");
-		if (path)
-		{
-			std::string nodePath = Utils::FileSystem::getCanonicalPath(Utils::FileSystem::resolveRelativePath(path.text().get(), system->getStartPath(), true));
-			xmlMap[nodePath] = fileNode;
-		}
-	}
+	std::map<std::string, pugi::xml_node> xmlMap = findGamelistNodes(root, system->getStartPath(), dirtyPaths);
 	
 	// iterate through all files, checking if they're already in the XML
 	for(auto file : dirtyFiles)
@@ -452,10 +503,28 @@ void updateGamelist(SystemData* system)
 		if (!doc.save_file(WINSTRINGW(xmlWritePath).c_str()))
 			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
 		else
-			clearTemporaryGamelistRecovery(system);
+		{
+			// Changes recorded from now on apply to the new file
+			system->setGamelistHash(Utils::FileSystem::getFileSize(xmlWritePath));
+
+			for (size_t i = 0; i < dirtyFiles.size(); i++)
+				if (dirtyFiles[i]->getMetadata().getVersion() == dirtyVersions[i])
+					dirtyFiles[i]->getMetadata().resetChangedFlag();
+
+			clearTemporaryGamelistRecovery(system, journalPosition);
+
+			// gamelist.xml has changed, too recently for a new snapshot to be trusted : next boot parses it and writes one
+			GamelistSnapshot::remove(system);
+		}
 	}
 	else
-		clearTemporaryGamelistRecovery(system);
+	{
+		for (size_t i = 0; i < dirtyFiles.size(); i++)
+			if (dirtyFiles[i]->getMetadata().getVersion() == dirtyVersions[i])
+				dirtyFiles[i]->getMetadata().resetChangedFlag();
+
+		clearTemporaryGamelistRecovery(system, journalPosition);
+	}
 }
 
 void resetGamelistUsageData(SystemData* system)
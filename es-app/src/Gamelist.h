@@ -5,24 +5,41 @@
 #include <cstdint>
 #include <unordered_map>
 #include <vector>
+#include <map>
 #include <string>
+#include "FileData.h"
 
 class SystemData;
 class FileData;
+class MetaDataList;
+
+namespace pugi
+{
+	class xml_node;
+}
 
 // Loads gamelist.xml data into a SystemData.
 void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
 
+// Applies pending recovery files (changes not yet saved to gamelist.xml)
+void parseGamelistRecovery(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
+
 // Writes currently loaded metadata for a SystemData to gamelist.xml.
 void updateGamelist(SystemData* system);
 void cleanupGamelist(SystemData* system);
 void resetGamelistUsageData(SystemData* system);
 
+// Records the file's metadata in the system's journal, until gamelist.xml is written
 bool saveToGamelistRecovery(FileData* file);
 bool removeFromGamelistRecovery(FileData* file);
 
 bool saveToXml(FileData* file, const std::string& fileName, bool fullPaths = false);
 
+bool addMetadataNode(pugi::xml_node& parent, const MetaDataList& mdl, const std::string& filePath, FileType type, const std::string& displayName, const std::string& startPath, bool fullPaths = false);
+
+// Nodes of a gamelist that belong to one of the paths, keyed by canonical path
+std::map<std::string, pugi::xml_node> findGamelistNodes(pugi::xml_node& root, const std::string& startPath, const std::vector<std::string>& paths);
+
 bool hasDirtyFile(SystemData* system);
 
 std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize = SIZE_MAX, bool fromFile = true);
@@ -0,0 +1,585 @@
+#include "GamelistJournal.h"
+
+#include "utils/BinaryFile.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "GamelistSnapshot.h"
+#include "Gamelist.h"
+#include "FileData.h"
+#include "SystemData.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <pugixml/src/pugixml.hpp>
+#include <stdio.h>
+
+#if WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define JOURNAL_MAGIC			"ESMJ"
+#define JOURNAL_VERSION			1
+#define JOURNAL_HEADER_SIZE		16		// magic, version, gamelist hash
+
+#define JOURNAL_FLUSH_DELAY		2000	// ms
+#define JOURNAL_FLUSH_SIZE		(64 * 1024)
+#define JOURNAL_COMPACT_SIZE	(1024 * 1024)
+
+enum JournalRecordType : uint8_t
+{
+	RECORD_METADATA = 1,
+	RECORD_REMOVED = 2
+};
+
+std::mutex GamelistJournal::mLock;
+std::mutex GamelistJournal::mWriteLock;
+std::condition_variable GamelistJournal::mEvent;
+std::map<SystemData*, GamelistJournal::Journal> GamelistJournal::mJournals;
+std::thread* GamelistJournal::mThread = nullptr;
+bool GamelistJournal::mRunning = false;
+bool GamelistJournal::mStopped = false;
+
+std::mutex& GamelistJournal::getGamelistLock()
+{
+	static std::mutex gamelistLock;
+	return gamelistLock;
+}
+
+std::string GamelistJournal::getJournalPath(SystemData* system)
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/recovery/" + system->getName() + ".journal");
+}
+
+// A record is its length followed by : type, file type, relative flag, path, display name & metadata
+struct JournalRecord
+{
+	JournalRecord() : type(0), fileType(GAME), data(nullptr), size(0) { }
+
+	uint8_t		type;
+	FileType	fileType;
+	std::string path;
+	std::string displayName;
+	const char* data;	// whole record, read again to load the metadata
+	size_t		size;
+};
+
+static bool readRecord(Utils::BinaryReader& reader, const std::string& startPath, JournalRecord& record)
+{
+	uint32_t length = reader.read<uint32_t>();
+	const char* data = reader.readBytes(length);
+	if (reader.failed())
+		return false;
+
+	Utils::BinaryReader recordReader(data, length);
+	record.type = recordReader.read<uint8_t>();
+	record.fileType = (FileType)recordReader.read<uint8_t>();
+	bool isRelative = recordReader.read<uint8_t>() != 0;
+	record.path = recordReader.readString();
+	record.displayName = recordReader.readString();
+	record.data = data;
+	record.size = length;
+
+	if (recordReader.failed() || (record.type != RECORD_METADATA && record.type != RECORD_REMOVED) || (record.fileType != GAME && record.fileType != FOLDER))
+		return false;
+
+	if (isRelative)
+		record.path = startPath + "/" + record.path;
+
+	return true;
+}
+
+// Positions the reader on the metadata of a record
+static void skipRecordHeader(Utils::BinaryReader& reader)
+{
+	reader.read<uint8_t>();
+	reader.read<uint8_t>();
+	reader.read<uint8_t>();
+	reader.readString();
+	reader.readString();
+}
+
+// Reads every complete record. The last one may have been cut by a crash : validSize is where the valid records end
+static std::vector<JournalRecord> readRecords(const Utils::MappedFile& file, const std::string& startPath, uint64_t gamelistHash, size_t& validSize)
+{
+	std::vector<JournalRecord> records;
+	validSize = 0;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (!reader.readMagic(JOURNAL_MAGIC) || reader.read<uint32_t>() != JOURNAL_VERSION || reader.read<uint64_t>() != gamelistHash)
+		return records;
+
+	validSize = JOURNAL_HEADER_SIZE;
+
+	while (!reader.eof())
+	{
+		JournalRecord record;
+		if (!readRecord(reader, startPath, record))
+			break;
+
+		records.push_back(record);
+		validSize = (record.data - file.data()) + record.size;
+	}
+
+	return records;
+}
+
+bool GamelistJournal::append(FileData* file)
+{
+	return appendRecord(file, false);
+}
+
+bool GamelistJournal::appendRemoved(FileData* file)
+{
+	return appendRecord(file, true);
+}
+
+bool GamelistJournal::appendRecord(FileData* file, bool removed)
+{
+	if (file == nullptr || (file->getType() != GAME && file->getType() != FOLDER))
+		return false;
+
+	// The journal is merged into gamelist.xml : same conditions as writing it
+	if (Settings::IgnoreGamelist() || !Settings::SaveGamelistsOnExit())
+		return false;
+
+	SystemData* system = file->getSystem();
+	if (system == nullptr || !system->isGameSystem() || system->isCollection())
+		return false;
+
+	std::string startPath = system->getStartPath();
+	std::string path = file->getPath();
+
+	bool isRelative = Utils::String::startsWith(path, startPath + "/");
+	if (isRelative)
+		path = path.substr(startPath.size() + 1);
+
+	Utils::BinaryWriter record;
+	record.write<uint8_t>(removed ? RECORD_REMOVED : RECORD_METADATA);
+	record.write<uint8_t>((uint8_t)file->getType());
+	record.write<uint8_t>(isRelative ? 1 : 0);
+	record.writeString(path);
+	record.writeString(file->getDisplayName());
+
+	if (!removed)
+		GamelistSnapshot::writeMetadata(record, file->getMetadata());
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mJournals.find(system);
+	if (it == mJournals.cend())
+	{
+		Journal& journal = mJournals[system];
+		journal.system = system;
+		journal.path = getJournalPath(system);
+		journal.startPath = startPath;
+		journal.gamelistReadPath = system->getGamelistPath(false);
+		journal.gamelistWritePath = system->getGamelistPath(true);
+		journal.gamelistHash = system->getGamelistHash();
+
+		it = mJournals.find(system);
+	}
+
+	Journal& journal = it->second;
+	uint32_t length = (uint32_t)record.buffer().size();
+	journal.pending.append((const char*)&length, sizeof(length));
+	journal.pending.append(record.buffer());
+	journal.appended += sizeof(length) + length;
+
+	if (!mRunning && !mStopped)
+	{
+		// The thread only starts once : pending records are also written when the process exits without calling stop (signals)
+		atexit(&GamelistJournal::stop);
+
+		mRunning = true;
+		mThread = new std::thread(&GamelistJournal::run);
+	}
+
+	if (journal.pending.size() >= JOURNAL_FLUSH_SIZE)
+		mEvent.notify_one();
+
+	return true;
+}
+
+void GamelistJournal::write(Journal& journal, const std::string& records)
+{
+	if (!journal.headerChecked)
+	{
+		// Keep the records of a previous session, if they still apply to the current gamelist.xml
+		size_t validSize = 0;
+
+		{
+			Utils::MappedFile file(journal.path);
+			if (file.data() != nullptr)
+			{
+				readRecords(file, journal.startPath, journal.gamelistHash, validSize);
+
+				if (validSize != 0 && validSize < file.size())
+				{
+					LOG(LogWarning) << "GamelistJournal : Truncated record removed from " << journal.path;
+
+					Utils::BinaryWriter writer;
+					writer.writeBytes(file.data(), validSize);
+					if (!writer.save(journal.path))
+						validSize = 0;
+				}
+			}
+		}
+
+		if (validSize == 0)
+		{
+			Utils::BinaryWriter writer;
+			writer.writeMagic(JOURNAL_MAGIC);
+			writer.write<uint32_t>(JOURNAL_VERSION);
+			writer.write<uint64_t>(journal.gamelistHash);
+
+			if (!writer.save(journal.path))
+			{
+				LOG(LogError) << "GamelistJournal : Unable to write " << journal.path;
+				return;
+			}
+
+			validSize = JOURNAL_HEADER_SIZE;
+		}
+
+		journal.fileSize = validSize;
+		journal.headerChecked = true;
+	}
+
+	if (records.empty())
+		return;
+
+#if WIN32
+	FILE* file = _wfopen(Utils::String::convertToWideString(journal.path).c_str(), L"ab");
+#else
+	FILE* file = fopen(journal.path.c_str(), "ab");
+#endif
+	if (file == nullptr)
+	{
+		LOG(LogError) << "GamelistJournal : Unable to open " << journal.path;
+		return;
+	}
+
+	bool written = fwrite(records.c_str(), 1, records.size(), file) == records.size() && fflush(file) == 0;
+
+	// One sync per batch of records
+#if WIN32
+	_commit(_fileno(file));
+#else
+	fsync(fileno(file));
+#endif
+	fclose(file);
+
+	if (written)
+		journal.fileSize += records.size();
+	else
+		LOG(LogError) << "GamelistJournal : Unable to write " << journal.path;
+}
+
+void GamelistJournal::flush()
+{
+	std::unique_lock<std::mutex> writeLock(mWriteLock);
+
+	// Journals are only erased with both locks held : the references stay valid while writing
+	std::vector<std::pair<Journal*, std::string>> batches;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		for (auto& it : mJournals)
+		{
+			if (it.second.pending.empty())
+				continue;
+
+			batches.push_back(std::pair<Journal*, std::string>(&it.second, std::string()));
+			batches.back().second.swap(it.second.pending);
+		}
+	}
+
+	for (auto& batch : batches)
+	{
+		write(*batch.first, batch.second);
+
+		if (batch.first->fileSize >= JOURNAL_COMPACT_SIZE)
+			compact(*batch.first);
+	}
+}
+
+void GamelistJournal::compact(Journal& journal)
+{
+	// gamelist.xml is never written when it is ignored, as in updateGamelist
+	if (Settings::IgnoreGamelist())
+		return;
+
+	// updateGamelist clears the journal with the gamelist lock held : never wait for it here, compaction can be retried
+	std::unique_lock<std::mutex> gamelistLock(getGamelistLock(), std::try_to_lock);
+	if (!gamelistLock.owns_lock())
+		return;
+
+	std::vector<JournalRecord> records;
+	std::unordered_map<std::string, size_t> lastRecords;
+
+	Utils::MappedFile file(journal.path);
+
+	size_t validSize = 0;
+	records = readRecords(file, journal.startPath, journal.gamelistHash, validSize);
+	if (records.empty())
+		return;
+
+	std::vector<std::string> paths;
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		if (lastRecords.find(records[i].path) == lastRecords.cend())
+			paths.push_back(records[i].path);
+
+		lastRecords[records[i].path] = i;
+	}
+
+	pugi::xml_document doc;
+	pugi::xml_node root;
+
+	if (Utils::FileSystem::exists(journal.gamelistReadPath))
+	{
+		pugi::xml_parse_result result = doc.load_file(WINSTRINGW(journal.gamelistReadPath).c_str());
+		if (!result)
+		{
+			LOG(LogError) << "GamelistJournal : Error parsing XML file \"" << journal.gamelistReadPath << "\"!\n	" << result.description();
+			return;
+		}
+
+		root = doc.child("gameList");
+	}
+
+	if (!root)
+		root = doc.append_child("gameList");
+
+	auto xmlMap = findGamelistNodes(root, journal.startPath, paths);
+
+	int numUpdated = 0;
+
+	for (auto& path : paths)
+	{
+		const JournalRecord& record = records[lastRecords[path]];
+		if (record.type != RECORD_METADATA)
+			continue;
+
+		auto xmf = xmlMap.find(Utils::FileSystem::getCanonicalPath(path));
+		if (xmf != xmlMap.cend())
+			root.remove_child(xmf->second);
+
+		MetaDataList mdl(record.fileType == FOLDER ? FOLDER_METADATA : GAME_METADATA);
+
+		Utils::BinaryReader reader(record.data, record.size);
+		skipRecordHeader(reader);
+		GamelistSnapshot::readMetadata(reader, mdl, journal.system);
+		if (reader.failed())
+			continue;
+
+		addMetadataNode(root, mdl, path, record.fileType, record.displayName, journal.startPath);
+		numUpdated++;
+	}
+
+	Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(journal.gamelistWritePath));
+
+	if (!doc.save_file(WINSTRINGW(journal.gamelistWritePath).c_str()))
+	{
+		LOG(LogError) << "GamelistJournal : Error saving gamelist.xml to \"" << journal.gamelistWritePath << "\"";
+		return;
+	}
+
+	LOG(LogInfo) << "GamelistJournal : " << numUpdated << " changes merged into " << journal.gamelistWritePath;
+
+	uint64_t gamelistHash = Utils::FileSystem::getFileSize(journal.gamelistWritePath);
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		journal.gamelistHash = gamelistHash;
+		journal.system->setGamelistHash((size_t)gamelistHash);
+	}
+
+	// Start a new journal for the new gamelist.xml
+	journal.headerChecked = false;
+	Utils::FileSystem::removeFile(journal.path);
+	write(journal, std::string());
+}
+
+void GamelistJournal::run()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mEvent.wait_for(lock, std::chrono::milliseconds(JOURNAL_FLUSH_DELAY));
+
+			if (!mRunning)
+				break;
+		}
+
+		flush();
+	}
+}
+
+void GamelistJournal::stop()
+{
+	std::thread* thread = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+		mStopped = true;
+		mRunning = false;
+		mEvent.notify_one();
+
+		std::swap(thread, mThread);
+	}
+
+	if (thread != nullptr)
+	{
+		thread->join();
+		delete thread;
+	}
+
+	flush();
+}
+
+void GamelistJournal::clear(SystemData* system)
+{
+	std::unique_lock<std::mutex> writeLock(mWriteLock);
+	std::unique_lock<std::mutex> lock(mLock);
+
+	// Pending records are dropped too : gamelist.xml contains them
+	mJournals.erase(system);
+	Utils::FileSystem::removeFile(getJournalPath(system));
+}
+
+uint64_t GamelistJournal::getPosition(SystemData* system)
+{
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto it = mJournals.find(system);
+	return it == mJournals.cend() ? 0 : it->second.appended;
+}
+
+void GamelistJournal::clear(SystemData* system, uint64_t position)
+{
+	std::unique_lock<std::mutex> writeLock(mWriteLock);
+
+	Journal* journal = nullptr;
+	std::string records;
+	size_t kept = 0;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		auto it = mJournals.find(system);
+		if (it == mJournals.cend() || it->second.appended <= position)
+		{
+			mJournals.erase(system);
+			Utils::FileSystem::removeFile(getJournalPath(system));
+			return;
+		}
+
+		// The records appended after position are the last ones : at the end of the file, then in the pending ones
+		journal = &it->second;
+		kept = (size_t)(journal->appended - position);
+		records.swap(journal->pending);
+
+		journal->gamelistHash = system->getGamelistHash();
+		journal->headerChecked = false;
+	}
+
+	if (kept > records.size())
+	{
+		Utils::MappedFile file(journal->path);
+
+		size_t fromFile = std::min(kept - records.size(), file.size() > JOURNAL_HEADER_SIZE ? file.size() - JOURNAL_HEADER_SIZE : 0);
+		if (fromFile != 0)
+			records.insert(0, file.data() + file.size() - fromFile, fromFile);
+	}
+	else
+		records.erase(0, records.size() - kept);
+
+	// Start a new journal for the new gamelist.xml
+	Utils::FileSystem::removeFile(journal->path);
+	write(*journal, records);
+}
+
+void GamelistJournal::detach(SystemData* system)
+{
+	std::unique_lock<std::mutex> writeLock(mWriteLock);
+
+	// Journals are only erased with both locks held : the reference stays valid while writing, as in flush()
+	Journal* journal = nullptr;
+	std::string records;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		auto it = mJournals.find(system);
+		if (it == mJournals.cend())
+			return;
+
+		journal = &it->second;
+		records.swap(journal->pending);
+	}
+
+	write(*journal, records);
+
+	std::unique_lock<std::mutex> lock(mLock);
+	mJournals.erase(system);
+}
+
+void GamelistJournal::replay(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap)
+{
+	Utils::MappedFile file(getJournalPath(system));
+	if (file.data() == nullptr)
+		return;
+
+	size_t validSize = 0;
+	auto records = readRecords(file, system->getStartPath(), system->getGamelistHash(), validSize);
+	if (validSize == 0)
+	{
+		LOG(LogInfo) << "GamelistJournal : gamelist.xml changed since the journal of " << system->getName() << " was written, ignored";
+		return;
+	}
+
+	std::unordered_map<std::string, size_t> lastRecords;
+	for (size_t i = 0; i < records.size(); i++)
+		lastRecords[records[i].path] = i;
+
+	int count = 0;
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		const JournalRecord& record = records[i];
+		if (record.type != RECORD_METADATA || lastRecords[record.path] != i)
+			continue;
+
+		auto it = fileMap.find(record.path);
+		if (it == fileMap.cend() || it->second->getType() != record.fileType)
+		{
+			LOG(LogWarning) << "GamelistJournal : File \"" << record.path << "\" does not exist ! Ignoring.";
+			continue;
+		}
+
+		// Corrupted records leave the metadata untouched
+		MetaDataList loaded(record.fileType == FOLDER ? FOLDER_METADATA : GAME_METADATA);
+
+		Utils::BinaryReader reader(record.data, record.size);
+		skipRecordHeader(reader);
+		GamelistSnapshot::readMetadata(reader, loaded, system);
+		if (reader.failed())
+			continue;
+
+		MetaDataList& mdl = it->second->getMetadata();
+		mdl = loaded;
+
+		// Not in gamelist.xml yet
+		mdl.setDirty();
+		count++;
+	}
+
+	if (count > 0)
+		LOG(LogInfo) << "GamelistJournal : " << count << " changes replayed for " << system->getName();
+}
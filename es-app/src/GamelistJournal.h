@@ -0,0 +1,83 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_JOURNAL_H
+#define ES_APP_GAMELIST_JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <stdint.h>
+
+class SystemData;
+class FileData;
+
+// Append-only journal of the metadata changes that are not saved to gamelist.xml yet, one per system in
+// <user>/recovery/<system>.journal. A change appends the whole metadata of the game : records are buffered, then
+// written & synced in batches by a background thread, and replayed at load (the last record of a game wins).
+// When a journal grows too large, the thread merges it into gamelist.xml and starts a new one.
+class GamelistJournal
+{
+public:
+	static bool append(FileData* file);
+	static bool appendRemoved(FileData* file);
+
+	// Applies the pending changes to the files just loaded
+	static void replay(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
+
+	// gamelist.xml contains every change : the journal is deleted
+	static void clear(SystemData* system);
+
+	// Amount of records appended so far, to clear the journal up to it once gamelist.xml contains them
+	static uint64_t getPosition(SystemData* system);
+	// gamelist.xml contains the changes recorded before position : only the following records are kept
+	static void clear(SystemData* system, uint64_t position);
+
+	// Writes the pending records of a system which is being deleted
+	static void detach(SystemData* system);
+
+	static void flush();
+	static void stop();
+
+	// Held while gamelist.xml is rewritten
+	static std::mutex& getGamelistLock();
+
+private:
+	struct Journal
+	{
+		Journal() : system(nullptr), gamelistHash(0), fileSize(0), appended(0), headerChecked(false) { }
+
+		SystemData*	system;
+		std::string path;
+		std::string startPath;
+		std::string gamelistReadPath;
+		std::string gamelistWritePath;
+		uint64_t	gamelistHash;
+		std::string pending;
+		size_t		fileSize;
+		uint64_t	appended;	// Bytes of records appended since the journal was opened
+		bool		headerChecked;
+	};
+
+	static std::string getJournalPath(SystemData* system);
+
+	static bool appendRecord(FileData* file, bool removed);
+
+	// Both need mWriteLock
+	static void write(Journal& journal, const std::string& records);
+	static void compact(Journal& journal);
+
+	static void run();
+
+	static std::mutex mLock;			// journals & pending records
+	static std::mutex mWriteLock;		// journal files
+	static std::condition_variable mEvent;
+	static std::map<SystemData*, Journal> mJournals;
+	static std::thread* mThread;	// Never a static std::thread : exit() would destroy it while joinable
+	static bool mRunning;
+	static bool mStopped;
+};
+
+#endif // ES_APP_GAMELIST_JOURNAL_H
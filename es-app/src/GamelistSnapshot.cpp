@@ -0,0 +1,361 @@
+#include "GamelistSnapshot.h"
+
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "utils/BinaryFile.h"
+#include "utils/DirectoryIndex.h"
+#include "FileData.h"
+#include "SystemData.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <stack>
+
+#define SNAPSHOT_MAGIC		"ESGS"
+#define SNAPSHOT_VERSION	1
+#define NO_PARENT			0xFFFFFFFF
+
+// A gamelist written less than this number of seconds ago could be written again with the same size and last write time
+#define RECENT_WRITE_DELAY	2
+
+void GamelistSnapshot::writeMetadata(Utils::BinaryWriter& writer, const MetaDataList& mdl)
+{
+	writer.write<uint8_t>(mdl.mRelativeTo != nullptr ? 1 : 0);
+	writer.writeString(mdl.mName);
+
+	writer.write<uint8_t>((uint8_t)mdl.mValues.size());
+	for (auto& value : mdl.mValues)
+	{
+		writer.write<uint8_t>(value.id);
+		writer.writeString(value.toString());
+	}
+
+	writer.write<uint16_t>((uint16_t)mdl.mUnKnownElements.size());
+	for (auto element : mdl.mUnKnownElements)
+	{
+		writer.writeString(std::get<0>(element));
+		writer.writeString(std::get<1>(element));
+		writer.write<uint8_t>(std::get<2>(element) ? 1 : 0);
+	}
+
+	writer.write<uint8_t>((uint8_t)mdl.mScrapeDates.size());
+	for (auto scrapeDate : mdl.mScrapeDates)
+	{
+		writer.write<uint8_t>((uint8_t)scrapeDate.first);
+		writer.write<int64_t>((int64_t)scrapeDate.second.getTime());
+	}
+}
+
+void GamelistSnapshot::readMetadata(Utils::BinaryReader& reader, MetaDataList& mdl, SystemData* system)
+{
+	mdl.mRelativeTo = reader.read<uint8_t>() ? system : nullptr;
+	mdl.mName = reader.readString();
+
+	mdl.mSlots = 0;
+	mdl.mValues.clear();
+
+	int count = reader.read<uint8_t>();
+	mdl.mValues.reserve(count);
+
+	for (int i = 0; i < count && !reader.failed(); i++)
+	{
+		int id = reader.read<uint8_t>();
+		std::string value = reader.readString();
+
+		// Ids are indexes in the declared metadata types : an unknown one means the data is corrupted
+		if (id >= (int)MetaDataList::getMDD().size())
+			reader.fail();
+
+		if (!reader.failed())
+			mdl.setValue((MetaDataId)id, value);
+	}
+
+	mdl.mUnKnownElements.clear();
+	count = reader.read<uint16_t>();
+	for (int i = 0; i < count && !reader.failed(); i++)
+	{
+		std::string name = reader.readString();
+		std::string value = reader.readString();
+		bool isElement = reader.read<uint8_t>() != 0;
+		mdl.mUnKnownElements.push_back(std::tuple<std::string, std::string, bool>(name, value, isElement));
+	}
+
+	mdl.mScrapeDates.clear();
+	count = reader.read<uint8_t>();
+	for (int i = 0; i < count && !reader.failed(); i++)
+	{
+		int scraperId = reader.read<uint8_t>();
+		mdl.mScrapeDates[scraperId] = Utils::Time::DateTime((time_t)reader.read<int64_t>());
+	}
+
+	mdl.resetChangedFlag();
+	mdl.mVersion = ++MetaDataList::sVersion;
+}
+
+bool GamelistSnapshot::isEnabled(SystemData* system)
+{
+	if (system == nullptr || !Settings::GamelistSnapshots() || Settings::IgnoreGamelist())
+		return false;
+
+	return system->isGameSystem() && !system->isCollection() && !system->isGroupSystem() && system->getSystemEnvData() != nullptr;
+}
+
+std::string GamelistSnapshot::getSnapshotPath(SystemData* system)
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/gamelists/" + system->getName() + ".cache");
+}
+
+std::string GamelistSnapshot::getFingerprint(SystemData* system)
+{
+	// Everything that changes the result of SystemData::populateFolder & parseGamelist
+	bool showHidden = Settings::ShowHiddenFiles();
+
+	auto shv = Settings::getInstance()->getString(system->getName() + ".ShowHiddenFiles");
+	if (shv == "1") showHidden = true;
+	else if (shv == "0") showHidden = false;
+
+	std::string fingerprint = system->getStartPath() + "|" + system->getGamelistPath(false) + "|";
+
+	for (auto ext : system->getExtensions())
+		fingerprint += ext + " ";
+
+	fingerprint += std::string("|") +
+		(showHidden ? "1" : "0") +
+		(Settings::ParseGamelistOnly() ? "1" : "0") +
+		(Settings::RemoveMultiDiskContent() ? "1" : "0") +
+		(Settings::PreloadMedias() ? "1" : "0");
+
+	return fingerprint;
+}
+
+bool GamelistSnapshot::load(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap)
+{
+	if (!isEnabled(system))
+		return false;
+
+	std::string path = getSnapshotPath(system);
+
+	Utils::MappedFile file(path);
+	if (file.data() == nullptr)
+		return false;
+
+	StopWatch stopWatch("GamelistSnapshot::load - " + system->getName() + " :", LogDebug);
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (!reader.readMagic(SNAPSHOT_MAGIC) || reader.read<uint32_t>() != SNAPSHOT_VERSION)
+	{
+		LOG(LogInfo) << "GamelistSnapshot : Invalid snapshot version for " << system->getName();
+		return false;
+	}
+
+	if (reader.readString() != getFingerprint(system))
+	{
+		LOG(LogInfo) << "GamelistSnapshot : Settings changed for " << system->getName();
+		return false;
+	}
+
+	std::string xmlPath = system->getGamelistPath(false);
+
+	uint64_t gamelistSize = reader.read<uint64_t>();
+	int64_t gamelistTime = reader.read<int64_t>();
+
+	if (reader.failed() || gamelistSize != (uint64_t)Utils::FileSystem::getFileSize(xmlPath) || gamelistTime != (int64_t)Utils::FileSystem::getLastWriteTime(xmlPath))
+	{
+		LOG(LogInfo) << "GamelistSnapshot : Gamelist changed for " << system->getName();
+		return false;
+	}
+
+	if (gamelistTime + RECENT_WRITE_DELAY >= (int64_t)time(NULL))
+	{
+		LOG(LogInfo) << "GamelistSnapshot : Gamelist written too recently for " << system->getName();
+		return false;
+	}
+
+	uint32_t folderCount = reader.read<uint32_t>();
+	for (uint32_t i = 0; i < folderCount && !reader.failed(); i++)
+	{
+		std::string folderPath = reader.readString();
+		time_t lastWriteTime = (time_t)reader.read<int64_t>();
+
+		if (Utils::FileSystem::getLastWriteTime(folderPath) != lastWriteTime)
+		{
+			LOG(LogInfo) << "GamelistSnapshot : Folder " << folderPath << " changed for " << system->getName();
+			return false;
+		}
+
+		// The listing is not needed this time, but will be if the snapshot goes stale
+		Utils::DirectoryIndex::keep(folderPath);
+	}
+
+	uint32_t nodeCount = reader.read<uint32_t>();
+	if (reader.failed() || nodeCount == 0)
+		return false;
+
+	FolderData* root = system->getRootFolder();
+	const std::string startPath = system->getStartPath();
+
+	std::vector<FileData*> nodes;
+	nodes.reserve(nodeCount);
+
+	// Root folder
+	reader.read<uint8_t>();
+	reader.read<uint32_t>();
+	reader.read<uint8_t>();
+	reader.readString();
+
+	MetaDataList rootMetadata(FOLDER_METADATA);
+	readMetadata(reader, rootMetadata, system);
+	nodes.push_back(root);
+
+	for (uint32_t i = 1; i < nodeCount && !reader.failed(); i++)
+	{
+		FileType type = (FileType)reader.read<uint8_t>();
+		uint32_t parentIndex = reader.read<uint32_t>();
+		bool isRelative = reader.read<uint8_t>() != 0;
+		std::string filePath = reader.readString();
+
+		if (reader.failed() || parentIndex >= nodes.size() || nodes[parentIndex]->getType() != FOLDER || (type != GAME && type != FOLDER))
+		{
+			LOG(LogError) << "GamelistSnapshot : Corrupted snapshot for " << system->getName();
+
+			root->clear();
+			fileMap.clear();
+			fileMap[startPath] = root;
+			return false;
+		}
+
+		if (isRelative)
+			filePath = startPath + "/" + filePath;
+
+		FileData* item = (type == FOLDER ? new FolderData(filePath, system) : new FileData(GAME, filePath, system));
+		readMetadata(reader, item->getMetadata(), system);
+
+		((FolderData*)nodes[parentIndex])->addChild(item);
+		fileMap[filePath] = item;
+		nodes.push_back(item);
+	}
+
+	if (reader.failed())
+	{
+		LOG(LogError) << "GamelistSnapshot : Corrupted snapshot for " << system->getName();
+
+		root->clear();
+		fileMap.clear();
+		fileMap[startPath] = root;
+		return false;
+	}
+
+	root->setMetadata(rootMetadata);
+	system->setGamelistHash(gamelistSize);
+
+	LOG(LogInfo) << "GamelistSnapshot : Loaded " << (nodeCount - 1) << " entries for " << system->getName();
+	return true;
+}
+
+bool GamelistSnapshot::save(SystemData* system, const std::vector<SnapshotFolder>& folders)
+{
+	if (!isEnabled(system))
+		return false;
+
+	FolderData* root = system->getRootFolder();
+	if (root == nullptr)
+		return false;
+
+	std::string xmlPath = system->getGamelistPath(false);
+	time_t gamelistTime = Utils::FileSystem::getLastWriteTime(xmlPath);
+
+	// Snapshots of such gamelists are not trusted : don't write one. The next save of the gamelist refreshes it
+	if (gamelistTime + RECENT_WRITE_DELAY >= time(NULL))
+		return false;
+
+	std::string path = getSnapshotPath(system);
+
+	StopWatch stopWatch("GamelistSnapshot::save - " + system->getName() + " :", LogDebug);
+
+	const std::string startPath = system->getStartPath();
+
+	Utils::BinaryWriter writer;
+	writer.writeMagic(SNAPSHOT_MAGIC);
+	writer.write<uint32_t>(SNAPSHOT_VERSION);
+	writer.writeString(getFingerprint(system));
+	writer.write<uint64_t>((uint64_t)Utils::FileSystem::getFileSize(xmlPath));
+	writer.write<int64_t>((int64_t)gamelistTime);
+
+	writer.write<uint32_t>((uint32_t)folders.size());
+	for (auto folder : folders)
+	{
+		writer.writeString(folder.path);
+		writer.write<int64_t>((int64_t)folder.lastWriteTime);
+	}
+
+	std::vector<std::pair<FileData*, uint32_t>> nodes;
+
+	std::stack<std::pair<FileData*, uint32_t>> stack;
+	stack.push(std::pair<FileData*, uint32_t>(root, NO_PARENT));
+
+	while (stack.size())
+	{
+		auto current = stack.top();
+		stack.pop();
+
+		uint32_t index = (uint32_t)nodes.size();
+		nodes.push_back(current);
+
+		if (current.first->getType() != FOLDER)
+			continue;
+
+		// Push in reverse order so that children are written in their current order
+		auto children = ((FolderData*)current.first)->getChildren();
+		for (auto it = children.crbegin(); it != children.crend(); ++it)
+		{
+			FileData* child = *it;
+			if (child->getSystem() != system || (child->getType() != GAME && child->getType() != FOLDER))
+				continue;
+
+			if (child->getType() == FOLDER && ((FolderData*)child)->isVirtualStorage())
+				continue;
+
+			stack.push(std::pair<FileData*, uint32_t>(child, index));
+		}
+	}
+
+	writer.write<uint32_t>((uint32_t)nodes.size());
+
+	std::string prefix = startPath + "/";
+
+	for (auto node : nodes)
+	{
+		std::string filePath = (node.second == NO_PARENT ? "" : node.first->getPath());
+		bool isRelative = Utils::String::startsWith(filePath, prefix);
+		if (isRelative)
+			filePath = filePath.substr(prefix.size());
+
+		writer.write<uint8_t>((uint8_t)node.first->getType());
+		writer.write<uint32_t>(node.second);
+		writer.write<uint8_t>(isRelative ? 1 : 0);
+		writer.writeString(filePath);
+
+		writeMetadata(writer, node.first->getMetadata());
+	}
+
+	if (!writer.save(path))
+	{
+		LOG(LogError) << "GamelistSnapshot : Unable to write " << path;
+		return false;
+	}
+
+	return true;
+}
+
+void GamelistSnapshot::remove(SystemData* system)
+{
+	std::string path = getSnapshotPath(system);
+	if (Utils::FileSystem::exists(path))
+		Utils::FileSystem::removeFile(path);
+}
+
+void GamelistSnapshot::removeAll()
+{
+	Utils::FileSystem::deleteDirectoryFiles(Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/gamelists"));
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef ES_APP_GAMELIST_SNAPSHOT_H
+#define ES_APP_GAMELIST_SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <time.h>
+
+class SystemData;
+class FileData;
+class FolderData;
+class MetaDataList;
+
+namespace Utils
+{
+	class BinaryReader;
+	class BinaryWriter;
+}
+
+struct SnapshotFolder
+{
+	SnapshotFolder() : lastWriteTime(0) { }
+	SnapshotFolder(const std::string& _path, time_t _lastWriteTime) : path(_path), lastWriteTime(_lastWriteTime) { }
+
+	std::string path;
+	time_t		lastWriteTime;
+};
+
+// Binary image of a system's FileData tree & metadatas, written after a successful load.
+// A snapshot is only reused if the gamelist (size/date), the settings that drive the scan
+// and the last write time of every folder that was enumerated are still the same.
+class GamelistSnapshot
+{
+public:
+	static bool isEnabled(SystemData* system);
+
+	// Rebuilds the system's tree from its snapshot. Returns false if the snapshot is missing or stale
+	static bool load(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
+
+	// Writes the current tree, with the folders enumerated to build it. Refused while the gamelist was just written
+	static bool save(SystemData* system, const std::vector<SnapshotFolder>& folders);
+
+	static void remove(SystemData* system);
+	static void removeAll();
+
+	// Binary image of a metadata list, also used by GamelistJournal
+	static void writeMetadata(Utils::BinaryWriter& writer, const MetaDataList& mdl);
+	static void readMetadata(Utils::BinaryReader& reader, MetaDataList& mdl, SystemData* system);
+
+private:
+	static std::string getSnapshotPath(SystemData* system);
+	static std::string getFingerprint(SystemData* system);
+};
+
+#endif // ES_APP_GAMELIST_SNAPSHOT_H
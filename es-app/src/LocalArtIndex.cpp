@@ -0,0 +1,90 @@
+#include "LocalArtIndex.h"
+
+#include "utils/DirectoryIndex.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Settings.h"
+
+#define REFRESH_DELAY		1000	// ms
+
+// Folders written less than this number of seconds before being listed are listed again at the next check :
+// with coarse file system timestamps, a following change could keep the same last write time
+#define RECENT_WRITE_DELAY	2
+
+std::mutex LocalArtIndex::mLock;
+std::unordered_map<std::string, LocalArtIndex::MediaFolder> LocalArtIndex::mFolders;
+
+static std::string getIndexedName(const std::string& fileName)
+{
+#if WIN32
+	return Utils::String::toLower(fileName);
+#else
+	return fileName;
+#endif
+}
+
+bool LocalArtIndex::exists(const std::string& folder, const std::string& fileName)
+{
+	std::string name = getIndexedName(fileName);
+
+	bool trusted;
+	time_t knownWriteTime;
+	unsigned int check;
+
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		MediaFolder& media = mFolders[folder];
+
+		auto now = std::chrono::steady_clock::now();
+		if (media.checked && std::chrono::duration_cast<std::chrono::milliseconds>(now - media.lastCheck).count() < REFRESH_DELAY)
+			return media.files.find(name) != media.files.cend();
+
+		// Other threads keep using the current list until the new one is ready. Until the first one is, they list too
+		media.lastCheck = now;
+		check = ++media.checkCount;
+
+		trusted = media.trusted;
+		knownWriteTime = media.lastWriteTime;
+	}
+
+	// Listing a network share can be slow : it is done without holding the lock
+	time_t lastWriteTime = Utils::FileSystem::getLastWriteTime(folder);
+	if (trusted && lastWriteTime == knownWriteTime)
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		MediaFolder& media = mFolders[folder];
+		return media.files.find(name) != media.files.cend();
+	}
+
+	// A missing folder stays empty : every lookup is a miss
+	std::unordered_set<std::string> files;
+	if (lastWriteTime != 0)
+	{
+		// The directory index is only loaded & saved along with the gamelist snapshots, as in SystemData's listFolder
+		auto list = Settings::GamelistSnapshots() ? Utils::DirectoryIndex::getDirectoryFiles(folder) : Utils::FileSystem::getDirectoryFiles(folder);
+
+		for (auto& file : list)
+			if (!file.directory)
+				files.insert(getIndexedName(Utils::FileSystem::getFileName(file.path)));
+	}
+
+	bool found = files.find(name) != files.cend();
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	MediaFolder& media = mFolders[folder];
+
+	// A check started later may have finished first : its listing is newer, keep it
+	if (media.checked && (int)(check - media.storedCheck) < 0)
+		return found;
+
+	media.checked = true;
+	media.storedCheck = check;
+	media.lastWriteTime = lastWriteTime;
+	media.trusted = lastWriteTime == 0 || lastWriteTime + RECENT_WRITE_DELAY < time(NULL);
+	media.files.swap(files);
+
+	return found;
+}
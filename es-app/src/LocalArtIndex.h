@@ -0,0 +1,38 @@
+#pragma once
+#ifndef ES_APP_LOCAL_ART_INDEX_H
+#define ES_APP_LOCAL_ART_INDEX_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <chrono>
+#include <time.h>
+
+// File names of the media folders (<rom folder>/images, <rom folder>/videos) used to find local art without a stat
+// per candidate. A folder is listed on first use, and listed again when its last write time changes or was too
+// recent to be trusted : the time is checked at most once per second, so a missing media costs a hash lookup.
+class LocalArtIndex
+{
+public:
+	static bool exists(const std::string& folder, const std::string& fileName);
+
+private:
+	struct MediaFolder
+	{
+		MediaFolder() : checked(false), trusted(false), lastWriteTime(0), checkCount(0), storedCheck(0) { }
+
+		bool   checked;
+		bool   trusted;	// The listing can't miss a change made during the same second
+		time_t lastWriteTime;
+		unsigned int checkCount;	// Checks started
+		unsigned int storedCheck;	// Check whose listing is stored : listings finishing out of order never replace a newer one
+		std::chrono::steady_clock::time_point lastCheck;
+		std::unordered_set<std::string> files;
+	};
+
+	static std::mutex mLock;
+	static std::unordered_map<std::string, MediaFolder> mFolders;
+};
+
+#endif // ES_APP_LOCAL_ART_INDEX_H
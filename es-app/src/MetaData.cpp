@@ -10,6 +10,13 @@
 #include "FileData.h"
 #include "ImageIO.h"
 
+#include <mutex>
+#include <unordered_set>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 std::vector<MetaDataDecl> MetaDataList::mMetaDataDecls;
 
 static std::map<MetaDataId, int> mMetaDataIndexes;
@@ -142,9 +149,374 @@ MetaDataId MetaDataList::getId(const std::string& key) const
 	return mGameIdMap[key];
 }
 
-MetaDataList::MetaDataList(MetaDataListType type) : mType(type), mWasChanged(false), mRelativeTo(nullptr)
+std::atomic<unsigned int> MetaDataList::sVersion(0);
+
+// Shared strings are never released : the pool only grows with distinct developers, genres...
+static std::mutex mSharedStringsLock;
+static std::unordered_set<std::string> mSharedStrings;
+
+static const std::string* getSharedString(const std::string& value)
+{
+	std::unique_lock<std::mutex> lock(mSharedStringsLock);
+	return &(*mSharedStrings.insert(value).first);
+}
+
+size_t MetaDataList::getSharedStringsMemoryUsage()
+{
+	std::unique_lock<std::mutex> lock(mSharedStringsLock);
+
+	size_t bytes = mSharedStrings.bucket_count() * sizeof(void*);
+	for (auto& value : mSharedStrings)
+		bytes += sizeof(std::string) + 2 * sizeof(void*) + (value.capacity() > 15 ? value.capacity() + 1 : 0);
+
+	return bytes;
+}
+
+static bool isSharedValue(MetaDataId id)
+{
+	switch (id)
+	{
+	case MetaDataId::Emulator:
+	case MetaDataId::Core:
+	case MetaDataId::Developer:
+	case MetaDataId::Publisher:
+	case MetaDataId::Genre:
+	case MetaDataId::GenreIds:
+	case MetaDataId::Family:
+	case MetaDataId::ArcadeSystemName:
+	case MetaDataId::Players:
+	case MetaDataId::Language:
+	case MetaDataId::Region:
+		return true;
+
+	default:
+		break;
+	}
+
+	return false;
+}
+
+static inline int countBits(unsigned long long value)
+{
+#if defined(_MSC_VER)
+	return (int)__popcnt64(value);
+#else
+	return __builtin_popcountll(value);
+#endif
+}
+
+// ISO dates (YYYYMMDDTHHMMSS) are stored as the YYYYMMDDHHMMSS number
+static bool parseIsoDate(const std::string& value, long long& date)
 {
+	if (value.size() != 15 || value[8] != 'T')
+		return false;
+
+	date = 0;
+
+	for (int i = 0; i < 15; i++)
+	{
+		if (i == 8)
+			continue;
+
+		if (value[i] < '0' || value[i] > '9')
+			return false;
 
+		date = date * 10 + (value[i] - '0');
+	}
+
+	return true;
+}
+
+static std::string formatShortReal(float value)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%g", value);
+	return buffer;
+}
+
+MetaDataList::Value::Value(MetaDataId valueId, const std::string& value) : id((unsigned char)valueId), kind(TEXT), text(nullptr)
+{
+	if (value.empty())
+		return;
+
+	switch (mGameTypeMap[valueId])
+	{
+	case MD_BOOL:
+		if (value == "true" || value == "false")
+		{
+			kind = BOOLEAN;
+			boolean = (value == "true");
+			return;
+		}
+		break;
+
+	case MD_INT:
+		{
+			long long number = atoll(value.c_str());
+			if (std::to_string(number) == value)
+			{
+				kind = INTEGER;
+				integer = number;
+				return;
+			}
+		}
+		break;
+
+	case MD_RATING:
+		{
+			// Ratings are written "0.600000" by ES and "0.6" by scrapers : both forms convert back exactly
+			char* end = nullptr;
+			float number = strtof(value.c_str(), &end);
+			if (end == value.c_str() || *end != 0)
+				break;
+
+			if (std::to_string(number) == value)
+			{
+				kind = REAL;
+				real = number;
+				return;
+			}
+
+			if (formatShortReal(number) == value)
+			{
+				kind = SHORT_REAL;
+				real = number;
+				return;
+			}
+		}
+		break;
+
+	case MD_DATE:
+	case MD_TIME:
+		if (parseIsoDate(value, integer))
+		{
+			kind = DATE;
+			return;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	if (isSharedValue(valueId))
+	{
+		kind = SHARED_TEXT;
+		sharedText = getSharedString(value);
+		return;
+	}
+
+	text = new char[value.size() + 1];
+	memcpy(text, value.c_str(), value.size() + 1);
+}
+
+MetaDataList::Value::Value(const Value& src) : id(src.id), kind(src.kind), integer(src.integer)
+{
+	if (kind == TEXT && src.text != nullptr)
+	{
+		size_t length = strlen(src.text) + 1;
+		text = new char[length];
+		memcpy(text, src.text, length);
+	}
+}
+
+MetaDataList::Value::Value(Value&& src) noexcept : id(src.id), kind(src.kind), integer(src.integer)
+{
+	if (src.kind == TEXT)
+		src.text = nullptr;
+}
+
+MetaDataList::Value::~Value()
+{
+	if (kind == TEXT && text != nullptr)
+		delete[] text;
+}
+
+MetaDataList::Value& MetaDataList::Value::operator=(const Value& src)
+{
+	if (this != &src)
+	{
+		Value copy(src);
+		*this = std::move(copy);
+	}
+
+	return *this;
+}
+
+MetaDataList::Value& MetaDataList::Value::operator=(Value&& src) noexcept
+{
+	if (this != &src)
+	{
+		if (kind == TEXT && text != nullptr)
+			delete[] text;
+
+		id = src.id;
+		kind = src.kind;
+		integer = src.integer;
+
+		if (src.kind == TEXT)
+			src.text = nullptr;
+	}
+
+	return *this;
+}
+
+std::string MetaDataList::Value::toString() const
+{
+	switch (kind)
+	{
+	case SHARED_TEXT:
+		return *sharedText;
+
+	case INTEGER:
+		return std::to_string(integer);
+
+	case REAL:
+		return std::to_string(real);
+
+	case SHORT_REAL:
+		return formatShortReal(real);
+
+	case BOOLEAN:
+		return boolean ? "true" : "false";
+
+	case DATE:
+		{
+			char buffer[32];
+			snprintf(buffer, sizeof(buffer), "%08lldT%06lld", integer / 1000000LL, integer % 1000000LL);
+			return buffer;
+		}
+	}
+
+	return text == nullptr ? "" : text;
+}
+
+bool MetaDataList::Value::equals(const std::string& value) const
+{
+	if (kind == TEXT)
+		return text == nullptr ? value.empty() : value == text;
+
+	if (kind == SHARED_TEXT)
+		return value == *sharedText;
+
+	return toString() == value;
+}
+
+bool MetaDataList::Value::isEmpty() const
+{
+	return kind == TEXT && (text == nullptr || text[0] == 0);
+}
+
+MetaDataList::MetaDataList(MetaDataListType type) : mType(type), mSlots(0), mWasChanged(false), mVersion(0), mRelativeTo(nullptr), mOwner(nullptr)
+{
+
+}
+
+MetaDataList::MetaDataList(const MetaDataList& src) : 
+	mScrapeDates(src.mScrapeDates), mName(src.mName), mType(src.mType), mSlots(src.mSlots), mValues(src.mValues), 
+	mWasChanged(src.mWasChanged), mVersion(src.mVersion), mRelativeTo(src.mRelativeTo), mOwner(nullptr), mUnKnownElements(src.mUnKnownElements)
+{
+
+}
+
+MetaDataList& MetaDataList::operator=(const MetaDataList& src)
+{
+	if (this == &src)
+		return *this;
+
+	bool wasChanged = mWasChanged;
+
+	mScrapeDates = src.mScrapeDates;
+	mName = src.mName;
+	mType = src.mType;
+	mSlots = src.mSlots;
+	mValues = src.mValues;
+	mWasChanged = src.mWasChanged;
+	mVersion = src.mVersion;
+	mRelativeTo = src.mRelativeTo;
+	mUnKnownElements = src.mUnKnownElements;
+
+	// Keep the owner, and its dirty state in sync
+	if (mOwner != nullptr && mOwner->getSystem() != nullptr && wasChanged != mWasChanged)
+	{
+		if (mWasChanged)
+			mOwner->getSystem()->addDirtyFile(mOwner);
+		else
+			mOwner->getSystem()->removeDirtyFile(mOwner);
+	}
+
+	return *this;
+}
+
+void MetaDataList::setOwner(FileData* file)
+{
+	if (mOwner == file)
+		return;
+
+	if (mWasChanged && mOwner != nullptr && mOwner->getSystem() != nullptr)
+		mOwner->getSystem()->removeDirtyFile(mOwner);
+
+	mOwner = file;
+
+	if (mWasChanged && mOwner != nullptr && mOwner->getSystem() != nullptr)
+		mOwner->getSystem()->addDirtyFile(mOwner);
+}
+
+void MetaDataList::setChanged()
+{
+	if (!mWasChanged && mOwner != nullptr && mOwner->getSystem() != nullptr)
+		mOwner->getSystem()->addDirtyFile(mOwner);
+
+	mWasChanged = true;
+}
+
+void MetaDataList::setDirty()
+{
+	setChanged();
+	mVersion = ++sVersion;
+}
+
+const MetaDataList::Value* MetaDataList::findValue(MetaDataId id) const
+{
+	unsigned long long bit = 1ULL << id;
+	if ((mSlots & bit) == 0)
+		return nullptr;
+
+	return &mValues[countBits(mSlots & (bit - 1))];
+}
+
+void MetaDataList::setValue(MetaDataId id, const std::string& value)
+{
+	unsigned long long bit = 1ULL << id;
+	int index = countBits(mSlots & (bit - 1));
+
+	if (mSlots & bit)
+		mValues[index] = Value(id, value);
+	else
+	{
+		mValues.insert(mValues.begin() + index, Value(id, value));
+		mSlots |= bit;
+	}
+}
+
+void MetaDataList::addMemoryUsage(MemoryUsage& usage) const
+{
+	static const size_t mapNodeSize = 4 * sizeof(void*) + sizeof(std::pair<const MetaDataId, std::string>);
+
+	usage.lists++;
+	usage.values += mValues.size();
+
+	usage.bytes += sizeof(MetaDataList) + mValues.capacity() * sizeof(Value);
+	usage.mapBytes += sizeof(MetaDataList) - sizeof(mSlots) - sizeof(mValues) + sizeof(std::map<MetaDataId, std::string>);
+
+	for (auto& value : mValues)
+	{
+		if (value.kind == Value::TEXT && value.text != nullptr)
+			usage.bytes += strlen(value.text) + 1;
+
+		size_t length = value.toString().size();
+		usage.mapBytes += mapNodeSize + (length > 15 ? length + 1 : 0);
+	}
 }
 
 void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, SystemData* system)
@@ -263,6 +635,8 @@ void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, Syst
 		else
 			set(mdd.id, value);
 	}
+
+	mVersion = ++sVersion;
 }
 
 // Add migration for alternative formats & old tags
@@ -292,16 +666,16 @@ void MetaDataList::appendToXML(pugi::xml_node& parent, bool ignoreDefaults, cons
 		if (mddIter->id == MetaDataId::GenreIds)
 			continue;
 
-		auto mapIter = mMap.find(mddIter->id);
-		if(mapIter != mMap.cend())
+		const Value* storedValue = findValue(mddIter->id);
+		if (storedValue != nullptr)
 		{
 			// we have this value!
 			// if it's just the default (and we ignore defaults), don't write it
-			if (ignoreDefaults && mapIter->second == mddIter->defaultValue)
+			if (ignoreDefaults && storedValue->equals(mddIter->defaultValue))
 				continue;
 
 			// try and make paths relative if we can
-			std::string value = mapIter->second;
+			std::string value = storedValue->toString();
 			if (mddIter->type == MD_PATH)
 			{
 				if (fullPaths && mRelativeTo != nullptr)
@@ -359,7 +733,8 @@ void MetaDataList::set(MetaDataId id, const std::string& value)
 			return;
 
 		mName = value;
-		mWasChanged = true;
+		setChanged();
+		mVersion = ++sVersion;
 		return;
 	}
 
@@ -370,16 +745,17 @@ void MetaDataList::set(MetaDataId id, const std::string& value)
 	// 	return;
 	// }
 
-	auto prev = mMap.find(id);
-	if (prev != mMap.cend() && prev->second == value)
+	auto prev = findValue(id);
+	if (prev != nullptr && prev->equals(value))
 		return;
 
 	if (mGameTypeMap[id] == MD_PATH && mRelativeTo != nullptr) // if it's a path, resolve relative paths				
-		mMap[id] = Utils::FileSystem::createRelativePath(value, mRelativeTo->getStartPath(), true);
+		setValue(id, Utils::FileSystem::createRelativePath(value, mRelativeTo->getStartPath(), true));
 	else
-		mMap[id] = Utils::String::trim(value);
+		setValue(id, Utils::String::trim(value));
 
-	mWasChanged = true;
+	setChanged();
+	mVersion = ++sVersion;
 }
 
 const std::string MetaDataList::get(MetaDataId id, bool resolveRelativePaths) const
@@ -387,13 +763,13 @@ const std::string MetaDataList::get(MetaDataId id, bool resolveRelativePaths) co
 	if (id == MetaDataId::Name)
 		return mName;
 
-	auto it = mMap.find(id);
-	if (it != mMap.end())
+	auto value = findValue(id);
+	if (value != nullptr)
 	{
 		if (resolveRelativePaths && mGameTypeMap[id] == MD_PATH && mRelativeTo != nullptr) // if it's a path, resolve relative paths				
-			return Utils::FileSystem::resolveRelativePath(it->second, mRelativeTo->getStartPath(), true);
+			return Utils::FileSystem::resolveRelativePath(value->toString(), mRelativeTo->getStartPath(), true);
 
-		return it->second;
+		return value->toString();
 	}
 
 	return mDefaultGameMap[id];
@@ -422,14 +798,46 @@ const std::string MetaDataList::get(const std::string& key, bool resolveRelative
 
 int MetaDataList::getInt(MetaDataId id) const
 {
+	auto value = findValue(id);
+	if (value != nullptr && value->kind == Value::INTEGER)
+		return (int)value->integer;
+
 	return atoi(get(id).c_str());
 }
 
 float MetaDataList::getFloat(MetaDataId id) const
 {
+	auto value = findValue(id);
+	if (value != nullptr && (value->kind == Value::REAL || value->kind == Value::SHORT_REAL))
+		return value->real;
+
 	return Utils::String::toFloat(get(id));
 }
 
+bool MetaDataList::getBool(MetaDataId id) const
+{
+	auto value = findValue(id);
+	if (value == nullptr)
+		return mDefaultGameMap[id] == "true";
+
+	if (value->kind == Value::BOOLEAN)
+		return value->boolean;
+
+	return value->equals("true");
+}
+
+bool MetaDataList::isEmpty(MetaDataId id) const
+{
+	if (id == MetaDataId::Name)
+		return mName.empty();
+
+	auto value = findValue(id);
+	if (value == nullptr)
+		return mDefaultGameMap[id].empty();
+
+	return value->isEmpty();
+}
+
 bool MetaDataList::wasChanged() const
 {
 	return mWasChanged;
@@ -437,6 +845,9 @@ bool MetaDataList::wasChanged() const
 
 void MetaDataList::resetChangedFlag()
 {
+	if (mWasChanged && mOwner != nullptr && mOwner->getSystem() != nullptr)
+		mOwner->getSystem()->removeDirtyFile(mOwner);
+
 	mWasChanged = false;
 }
 
@@ -563,7 +974,7 @@ void MetaDataList::setScrapeDate(const std::string& scraper)
 		return;
 
 	mScrapeDates[it->second] = Utils::Time::DateTime::now();
-	mWasChanged = true;
+	setChanged();
 }
 
 Utils::Time::DateTime* MetaDataList::getScrapeDate(const std::string& scraper)
@@ -5,6 +5,7 @@
 #include <map>
 #include <vector>
 #include <functional>
+#include <atomic>
 #include <string>
 
 #include "utils/TimeUtil.h"
@@ -131,6 +132,8 @@ enum MetaDataListType
 
 class MetaDataList
 {
+	friend class GamelistSnapshot;
+
 public:
 	static void initMetadata();
 
@@ -140,6 +143,8 @@ public:
 	void migrate(FileData* file, pugi::xml_node& node);
 
 	MetaDataList(MetaDataListType type);
+	MetaDataList(const MetaDataList& src);
+	MetaDataList& operator=(const MetaDataList& src);
 	
 	void set(MetaDataId id, const std::string& value);
 
@@ -150,6 +155,10 @@ public:
 
 	int getInt(MetaDataId id) const;
 	float getFloat(MetaDataId id) const;
+	bool getBool(MetaDataId id) const;
+
+	// Checks a value without building its string
+	bool isEmpty(MetaDataId id) const;
 
 	MetaDataType getType(MetaDataId id) const;
 	MetaDataType getType(const std::string name) const;
@@ -158,10 +167,17 @@ public:
 
 	bool wasChanged() const;
 	void resetChangedFlag();
-	const void setDirty() 
-	{ 
-		mWasChanged = true; 
-	}
+	void setDirty();
+
+	// The file is added to the dirty files of its system while the list has unsaved changes. Copies have no owner
+	void setOwner(FileData* file);
+
+	// Changes on every modification, so that values computed from the metadata know when they are outdated.
+	// Versions are unique across lists : a copy assigned back keeps a meaningful version
+	inline unsigned int getVersion() const { return mVersion; }
+
+	// Changes when any list is modified
+	static unsigned int getGlobalVersion() { return sVersion; }
 
 	inline MetaDataListType getType() const { return mType; }
 	static const std::vector<MetaDataDecl>& getMDD() { return mMetaDataDecls; }
@@ -176,16 +192,80 @@ public:
 	void setScrapeDate(const std::string& scraper);
 	Utils::Time::DateTime* getScrapeDate(const std::string& scraper);
 
+	struct MemoryUsage
+	{
+		MemoryUsage() : lists(0), values(0), bytes(0), mapBytes(0) { }
+
+		size_t lists;
+		size_t values;
+		size_t bytes;
+		size_t mapBytes; // What a std::map<MetaDataId, std::string> storage would use
+	};
+
+	void addMemoryUsage(MemoryUsage& usage) const;
+	static size_t getSharedStringsMemoryUsage();
+
 private:
+	// A value takes 16 bytes : numbers, booleans & ISO dates are stored typed when they convert back to the same string,
+	// repetitive strings (developer, genre...) point to a shared pool, other strings are allocated with their exact size.
+	struct Value
+	{
+		enum Kind : unsigned char
+		{
+			TEXT,
+			SHARED_TEXT,
+			INTEGER,
+			REAL,		// std::to_string form : "0.600000"
+			SHORT_REAL,	// %g form : "0.6"
+			BOOLEAN,
+			DATE
+		};
+
+		Value(MetaDataId valueId, const std::string& value);
+		Value(const Value& src);
+		Value(Value&& src) noexcept;
+		~Value();
+
+		Value& operator=(const Value& src);
+		Value& operator=(Value&& src) noexcept;
+
+		std::string toString() const;
+		bool equals(const std::string& value) const;
+		bool isEmpty() const;
+
+		unsigned char id;
+		Kind kind;
+
+		union
+		{
+			char* text;
+			const std::string* sharedText;
+			long long integer;
+			float real;
+			bool boolean;
+		};
+	};
+
+	const Value* findValue(MetaDataId id) const;
+	void setValue(MetaDataId id, const std::string& value);
+
+	void setChanged();
+
 	std::map<int, Utils::Time::DateTime> mScrapeDates;
 
 	std::string		mName;
 	MetaDataListType mType;
-	std::map<MetaDataId, std::string> mMap;
+
+	unsigned long long	mSlots; // Bit n is set when MetaDataId n has a value in mValues
+	std::vector<Value>	mValues; // Ordered by id
+
 	bool mWasChanged;
+	unsigned int	mVersion;
 	SystemData*		mRelativeTo;
+	FileData*		mOwner;
 
 	static std::vector<MetaDataDecl> mMetaDataDecls;
+	static std::atomic<unsigned int> sVersion;
 
 	std::vector<std::tuple<std::string, std::string, bool>> mUnKnownElements;
 };
@@ -3,10 +3,13 @@
 #include "SystemConf.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/ThreadPool.h"
+#include "utils/DirectoryIndex.h"
 #include "CollectionSystemManager.h"
 #include "FileFilterIndex.h"
 #include "FileSorts.h"
 #include "Gamelist.h"
+#include "GamelistSnapshot.h"
+#include "GamelistJournal.h"
 #include "Log.h"
 #include "utils/Platform.h"
 #include "Settings.h"
@@ -69,6 +72,7 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 	mIsCheevosSupported = -1;
 	mIsGroupSystem = groupedSystem;
 	mGameListHash = 0;
+	mTreeVersion = 0;
 	mGameCountInfo = nullptr;
 	mSortId = Settings::getInstance()->getInt(getName() + ".sort");
 	mGridSizeOverride = Vector2f(0, 0);
@@ -92,25 +96,40 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 		std::unordered_map<std::string, FileData*> fileMap;
 		fileMap[mEnvData->mStartPath] = mRootFolder;
 
-		if (!Settings::ParseGamelistOnly())
+		bool useSnapshot = GamelistSnapshot::isEnabled(this) && (!mHidden || Settings::HiddenSystemsShowGames());
+
+		if (useSnapshot && GamelistSnapshot::load(this, fileMap))
 		{
-			populateFolder(mRootFolder, fileMap);
+			// The snapshot already contains gamelist.xml datas, only pending changes are missing
+			parseGamelistRecovery(this, fileMap);
+		}
+		else
+		{
+			std::vector<SnapshotFolder> scannedFolders;
 
-			if (!UIModeController::LoadEmptySystems())
+			if (!Settings::ParseGamelistOnly())
 			{
-				if (mRootFolder->getChildren().size() == 0)
-					return;
+				populateFolder(mRootFolder, fileMap, useSnapshot ? &scannedFolders : nullptr);
 
-				if (mHidden && !Settings::HiddenSystemsShowGames())
-					return;
+				if (!UIModeController::LoadEmptySystems())
+				{
+					if (mRootFolder->getChildren().size() == 0)
+						return;
+
+					if (mHidden && !Settings::HiddenSystemsShowGames())
+						return;
+				}
 			}
-		}
 
-		if (!Settings::IgnoreGamelist())
-			parseGamelist(this, fileMap);		
-		
-		if (Settings::RemoveMultiDiskContent())
-			removeMultiDiskContent(fileMap);
+			if (!Settings::IgnoreGamelist())
+				parseGamelist(this, fileMap);
+
+			if (Settings::RemoveMultiDiskContent())
+				removeMultiDiskContent(fileMap);
+
+			if (useSnapshot && mRootFolder->getChildren().size() > 0)
+				GamelistSnapshot::save(this, scannedFolders);
+		}
 	}
 	else
 	{
@@ -138,6 +157,19 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 
 SystemData::~SystemData()
 {
+	GamelistJournal::detach(this);
+
+	// Files of other systems may still point to this one
+	std::unordered_set<FileData*> dirtyFiles;
+
+	{
+		std::unique_lock<std::mutex> lock(mDirtyFilesLock);
+		dirtyFiles.swap(mDirtyFiles);
+	}
+
+	for (auto file : dirtyFiles)
+		file->mMetadata.setOwner(nullptr);
+
 	if (mBindableRandom)
 		delete mBindableRandom;
 
@@ -224,12 +256,140 @@ void SystemData::setIsGameSystemStatus()
 	mIsGameSystem = (mMetadata.name != "retropie" && mMetadata.name != "retrobat");
 }
 
-void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap)
+// Result of the enumeration of a folder, and of the sub folders that may contain games
+struct FolderScan
+{
+	FolderScan(const std::string& _path) : path(_path), lastWriteTime(0) { }
+
+	std::string path;
+	time_t lastWriteTime;
+	Utils::FileSystem::fileList files;
+	std::unordered_map<std::string, std::unique_ptr<FolderScan>> subFolders;
+};
+
+static Utils::FileSystem::fileList listFolder(const std::string& folderPath)
+{
+	if (Settings::GamelistSnapshots())
+		return Utils::DirectoryIndex::getDirectoryFiles(folderPath);
+
+	return Utils::FileSystem::getDirectoryFiles(folderPath);
+}
+
+static Utils::ThreadPool* getFolderScanPool()
+{
+	// Folder scans mostly wait for IOs : one thread per core is enough
+	static Utils::ThreadPool pool(1);
+	return &pool;
+}
+
+bool SystemData::isScannedFolder(const std::string& filePath, bool preloadMedias)
+{
+	std::string fn = Utils::String::toLower(Utils::FileSystem::getFileName(filePath));
+
+	// Never look in "artwork", reserved for mame roms artwork
+	if (fn == "artwork")
+		return false;
+
+	if (preloadMedias && (!mHidden || Settings::HiddenSystemsShowGames()))
+	{
+		// Recurse list files in medias folder, just to let OS build filesystem cache 
+		if (fn == "media" || fn == "medias")
+		{
+			Utils::FileSystem::getDirContent(filePath, true);
+			return false;
+		}
+
+		// List files in folder, just to get OS build filesystem cache 
+		if (fn == "manuals" || fn == "images" || fn == "videos" || Utils::String::startsWith(fn, "downloaded_"))
+		{
+			Utils::FileSystem::getDirectoryFiles(filePath);
+			return false;
+		}
+	}
+
+	// Don't loose time looking in downloaded_images, downloaded_videos & media folders
+	if (fn == "media" || fn == "medias" || fn == "images" || fn == "manuals" || fn == "videos" || fn == "assets" || Utils::String::startsWith(fn, "downloaded_") || Utils::String::startsWith(fn, "."))
+		return false;
+
+	// Hardcoded optimisation : WiiU has so many files in content & meta directories
+	if (mMetadata.name == "wiiu" && (fn == "content" || fn == "meta"))
+		return false;
+
+	// Hardcoded optimisation : vpinball 'roms' subfolder must be excluded
+	if (mMetadata.name == "vpinball" && fn == "roms")
+		return false;
+
+	return true;
+}
+
+bool SystemData::getShowHiddenFiles()
+{
+	bool showHidden = Settings::ShowHiddenFiles();
+
+	auto shv = Settings::getInstance()->getString(getName() + ".ShowHiddenFiles");
+	if (shv == "1") showHidden = true;
+	else if (shv == "0") showHidden = false;
+
+	return showHidden;
+}
+
+void SystemData::scanFolder(FolderScan* scan, Utils::TaskGroup* group, bool showHidden, bool recordTimes)
+{
+	// Remember the folder date before listing it, so that a snapshot never misses a file added during the scan
+	if (recordTimes)
+		scan->lastWriteTime = Utils::FileSystem::getLastWriteTime(scan->path);
+
+	scan->files = listFolder(scan->path);
+
+	bool preloadMedias = Settings::PreloadMedias();
+
+	for (auto& fileInfo : scan->files)
+	{
+		if (!fileInfo.directory || (!showHidden && fileInfo.hidden))
+			continue;
+
+		// Folders matching an extension are games, unless they are arcade assets : they're scanned later if needed
+		if (mEnvData->isValidExtension(Utils::String::toLower(Utils::FileSystem::getExtension(fileInfo.path))))
+			continue;
+
+		if (!isScannedFolder(fileInfo.path, preloadMedias))
+			continue;
+
+		FolderScan* subFolder = new FolderScan(fileInfo.path);
+		scan->subFolders[fileInfo.path] = std::unique_ptr<FolderScan>(subFolder);
+
+		group->run([this, subFolder, group, showHidden, recordTimes] { scanFolder(subFolder, group, showHidden, recordTimes); });
+	}
+}
+
+void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap, std::vector<SnapshotFolder>* scannedFolders, FolderScan* scan)
 {
 	const std::string& folderPath = folder->getPath();
 
-	if(!Utils::FileSystem::isDirectory(folderPath))
-		return;
+	bool showHidden = getShowHiddenFiles();
+
+	if (scan == nullptr)
+	{
+		if (!Utils::FileSystem::isDirectory(folderPath))
+			return;
+
+		// Enumerate the whole tree in parallel first, then build it exactly as a sequential scan would
+		if (Settings::ThreadedLoading() && std::thread::hardware_concurrency() > 1)
+		{
+			FolderScan root(folderPath);
+
+			Utils::TaskGroup group(getFolderScanPool());
+			scanFolder(&root, &group, showHidden, scannedFolders != nullptr);
+			group.wait();
+
+			populateFolder(folder, fileMap, scannedFolders, &root);
+			return;
+		}
+	}
+
+	// Remember the folder date before listing it, so that a snapshot never misses a file added during the scan
+	if (scannedFolders != nullptr)
+		scannedFolders->push_back(SnapshotFolder(folderPath, scan != nullptr ? scan->lastWriteTime : Utils::FileSystem::getLastWriteTime(folderPath)));
 	/*
 	// [Obsolete] make sure that this isn't a symlink to a thing we already have
 	// Deactivated because it's slow & useless : users should to be carefull not to make recursive simlinks
@@ -246,14 +406,15 @@ void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::stri
 	std::string filePath;
 	std::string extension;
 	bool isGame;
-	bool showHidden = Settings::ShowHiddenFiles();
-	bool preloadMedias = Settings::PreloadMedias();
 
-	auto shv = Settings::getInstance()->getString(getName() + ".ShowHiddenFiles");
-	if (shv == "1") showHidden = true;
-	else if (shv == "0") showHidden = false;
+	// Medias were already preloaded by the scan tasks
+	bool preloadMedias = (scan == nullptr && Settings::PreloadMedias());
+
+	Utils::FileSystem::fileList listed;
+	if (scan == nullptr)
+		listed = listFolder(folderPath);
 
-	Utils::FileSystem::fileList dirContent = Utils::FileSystem::getDirectoryFiles(folderPath);
+	const Utils::FileSystem::fileList& dirContent = (scan != nullptr ? scan->files : listed);
 	for (auto fileInfo : dirContent)
 	{
 		filePath = fileInfo.path;
@@ -286,43 +447,22 @@ void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::stri
 		//add directories that also do not match an extension as folders
 		if(!isGame && fileInfo.directory)
 		{
-			std::string fn = Utils::String::toLower(Utils::FileSystem::getFileName(filePath));
+			FolderScan* subFolderScan = nullptr;
 
-			// Never look in "artwork", reserved for mame roms artwork
-			if (fn == "artwork")
-				continue;
-
-			if (preloadMedias && (!mHidden || Settings::HiddenSystemsShowGames()))
+			if (scan != nullptr)
 			{
-				// Recurse list files in medias folder, just to let OS build filesystem cache 
-				if (fn == "media" || fn == "medias")
-				{
-					Utils::FileSystem::getDirContent(filePath, true);
-					continue;
-				}
-
-				// List files in folder, just to get OS build filesystem cache 
-				if (fn == "manuals" || fn == "images" || fn == "videos" || Utils::String::startsWith(fn, "downloaded_"))
-				{
-					Utils::FileSystem::getDirectoryFiles(filePath);
-					continue;
-				}
+				auto it = scan->subFolders.find(filePath);
+				if (it != scan->subFolders.cend())
+					subFolderScan = it->second.get();
+				else if (!mEnvData->isValidExtension(extension))
+					continue; // Excluded by the scan
 			}
 
-			// Don't loose time looking in downloaded_images, downloaded_videos & media folders
-			if (fn == "media" || fn == "medias" || fn == "images" || fn == "manuals" || fn == "videos" || fn == "assets" || Utils::String::startsWith(fn, "downloaded_") || Utils::String::startsWith(fn, "."))
-				continue;
-			
-			// Hardcoded optimisation : WiiU has so many files in content & meta directories
-			if (mMetadata.name == "wiiu" && (fn == "content" || fn == "meta"))
+			if (subFolderScan == nullptr && !isScannedFolder(filePath, preloadMedias))
 				continue;
 
-			// Hardcoded optimisation : vpinball 'roms' subfolder must be excluded
-			if (mMetadata.name == "vpinball" && fn == "roms")
-				continue;			
-
 			FolderData* newFolder = new FolderData(filePath, this);
-			populateFolder(newFolder, fileMap);
+			populateFolder(newFolder, fileMap, scannedFolders, subFolderScan);
 
 			//ignore folders that do not contain games
 			if(newFolder->getChildren().size() == 0)
@@ -773,6 +913,25 @@ void SystemData::loadAdditionnalConfig(pugi::xml_node& srcSystems)
 	}
 }
 
+static void logMetadataMemoryUsage()
+{
+	MetaDataList::MemoryUsage usage;
+
+	for (auto system : SystemData::sSystemVector)
+	{
+		if (system->isCollection() || system->isGroupSystem())
+			continue;
+
+		system->getRootFolder()->getMetadata().addMemoryUsage(usage);
+
+		for (auto file : system->getRootFolder()->getFilesRecursive(GAME | FOLDER, false, nullptr, false))
+			file->getMetadata().addMemoryUsage(usage);
+	}
+
+	LOG(LogInfo) << "Metadata : " << usage.lists << " entries, " << usage.values << " values, " << (usage.bytes / 1024) << " KB + " << 
+		(MetaDataList::getSharedStringsMemoryUsage() / 1024) << " KB of shared strings (std::map storage : " << (usage.mapBytes / 1024) << " KB)";
+}
+
 //creates systems from information located in a config file
 bool SystemData::loadConfig(Window* window)
 {
@@ -912,6 +1071,12 @@ bool SystemData::loadConfig(Window* window)
 		CollectionSystemManager::get()->loadCollectionSystems();
 	}
 
+	if (Log::getReportingLevel() >= LogInfo)
+		logMetadataMemoryUsage();
+
+	if (Settings::GamelistSnapshots())
+		Utils::DirectoryIndex::save();
+
 	if (SystemData::sSystemVector.size() > 0)
 	{
 		createGroupedSystems();
@@ -1179,6 +1344,30 @@ SystemData* SystemData::loadSystem(pugi::xml_node system, bool fullMode)
 	return newSys;
 }
 
+void SystemData::addDirtyFile(FileData* file)
+{
+	std::unique_lock<std::mutex> lock(mDirtyFilesLock);
+	mDirtyFiles.insert(file);
+}
+
+void SystemData::removeDirtyFile(FileData* file)
+{
+	std::unique_lock<std::mutex> lock(mDirtyFilesLock);
+	mDirtyFiles.erase(file);
+}
+
+std::vector<FileData*> SystemData::getDirtyFiles()
+{
+	std::unique_lock<std::mutex> lock(mDirtyFilesLock);
+	return std::vector<FileData*>(mDirtyFiles.cbegin(), mDirtyFiles.cend());
+}
+
+bool SystemData::hasDirtyFiles()
+{
+	std::unique_lock<std::mutex> lock(mDirtyFilesLock);
+	return !mDirtyFiles.empty();
+}
+
 bool SystemData::hasDirtySystems()
 {
 	bool saveOnExit = !Settings::IgnoreGamelist() && Settings::SaveGamelistsOnExit();
@@ -12,6 +12,8 @@
 #include <pugixml/src/pugixml.hpp>
 #include <unordered_map>
 #include <unordered_set>
+#include <mutex>
+#include <atomic>
 #include "FileFilterIndex.h"
 #include "KeyboardMapping.h"
 #include "math/Vector2f.h"
@@ -24,6 +26,13 @@ class FolderData;
 class ThemeData;
 class Window;
 class SaveStateRepository;
+struct SnapshotFolder;
+struct FolderScan;
+
+namespace Utils
+{
+	class TaskGroup;
+}
 
 struct GameCountInfo
 {
@@ -177,6 +186,16 @@ public:
 	void setGamelistHash(size_t size) { mGameListHash = size; }
 	size_t getGamelistHash() { return mGameListHash; }
 
+	// Changes each time a child is added to or removed from one of the folders of the system, set by FolderData
+	unsigned int getTreeVersion() { return mTreeVersion; }
+	void setTreeVersion(unsigned int version) { mTreeVersion = version; }
+
+	// Files whose metadata changed since gamelist.xml was written, maintained by MetaDataList
+	void addDirtyFile(FileData* file);
+	void removeDirtyFile(FileData* file);
+	std::vector<FileData*> getDirtyFiles();
+	bool hasDirtyFiles();
+
 	bool isNetplaySupported();
 	bool isCheevosSupported();
 
@@ -235,7 +254,11 @@ private:
 	std::string getKeyboardMappingFilePath();
 	static void createGroupedSystems();
 
-	size_t mGameListHash;
+	std::atomic<size_t> mGameListHash; // Also set by the journal thread when it compacts
+	std::atomic<unsigned int> mTreeVersion;
+
+	std::mutex mDirtyFilesLock;
+	std::unordered_set<FileData*> mDirtyFiles;
 
 	bool mIsCollectionSystem;
 	bool mIsGameSystem;
@@ -248,7 +271,10 @@ private:
 	SystemEnvironmentData* mEnvData;
 	std::shared_ptr<ThemeData> mTheme;
 
-	void populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap);
+	void populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap, std::vector<SnapshotFolder>* scannedFolders = nullptr, FolderScan* scan = nullptr);
+	void scanFolder(FolderScan* scan, Utils::TaskGroup* group, bool showHidden, bool recordTimes);
+	bool isScannedFolder(const std::string& filePath, bool preloadMedias);
+	bool getShowHiddenFiles();
 	void indexAllGameFilters(const FolderData* folder);
 	void setIsGameSystemStatus();
 	void removeMultiDiskContent(std::unordered_map<std::string, FileData*>& fileMap);
@@ -0,0 +1,464 @@
+#include "TextSearchIndex.h"
+
+#include "utils/StringUtil.h"
+#include "FileData.h"
+
+#include <algorithm>
+
+#define COMPACT_MIN_REMOVED	64
+
+static float jw_distance(std::string s1, std::string s2, bool caseSensitive = true) {
+	float m = 0;
+	int low, high, range;
+	int k = 0, numTrans = 0;
+
+	// Exit early if either are empty
+	if (s1.length() == 0 || s2.length() == 0) {
+		return 0;
+	}
+
+	// Convert to lower if case-sensitive is false
+	if (caseSensitive == false) {
+		transform(s1.begin(), s1.end(), s1.begin(), ::tolower);
+		transform(s2.begin(), s2.end(), s2.begin(), ::tolower);
+	}
+
+	// Exit early if they're an exact match.
+	if (s1 == s2) {
+		return 1;
+	}
+
+	range = (std::max(s1.length(), s2.length()) / 2) - 1;
+	int s1Matches[65000] = {};
+	int s2Matches[65000] = {};
+
+	for (int i = 0; i < s1.length(); i++) {
+
+		// Low Value;
+		if (i >= range) {
+			low = i - range;
+		}
+		else {
+			low = 0;
+		}
+
+		// High Value;
+		if (i + range <= (s2.length() - 1)) {
+			high = i + range;
+		}
+		else {
+			high = s2.length() - 1;
+		}
+
+		for (int j = low; j <= high; j++) {
+			if (s1Matches[i] != 1 && s2Matches[j] != 1 && s1[i] == s2[j]) {
+				m += 1;
+				s1Matches[i] = 1;
+				s2Matches[j] = 1;
+				break;
+			}
+		}
+	}
+
+	// Exit early if no matches were found
+	if (m == 0) {
+		return 0;
+	}
+
+	// Count the transpositions.
+	for (int i = 0; i < s1.length(); i++) {
+		if (s1Matches[i] == 1) {
+			int j;
+			for (j = k; j < s2.length(); j++) {
+				if (s2Matches[j] == 1) {
+					k = j + 1;
+					break;
+				}
+			}
+
+			if (s1[i] != s2[j]) {
+				numTrans += 1;
+			}
+		}
+	}
+
+	float weight = (m / s1.length() + m / s2.length() + (m - (numTrans / 2)) / m) / 3;
+	float l = 0;
+	float p = 0.1;
+	if (weight > 0.7) {
+		while (s1[l] == s2[l] && l < 4) {
+			l += 1;
+		}
+
+		weight += l * p * (1 - weight);
+	}
+	return weight;
+}
+
+// Same folding as Utils::String::containsIgnoreCase : only ASCII letters are case insensitive
+std::string TextSearchIndex::foldCase(const std::string& text)
+{
+	std::string ret = text;
+	for (auto& c : ret)
+		if (c >= 'A' && c <= 'Z')
+			c += 0x20;
+
+	return ret;
+}
+
+std::vector<std::string> TextSearchIndex::simplify(const std::string& text)
+{
+	auto s = Utils::String::toLower(text);
+	s = Utils::String::replace(s, ":", "");
+	s = Utils::String::replace(s, ".", "");
+	s = Utils::String::replace(s, " - ", " ");
+	s = Utils::String::replace(s, "- ", " ");
+
+	std::vector<std::string> ret;
+
+	for (auto v : Utils::String::split(s, ' '))
+	{
+		if (v.empty() || v.length() <= 2 || v == "and" || v == "not" || v == "for" || v == "the" || v == "les" || v == "des")
+			continue;
+
+		ret.push_back(v);
+	}
+
+	return ret;
+}
+
+std::vector<uint32_t> TextSearchIndex::getTrigrams(const std::string& folded)
+{
+	std::vector<uint32_t> ret;
+	if (folded.length() < 3)
+		return ret;
+
+	ret.reserve(folded.length() - 2);
+
+	for (size_t i = 0; i + 2 < folded.length(); i++)
+		ret.push_back(((uint32_t)(unsigned char)folded[i] << 16) | ((uint32_t)(unsigned char)folded[i + 1] << 8) | (uint32_t)(unsigned char)folded[i + 2]);
+
+	std::sort(ret.begin(), ret.end());
+	ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+	return ret;
+}
+
+TextSearchIndex::Query TextSearchIndex::createQuery(const std::string& text, bool useRelevancy, bool pinyin)
+{
+	Query query;
+	query.text = text;
+	query.folded = foldCase(text);
+	query.useRelevancy = useRelevancy;
+	query.pinyin = pinyin && !useRelevancy;
+	query.hasSpace = (text.find(' ') != std::string::npos);
+	query.ascii = std::find_if(text.cbegin(), text.cend(), [](char c) { return (c & 0x80) != 0; }) == text.cend();
+
+	if (text.find(',') == std::string::npos)
+		query.tokens.push_back(text);
+	else
+	{
+		for (auto token : Utils::String::split(text, ',', true))
+			query.tokens.push_back(Utils::String::trim(token));
+	}
+
+	for (auto& token : query.tokens)
+		query.foldedTokens.push_back(foldCase(token));
+
+	if (useRelevancy && query.hasSpace)
+		query.words = simplify(text);
+
+	return query;
+}
+
+void TextSearchIndex::createEntry(FileData* game, Entry& entry)
+{
+	FileData* source = game->getSourceFileData();
+
+	entry.game = game;
+	entry.version = source->getMetadata().getVersion();
+	entry.name = source->getName();
+	entry.folded = foldCase(entry.name);
+	entry.words = simplify(entry.name);
+	entry.pinyin = Utils::String::getPinyinInitials(entry.name);
+}
+
+int TextSearchIndex::getScore(const Entry& entry, const Query& query)
+{
+	if (!query.useRelevancy)
+	{
+		int score = 0;
+
+		for (int i = 0; i < query.tokens.size(); i++)
+		{
+			const std::string& folded = query.foldedTokens[i];
+
+			if (folded.empty() ? !entry.folded.empty() : entry.folded.find(folded) != std::string::npos)
+				return 1;
+
+			if (query.pinyin && Utils::String::containsPinyinInitials(entry.pinyin, query.tokens[i]))
+				score = 2;
+		}
+
+		return score;
+	}
+
+	if (Utils::String::compareIgnoreCase(entry.name, query.text) == 0)
+		return 1;
+
+	if (Utils::String::startsWithIgnoreCase(entry.name, query.text))
+		return 2;
+
+	if (!query.hasSpace)
+		return entry.folded.find(query.folded) != std::string::npos ? 3 : 0;
+
+	auto& filters = query.words;
+	auto& words = entry.words;
+
+	int totalWords = 0;
+	int commonWords = 0;
+
+	for (int i = 0; i < filters.size(); i++)
+	{
+		auto& filter = filters[i];
+
+		for (auto& word : words)
+		{
+			if (word == filter)
+			{
+				commonWords++;
+				break;
+			}
+		}
+
+		totalWords++;
+	}
+
+	if (commonWords == 0)
+		return 0;
+
+	int continuousWords = 0;
+	int maxContinuousWords = 0;
+	int wordsAtStart = 0;
+	bool countStart = true;
+
+	for (int j = 0; j < words.size(); j++)
+	{
+		auto word = words[j];
+
+		for (int i = 0; i < filters.size(); i++)
+		{
+			auto& filter = filters[i];
+
+			if (word == filter)
+			{
+				if (countStart && i == j)
+					wordsAtStart++;
+				else
+					countStart = false;
+
+				continuousWords++;
+
+				if (maxContinuousWords < continuousWords)
+					maxContinuousWords = continuousWords;
+
+				j++;
+
+				if (j < words.size())
+					word = words[j];
+				else
+					break;
+
+				continue;
+			}
+			else
+				countStart = false;
+
+			continuousWords = 0;
+		}
+	}
+
+	if (commonWords > 1 || filters.size() == 1)
+	{
+		int sc = ((wordsAtStart * 2) + (maxContinuousWords * 3) + commonWords);
+		return 1000 - sc;
+	}
+
+	auto dist = jw_distance(query.text, entry.name, false);
+	if (dist > 0.66)
+		return 1500 - (500 * dist);
+
+	return 0;
+}
+
+void TextSearchIndex::insert(Entry& entry)
+{
+	int id = (int)mEntries.size();
+
+	for (auto trigram : getTrigrams(entry.folded))
+		mTrigrams[trigram].push_back(id);
+
+	std::vector<std::string> words = entry.words;
+	std::sort(words.begin(), words.end());
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+
+	for (auto& word : words)
+		mWords[word].push_back(id);
+
+	if (!entry.pinyin.empty())
+		mPinyinEntries.push_back(id);
+
+	mIds[entry.game] = id;
+	mEntries.push_back(std::move(entry));
+}
+
+void TextSearchIndex::add(FileData* game)
+{
+	if (game == nullptr)
+		return;
+
+	if (mIds.find(game) != mIds.cend())
+		remove(game);
+
+	Entry entry;
+	createEntry(game, entry);
+	insert(entry);
+
+	mVersion++;
+}
+
+void TextSearchIndex::remove(FileData* game)
+{
+	auto it = mIds.find(game);
+	if (it == mIds.cend())
+		return;
+
+	mEntries[it->second] = Entry();
+	mIds.erase(it);
+
+	mRemovedCount++;
+	mVersion++;
+
+	if (mRemovedCount > COMPACT_MIN_REMOVED && mRemovedCount * 2 > (int)mEntries.size())
+		compact();
+}
+
+void TextSearchIndex::compact()
+{
+	std::vector<Entry> entries;
+	entries.swap(mEntries);
+
+	mIds.clear();
+	mTrigrams.clear();
+	mWords.clear();
+	mPinyinEntries.clear();
+	mRemovedCount = 0;
+
+	for (auto& entry : entries)
+		if (entry.game != nullptr)
+			insert(entry);
+}
+
+void TextSearchIndex::clear()
+{
+	mEntries.clear();
+	mIds.clear();
+	mTrigrams.clear();
+	mWords.clear();
+	mPinyinEntries.clear();
+	mRemovedCount = 0;
+	mVersion++;
+}
+
+bool TextSearchIndex::isIndexed(FileData* game)
+{
+	auto it = mIds.find(game);
+	if (it == mIds.cend())
+		return false;
+
+	const Entry& entry = mEntries[it->second];
+
+	FileData* source = game->getSourceFileData();
+	if (entry.version == source->getMetadata().getVersion())
+		return true;
+
+	// Any metadata change bumps the version : only a new name invalidates the entry
+	return entry.name == source->getName();
+}
+
+void TextSearchIndex::findSubstringCandidates(const std::string& folded, std::vector<int>& candidates)
+{
+	auto trigrams = getTrigrams(folded);
+	if (trigrams.empty())
+	{
+		// Too short to use the index
+		for (int id = 0; id < (int)mEntries.size(); id++)
+			if (mEntries[id].game != nullptr)
+				candidates.push_back(id);
+
+		return;
+	}
+
+	std::vector<const std::vector<int>*> lists;
+	for (auto trigram : trigrams)
+	{
+		auto it = mTrigrams.find(trigram);
+		if (it == mTrigrams.cend())
+			return;
+
+		lists.push_back(&it->second);
+	}
+
+	std::sort(lists.begin(), lists.end(), [](const std::vector<int>* a, const std::vector<int>* b) { return a->size() < b->size(); });
+
+	std::vector<int> ids = *lists[0];
+	std::vector<int> tmp;
+
+	for (size_t i = 1; i < lists.size() && !ids.empty(); i++)
+	{
+		tmp.clear();
+		std::set_intersection(ids.cbegin(), ids.cend(), lists[i]->cbegin(), lists[i]->cend(), std::back_inserter(tmp));
+		ids.swap(tmp);
+	}
+
+	candidates.insert(candidates.end(), ids.cbegin(), ids.cend());
+}
+
+void TextSearchIndex::search(const Query& query, std::unordered_map<FileData*, int>& scores)
+{
+	std::vector<int> candidates;
+
+	if (!query.useRelevancy)
+	{
+		for (auto& token : query.foldedTokens)
+			findSubstringCandidates(token, candidates);
+
+		if (query.pinyin)
+			candidates.insert(candidates.end(), mPinyinEntries.cbegin(), mPinyinEntries.cend());
+	}
+	else
+	{
+		// Exact & prefix matches are case insensitive beyond ASCII : only an ASCII text can use the trigrams
+		findSubstringCandidates(query.ascii ? query.folded : "", candidates);
+
+		for (auto& word : query.words)
+		{
+			auto it = mWords.find(word);
+			if (it != mWords.cend())
+				candidates.insert(candidates.end(), it->second.cbegin(), it->second.cend());
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	for (auto id : candidates)
+	{
+		const Entry& entry = mEntries[id];
+		if (entry.game == nullptr)
+			continue;
+
+		int score = getScore(entry, query);
+		if (score != 0)
+			scores[entry.game] = score;
+	}
+}
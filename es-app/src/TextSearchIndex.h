@@ -0,0 +1,87 @@
+#pragma once
+#ifndef ES_APP_TEXT_SEARCH_INDEX_H
+#define ES_APP_TEXT_SEARCH_INDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+class FileData;
+
+// Inverted index of game names, used by FileFilterIndex to answer a text search without scanning every game.
+// Names are stored case folded & split into trigrams : a substring query only verifies the games that contain all
+// of its trigrams. The words used by relevancy searches and the pinyin initials are computed once per game.
+class TextSearchIndex
+{
+public:
+	struct Entry
+	{
+		Entry() : game(nullptr), version(0) { }
+
+		FileData*	game;
+		unsigned int version;
+		std::string name;
+		std::string folded;
+		std::vector<std::string> words;
+		std::vector<const char*> pinyin;
+	};
+
+	struct Query
+	{
+		Query() : useRelevancy(false), pinyin(false), hasSpace(false), ascii(true) { }
+
+		std::string text;
+		std::string folded;
+		std::vector<std::string> tokens;		// comma separated alternatives, as typed
+		std::vector<std::string> foldedTokens;
+		std::vector<std::string> words;			// relevancy searches with several words
+
+		bool useRelevancy;
+		bool pinyin;
+		bool hasSpace;
+		bool ascii;
+	};
+
+	TextSearchIndex() : mVersion(0), mRemovedCount(0) { }
+
+	void add(FileData* game);
+	void remove(FileData* game);
+	void clear();
+
+	// false if the game is not indexed, or if its name changed since it was indexed
+	bool isIndexed(FileData* game);
+
+	// Incremented each time the index changes
+	unsigned int getVersion() const { return mVersion; }
+
+	// Scores of all indexed games matching the query (the lower, the more relevant)
+	void search(const Query& query, std::unordered_map<FileData*, int>& scores);
+
+	static Query createQuery(const std::string& text, bool useRelevancy, bool pinyin);
+	static void createEntry(FileData* game, Entry& entry);
+	static int getScore(const Entry& entry, const Query& query);
+
+private:
+	static std::string foldCase(const std::string& text);
+	static std::vector<std::string> simplify(const std::string& text);
+	static std::vector<uint32_t> getTrigrams(const std::string& folded);
+
+	void insert(Entry& entry);
+	void compact();
+
+	void findSubstringCandidates(const std::string& folded, std::vector<int>& candidates);
+
+	std::vector<Entry> mEntries;
+	std::unordered_map<FileData*, int> mIds;
+
+	// Posting lists hold entry ids in increasing order. Removed entries stay in them until the next compact()
+	std::unordered_map<uint32_t, std::vector<int>> mTrigrams;
+	std::unordered_map<std::string, std::vector<int>> mWords;
+	std::vector<int> mPinyinEntries;
+
+	unsigned int mVersion;
+	int mRemovedCount;
+};
+
+#endif // ES_APP_TEXT_SEARCH_INDEX_H
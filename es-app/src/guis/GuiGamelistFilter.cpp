@@ -119,6 +119,20 @@ void GuiGamelistFilter::addFiltersToMenu()
 
 		optionList = std::make_shared< OptionListComponent<std::string> >(mWindow, menuLabel, true);
 
+		// Games having each value, among the ones matching the other filters
+		std::map<std::string, int> counts;
+		if (mSystem != nullptr)
+			counts = mFilterIndex->getFacetCounts(type);
+
+		auto withCount = [&counts](const std::string& label, const std::string& key)
+		{
+			auto count = counts.find(key);
+			if (count == counts.cend())
+				return label;
+
+			return label + " (" + std::to_string(count->second) + ")";
+		};
+
 		if (it->type == GENRE_FILTER)
 		{
 			std::map<std::string, std::string> keyValues;
@@ -138,7 +152,7 @@ void GuiGamelistFilter::addFiltersToMenu()
 						label = "      " + Utils::String::trim(label.substr(split + 1));
 				}
 
-				optionList->add(label, key.second, mFilterIndex->isKeyBeingFilteredBy(key.second, type));
+				optionList->add(withCount(label, key.second), key.second, mFilterIndex->isKeyBeingFilteredBy(key.second, type));
 			}
 		}
 		else
@@ -146,11 +160,11 @@ void GuiGamelistFilter::addFiltersToMenu()
 			for (auto key : *allKeys)
 			{
 				if (key.first == "UNKNOWN")
-					optionList->add(_("Unknown"), key.first, mFilterIndex->isKeyBeingFilteredBy(key.first, type));
+					optionList->add(withCount(_("Unknown"), key.first), key.first, mFilterIndex->isKeyBeingFilteredBy(key.first, type));
 				else if (key.first == "TRUE")
-					optionList->add(_("YES"), key.first, mFilterIndex->isKeyBeingFilteredBy(key.first, type));
+					optionList->add(withCount(_("YES"), key.first), key.first, mFilterIndex->isKeyBeingFilteredBy(key.first, type));
 				else if (key.first == "FALSE")
-					optionList->add(_("NO"), key.first, mFilterIndex->isKeyBeingFilteredBy(key.first, type));
+					optionList->add(withCount(_("NO"), key.first), key.first, mFilterIndex->isKeyBeingFilteredBy(key.first, type));
 				else
 				{
 					std::string label = key.first;
@@ -167,7 +181,7 @@ void GuiGamelistFilter::addFiltersToMenu()
 						}
 					}
 
-					optionList->add(_(label.c_str()), key.first, mFilterIndex->isKeyBeingFilteredBy(key.first, type), false);
+					optionList->add(withCount(_(label.c_str()), key.first), key.first, mFilterIndex->isKeyBeingFilteredBy(key.first, type), false);
 				}
 			}
 		}
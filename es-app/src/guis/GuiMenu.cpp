@@ -57,6 +57,9 @@
 #include "guis/GuiBios.h"
 #include "guis/GuiKeyMappingEditor.h"
 #include "Gamelist.h"
+#include "GamelistSnapshot.h"
+#include "resources/TextureDiskCache.h"
+#include "utils/DirectoryIndex.h"
 #include "TextToSpeech.h"
 #include "Paths.h"
 
@@ -1509,6 +1512,7 @@ void GuiMenu::openDeveloperSettings()
 	s->addEntry(_("CLEAR CACHES"), true, [this, s]
 		{
 			ImageIO::clearImageCache();
+			TextureDiskCache::clear();
 
 			auto rootPath = Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath());
 
@@ -1734,6 +1738,19 @@ void GuiMenu::openDeveloperSettings()
 	s->addWithLabel(_("THREADED LOADING"), threadedLoading);
 	s->addSaveFunc([threadedLoading] { Settings::getInstance()->setBool("ThreadedLoading", threadedLoading->getState()); });
 
+	// gamelist snapshots
+	auto gamelistSnapshots = std::make_shared<SwitchComponent>(mWindow);
+	gamelistSnapshots->setState(Settings::getInstance()->getBool("GamelistSnapshots"));
+	s->addWithDescription(_("CACHE GAMELISTS"), _("Reload unchanged gamelists from a binary cache instead of scanning ROM folders on boot"), gamelistSnapshots);
+	s->addSaveFunc([gamelistSnapshots] 
+	{ 
+		if (Settings::getInstance()->setBool("GamelistSnapshots", gamelistSnapshots->getState()) && !gamelistSnapshots->getState())
+		{
+			GamelistSnapshot::removeAll();
+			Utils::DirectoryIndex::clear();
+		}
+	});
+
 	// threaded loading
 	auto asyncImages = std::make_shared<SwitchComponent>(mWindow);
 	asyncImages->setState(Settings::getInstance()->getBool("AsyncImages"));
@@ -1746,6 +1763,25 @@ void GuiMenu::openDeveloperSettings()
 	s->addWithLabel(_("OPTIMIZE IMAGES VRAM USE"), optimizeVram);
 	s->addSaveFunc([optimizeVram] { Settings::getInstance()->setBool("OptimizeVRAM", optimizeVram->getState()); });
 
+	// thumbnailCache
+	auto thumbnailCache = std::make_shared<SwitchComponent>(mWindow);
+	thumbnailCache->setState(Settings::getInstance()->getBool("ThumbnailCache"));
+	s->addWithDescription(_("CACHE SCALED IMAGES"), _("Keep downscaled images on disk so that large pictures are not decoded again"), thumbnailCache);
+	s->addSaveFunc([thumbnailCache]
+	{
+		if (Settings::getInstance()->setBool("ThumbnailCache", thumbnailCache->getState()) && !thumbnailCache->getState())
+			TextureDiskCache::clear();
+	});
+
+	// compressedTextures
+	if (Renderer::supportsTextureType(Renderer::Texture::ETC2_RGB))
+	{
+		auto compressedTextures = std::make_shared<SwitchComponent>(mWindow);
+		compressedTextures->setState(Settings::getInstance()->getBool("CompressedTextures"));
+		s->addWithDescription(_("COMPRESS SCALED IMAGES"), _("Store cached images as ETC2 textures, using 4 to 8 times less VRAM"), compressedTextures);
+		s->addSaveFunc([compressedTextures] { Settings::getInstance()->setBool("CompressedTextures", compressedTextures->getState()); });
+	}
+
 	// optimizeVideo
 	auto optimizeVideo = std::make_shared<SwitchComponent>(mWindow);
 	optimizeVideo->setState(Settings::getInstance()->getBool("OptimizeVideo"));
@@ -3392,12 +3428,14 @@ void GuiMenu::updateGameLists(Window* window, bool confirm)
 	
 	if (!confirm)
 	{
+		GamelistSnapshot::removeAll();
 		ViewController::reloadAllGames(window, true, true);
 		return;
 	}
 
 	window->pushGui(new GuiMsgBox(window, _("REALLY UPDATE GAMELISTS?"), _("YES"), [window]
 		{
+		GamelistSnapshot::removeAll();
 		ViewController::reloadAllGames(window, true, true);
 		}, 
 		_("NO"), nullptr));
@@ -4302,7 +4340,11 @@ void GuiMenu::openUISettings()
 			s->setVariable("reloadCollections", true);
 			s->setVariable("reloadAll", true); 
 		});
-	s->addSwitch(_("IGNORE LEADING ARTICLES WHEN SORTING"), _("Ignore 'The' and 'A' if at the start."), "IgnoreLeadingArticles", true, [s] { s->setVariable("reloadAll", true); });
+	s->addSwitch(_("IGNORE LEADING ARTICLES WHEN SORTING"), _("Ignore 'The' and 'A' if at the start."), "IgnoreLeadingArticles", true, [s] 
+		{
+			FileData::resetSettings();
+			s->setVariable("reloadAll", true); 
+		});
 	
 	s->onFinalize([s, pthis, window]
 	{
@@ -5,6 +5,7 @@
 #include "guis/GuiDetectDevice.h"
 #include "guis/GuiMsgBox.h"
 #include "utils/FileSystemUtil.h"
+#include "utils/DirectoryIndex.h"
 #include "views/ViewController.h"
 #include "CollectionSystemManager.h"
 #include "EmulationStation.h"
@@ -38,9 +39,12 @@
 #include "TextToSpeech.h"
 #include "Paths.h"
 #include "resources/TextureData.h"
+#include "resources/TextureDiskCache.h"
 #include "Scripting.h"
+#include "GamelistJournal.h"
 #include "watchers/WatchersManager.h"
 #include "HttpReq.h"
+#include "FrameBenchmark.h"
 
 #ifdef WIN32
 #include <Windows.h>
@@ -51,6 +55,7 @@
 static std::string gPlayVideo;
 static int gPlayVideoDuration = 0;
 static bool enable_startup_game = true;
+static int gBenchmarkFrames = 0;
 
 bool parseArgs(int argc, char* argv[])
 {
@@ -219,6 +224,21 @@ bool parseArgs(int argc, char* argv[])
 		{
 			Settings::getInstance()->setBool("ForceDisableFilters", true);
 		}
+		else if (strcmp(argv[i], "--headless") == 0)
+		{
+			Settings::getInstance()->setBool("Headless", true);
+
+			// Unless specified, don't require a display or an audio device
+			SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+			SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+		}
+		else if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			gBenchmarkFrames = 60;
+
+			if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+				gBenchmarkFrames = atoi(argv[++i]);
+		}
 		else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
 		{
 #ifdef WIN32
@@ -247,6 +267,8 @@ bool parseArgs(int argc, char* argv[])
 				"--force-kid		Force the UI mode to be Kid\n"
 				"--force-kiosk		Force the UI mode to be Kiosk\n"
 				"--force-disable-filters		Force the UI to ignore applied filters in gamelist\n"
+				"--headless			render nothing, without a display (draw calls are only counted)\n"
+				"--benchmark [frames]		navigate through the systems & gamelists, report frame times and exit\n"
 				"--home [path]		Directory to use as home path\n"
 				"--help, -h			summon a sentient, angry tuba\n\n"
 				"--monitor [index]			monitor index\n\n"				
@@ -285,6 +307,9 @@ bool loadSystemConfigFile(Window* window, const char** errorString)
 
 	ImageIO::loadImageCache();
 
+	if (Settings::getInstance()->getBool("ThumbnailCache"))
+		TextureDiskCache::trim();
+
 	if(!SystemData::loadConfig(window))
 	{
 		LOG(LogError) << "Error while parsing systems configuration file!";
@@ -654,6 +679,10 @@ int main(int argc, char* argv[])
 
 	bool running = true;
 
+	std::unique_ptr<FrameBenchmark> benchmark;
+	if (gBenchmarkFrames > 0)
+		benchmark = std::unique_ptr<FrameBenchmark>(new FrameBenchmark(&window, gBenchmarkFrames));
+
 	while(running)
 	{
 #ifdef WIN32	
@@ -714,6 +743,18 @@ int main(int argc, char* argv[])
 		if(deltaTime < 0)
 			deltaTime = 1000;
 
+		if (benchmark)
+		{
+			if (!benchmark->beginFrame())
+			{
+				running = false;
+				continue;
+			}
+
+			// Animations advance the same way, whatever the speed of the machine
+			deltaTime = FrameBenchmark::FRAME_TIME;
+		}
+
 		TRYCATCH("Window.update" ,window.update(deltaTime))	
 		TRYCATCH("Window.render", window.render())
 
@@ -731,9 +772,15 @@ int main(int argc, char* argv[])
 
 		Renderer::swapBuffers();
 
+		if (benchmark)
+			benchmark->endFrame();
+
 		Log::flush();
 	}
 
+	if (benchmark)
+		benchmark->report();
+
 	if (Utils::Platform::isFastShutdown())
 		Settings::getInstance()->setBool("IgnoreGamelist", true);
 
@@ -741,6 +788,13 @@ int main(int argc, char* argv[])
 	ThreadedHasher::stop();
 	ThreadedScraper::stop();
 
+	// Media folders are listed after the boot time save
+	if (Settings::GamelistSnapshots())
+		Utils::DirectoryIndex::save();
+
+	Utils::DirectoryIndex::stop();
+	GamelistJournal::stop();
+
 	ApiSystem::getInstance()->deinit();
 
 	while (window.peekGui() != ViewController::get())
@@ -16,6 +16,8 @@
 #include "utils/md5.h"
 #include "scrapers/Scraper.h"
 #include <unordered_map>
+#include <algorithm>
+#include <mutex>
 
 void HttpApi::getSystemDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, SystemData* sys, bool localpaths)
 {
@@ -99,16 +101,67 @@ std::string HttpApi::getSystemList()
 	return s.GetString();
 }
 
-std::string HttpApi::getFileDataId(FileData* game)
+static std::string getPathId(const std::string& path)
 {
 	MD5 md5;
-	md5.update(game->getPath().c_str(), game->getPath().size());
+	md5.update(path.c_str(), path.size());
 	md5.finalize();
 	return md5.hexdigest();
 }
 
-FileData* HttpApi::findFileData(SystemData* system, const std::string& id)
+std::string HttpApi::getFileDataId(FileData* game)
+{
+	return getPathId(game->getPath());
+}
+
+// Game ids are the md5 of the paths : instead of hashing every path of a system on each request, the ids are indexed
+// per system, and the index is rebuilt when a folder of the system changes. Known paths keep their id during a rebuild.
+struct GameIdIndex
+{
+	GameIdIndex() : version(0) { }
+
+	unsigned int version;
+	std::unordered_map<std::string, FileData*> games;
+	std::unordered_map<std::string, std::string> ids;
+};
+
+static std::mutex mGameIdIndexesLock;
+static std::map<SystemData*, GameIdIndex> mGameIdIndexes;
+
+// Tree versions are unique and increasing : the latest one among a group and its systems changes with any of them
+static unsigned int getGameIdIndexVersion(SystemData* system)
+{
+	unsigned int version = system->getTreeVersion();
+
+	// The folders of a group are the ones of its systems
+	if (system->isGroupSystem())
+		for (auto child : SystemData::sSystemVector)
+			if (child != system && child->isGroupChildSystem() && child->getParentGroupSystem() == system)
+				version = std::max(version, child->getTreeVersion());
+
+	return version;
+}
+
+static GameIdIndex& getGameIdIndex(SystemData* system)
 {
+	unsigned int version = getGameIdIndexVersion(system);
+
+	GameIdIndex& index = mGameIdIndexes[system];
+	if (index.version == version)
+		return index;
+
+	// Systems may have been reloaded : forget indexes of systems that don't exist anymore
+	for (auto it = mGameIdIndexes.begin(); it != mGameIdIndexes.end(); )
+	{
+		if (it->first != system && std::find(SystemData::sSystemVector.cbegin(), SystemData::sSystemVector.cend(), it->first) == SystemData::sSystemVector.cend())
+			it = mGameIdIndexes.erase(it);
+		else
+			it++;
+	}
+
+	std::unordered_map<std::string, std::string> ids;
+	index.games.clear();
+
 	std::stack<FolderData*> stack;
 	stack.push(system->getRootFolder());
 
@@ -118,23 +171,47 @@ FileData* HttpApi::findFileData(SystemData* system, const std::string& id)
 		stack.pop();
 
 		for (auto it : current->getChildren())
-		{			
+		{
 			if (it->getType() == FOLDER)
+			{
 				stack.push((FolderData*)it);
-			else if (getFileDataId(it) == id)
-				return it;
+				continue;
+			}
+
+			std::string path = it->getPath();
+
+			auto known = index.ids.find(path);
+			std::string id = (known != index.ids.cend() ? known->second : getPathId(path));
+
+			index.games.emplace(id, it); // Keep the first match, like the tree walk did
+			ids[path] = id;
 		}
 	}
 
+	index.ids = std::move(ids);
+	index.version = version;
+	return index;
+}
+
+FileData* HttpApi::findFileData(SystemData* system, const std::string& id)
+{
+	std::unique_lock<std::mutex> lock(mGameIdIndexesLock);
+
+	GameIdIndex& index = getGameIdIndex(system);
+
+	auto it = index.games.find(id);
+	if (it != index.games.cend())
+		return it->second;
+
 	return nullptr;
 }
 
-void HttpApi::getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths)
+void HttpApi::getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths, const std::string& gameId)
 {
 	if (game->getType() != GAME)
 		return;
 
-	std::string id = getFileDataId(game);
+	std::string id = gameId.empty() ? getFileDataId(game) : gameId;
 
 	writer.StartObject();
 	writer.Key("id"); writer.String(id.c_str());
@@ -143,8 +220,8 @@ void HttpApi::getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>&
 
 	writer.Key("systemName"); writer.String(game->getSystemName().c_str());
 
-	auto meta = game->getMetadata();
-	for (auto mdd : MetaDataList::getMDD())
+	auto& meta = game->getMetadata();
+	for (auto& mdd : MetaDataList::getMDD())
 	{
 		if (mdd.id == MetaDataId::Name)
 			continue;
@@ -305,8 +382,37 @@ std::string HttpApi::getSystemGames(SystemData* system)
 		}
 	}
 
+	std::unique_lock<std::mutex> lock(mGameIdIndexesLock);
+	GameIdIndex& index = getGameIdIndex(system);
+
 	for (auto game : files)
-		getFileDataJson(writer, game);
+	{
+		auto id = index.ids.find(game->getPath());
+		getFileDataJson(writer, game, false, id != index.ids.cend() ? id->second : "");
+	}
+
+	writer.EndArray();
+
+	return s.GetString();
+}
+
+std::string HttpApi::getSystemGames(SystemData* system, const std::vector<std::string>& ids, bool localpaths)
+{
+	rapidjson::StringBuffer s;
+	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+
+	writer.StartArray();
+
+	std::unique_lock<std::mutex> lock(mGameIdIndexesLock);
+	GameIdIndex& index = getGameIdIndex(system);
+
+	// Unknown ids are skipped
+	for (auto& id : ids)
+	{
+		auto it = index.games.find(id);
+		if (it != index.games.cend())
+			getFileDataJson(writer, it->second, localpaths, id);
+	}
 
 	writer.EndArray();
 
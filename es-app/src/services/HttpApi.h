@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/pointer.h>
 #include <rapidjson/prettywriter.h>
@@ -15,6 +16,7 @@ public:
 	static std::string getCaps();
 	static std::string getSystemList();
 	static std::string getSystemGames(SystemData* system);
+	static std::string getSystemGames(SystemData* system, const std::vector<std::string>& ids, bool localpaths = false);
 
 	static std::string getRunnningGameInfo();
 
@@ -30,6 +32,6 @@ public:
 
 private:
 	static std::string getFileDataId(FileData* game);
-	static void getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths = false);
+	static void getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths = false, const std::string& gameId = "");
 	static void getSystemDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, SystemData* sys, bool localpaths = false);
 };
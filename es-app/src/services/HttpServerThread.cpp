@@ -1,3 +1,5 @@
+#define _FILE_OFFSET_BITS 64
+
 #include "HttpServerThread.h"
 #include "httplib.h"
 #include "Log.h"
@@ -16,6 +18,7 @@
 #include "guis/GuiMenu.h"
 #include "guis/GuiMsgBox.h"
 #include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
 #include "HttpApi.h"
 #include "Settings.h"
 #include "ApiSystem.h"
@@ -45,6 +48,8 @@ System/Games APIS
 GET  /systems
 GET  /systems/{systemName}
 GET  /systems/{systemName}/logo
+GET  /systems/{systemName}/games								-> all games, or only the games listed in the ?ids={gameId},{gameId}... parameter
+POST /systems/{systemName}/games								-> body must contain the array of game ids to fetch as application/json
 GET  /systems/{systemName}/games/{gameId}		
 POST /systems/{systemName}/games/{gameId}						-> body must contain the game metadatas to save as application/json
 GET  /systems/{systemName}/games/{gameId}/media/{mediaType}
@@ -106,7 +111,13 @@ static std::map<std::string, std::string> mimeTypes =
 	{ "js", "application/javascript" },
 	{ "wasm", "application/wasm" },
 	{ "xml", "application/xml" },
-	{ "xhtml", "application/xhtml+xml" }
+	{ "xhtml", "application/xhtml+xml" },
+	{ "mp4", "video/mp4" },
+	{ "webm", "video/webm" },
+	{ "mkv", "video/x-matroska" },
+	{ "avi", "video/x-msvideo" },
+	{ "mov", "video/quicktime" },
+	{ "cbz", "application/vnd.comicbook+zip" }
 };
 
 std::string HttpServerThread::getMimeType(const std::string &path)
@@ -136,6 +147,141 @@ static bool isAllowed(const httplib::Request& req, httplib::Response& res)
 	return true;
 }
 
+static std::string getHttpDate(time_t time)
+{
+	static const char* days[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+	static const char* months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+	struct tm tm;
+#if WIN32
+	gmtime_s(&tm, &time);
+#else
+	gmtime_r(&time, &tm);
+#endif
+
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT", days[tm.tm_wday], tm.tm_mday, months[tm.tm_mon], tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+	return buffer;
+}
+
+static bool isETagMatch(const std::string& ifNoneMatch, const std::string& etag)
+{
+	for (auto tag : Utils::String::split(ifNoneMatch, ',', true))
+	{
+		tag = Utils::String::trim(tag);
+		if (Utils::String::startsWith(tag, "W/"))
+			tag = tag.substr(2);
+
+		if (tag == "*" || tag == etag)
+			return true;
+	}
+
+	return false;
+}
+
+// Files are streamed by blocks so that large videos are never loaded in memory. Range requests let clients seek,
+// ETag & Last-Modified let them revalidate their cache. Returns false if the file can't be found.
+static bool sendFile(const httplib::Request& req, httplib::Response& res, const std::string& path)
+{
+	// Embedded resources are small : they are sent as is
+	if (Utils::String::startsWith(path, ":/"))
+	{
+		auto data = ResourceManager::getInstance()->getFileData(path);
+		if (!data.ptr)
+			return false;
+
+		res.set_content((char*)data.ptr.get(), data.length, HttpServerThread::getMimeType(path).c_str());
+		return true;
+	}
+
+	unsigned long long size = Utils::FileSystem::getFileSize(path);
+	if (size == 0)
+		return false;
+
+	time_t lastWriteTime = Utils::FileSystem::getFileModificationDate(path).getTime();
+
+	char etag[64];
+	snprintf(etag, sizeof(etag), "\"%llx-%llx\"", (unsigned long long)lastWriteTime, size);
+
+	std::string lastModified = getHttpDate(lastWriteTime);
+
+	res.set_header("Accept-Ranges", "bytes");
+	res.set_header("ETag", etag);
+	res.set_header("Last-Modified", lastModified);
+	res.set_header("Cache-Control", "no-cache");
+
+	// Clients send back the values we gave them : comparing strings is enough
+	bool notModified = req.has_header("If-None-Match") ?
+		isETagMatch(req.get_header_value("If-None-Match"), etag) :
+		req.has_header("If-Modified-Since") && req.get_header_value("If-Modified-Since") == lastModified;
+
+	if (notModified)
+	{
+		res.status = 304;
+		return true;
+	}
+
+	// httplib computes the offsets of the ranges without checking them against the file size : clamp them as RFC 7233 says,
+	// and reject the ranges starting after the end of the file
+	auto& ranges = const_cast<httplib::Request&>(req).ranges;
+	for (auto& range : ranges)
+	{
+		if (range.first == -1)
+		{
+			if (range.second > 0)
+			{
+				if ((unsigned long long)range.second > size)
+					range = std::make_pair((ssize_t)0, (ssize_t)size - 1);
+
+				continue;
+			}
+		}
+		else if ((unsigned long long)range.first < size && (range.second == -1 || range.second >= range.first))
+		{
+			if (range.second != -1 && (unsigned long long)range.second >= size)
+				range.second = (ssize_t)size - 1;
+
+			continue;
+		}
+
+		ranges.clear();
+		res.set_header("Content-Range", "bytes */" + std::to_string(size));
+		res.status = 416;
+		return true;
+	}
+
+#if WIN32
+	FILE* file = _wfopen(Utils::String::convertToWideString(path).c_str(), L"rb");
+#else
+	FILE* file = fopen(path.c_str(), "rb");
+#endif
+	if (file == nullptr)
+		return false;
+
+	res.set_header("Content-Type", HttpServerThread::getMimeType(path));
+	res.set_content_provider((size_t)size, [file](size_t offset, size_t length, httplib::DataSink& sink)
+	{
+		char buffer[32 * 1024];
+
+#if WIN32
+		if (_fseeki64(file, offset, SEEK_SET) != 0)
+#else
+		if (fseeko(file, offset, SEEK_SET) != 0)
+#endif
+			return false;
+
+		size_t read = fread(buffer, 1, std::min(length, sizeof(buffer)), file);
+		if (read == 0)
+			return false;
+
+		sink.write(buffer, read);
+		return true;
+	},
+	[file]() { fclose(file); });
+
+	return true;
+}
+
 void HttpServerThread::run()
 {
 	mHttpServer = new httplib::Server();
@@ -322,12 +468,8 @@ void HttpServerThread::run()
 				if (elem && elem->has("path"))
 				{
 					std::string logo = elem->get<std::string>("path");
-					auto data = ResourceManager::getInstance()->getFileData(logo);
-					if (data.ptr)
-					{
-						res.set_content((char*)data.ptr.get(), data.length, getMimeType(logo).c_str());
+					if (sendFile(req, res, logo))
 						return;
-					}
 				}
 			}
 		}
@@ -345,6 +487,13 @@ void HttpServerThread::run()
 		SystemData* system = SystemData::getSystem(systemName);
 		if (system != nullptr)
 		{
+			if (req.has_param("ids"))
+			{
+				bool localpaths = req.has_param("localpaths") && req.get_param_value("localpaths") == "true";
+				res.set_content(HttpApi::getSystemGames(system, Utils::String::commaStringToVector(req.get_param_value("ids")), localpaths), "application/json");
+				return;
+			}
+
 			res.set_content(HttpApi::getSystemGames(system), "application/json");
 			return;
 		}
@@ -353,6 +502,38 @@ void HttpServerThread::run()
 		res.status = 404;		
 	});
 
+	mHttpServer->Post(R"(/systems/(/?.*)/games)", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		rapidjson::Document doc;
+		doc.Parse(req.body.c_str());
+		if (doc.HasParseError() || !doc.IsArray())
+		{
+			res.set_content("400 bad request - body must be an array of game ids", "text/html");
+			res.status = 400;
+			return;
+		}
+
+		std::vector<std::string> ids;
+		for (auto& id : doc.GetArray())
+			if (id.IsString())
+				ids.push_back(id.GetString());
+
+		std::string systemName = req.matches[1];
+		SystemData* system = SystemData::getSystem(systemName);
+		if (system != nullptr)
+		{
+			bool localpaths = req.has_param("localpaths") && req.get_param_value("localpaths") == "true";
+			res.set_content(HttpApi::getSystemGames(system, ids, localpaths), "application/json");
+			return;
+		}
+
+		res.set_content("404 system not found", "text/html");
+		res.status = 404;
+	});
+
 	mHttpServer->Get(R"(/systems/(/?.*)/games/(/?.*)/media/(/?.*))", [](const httplib::Request& req, httplib::Response& res)
 	{
 		if (!isAllowed(req, res))
@@ -371,17 +552,8 @@ void HttpServerThread::run()
 				if (game->getMetadata().getType(metadataName) == MD_PATH)
 				{
 					std::string path = game->getMetadata().get(metadataName);
-					if (!path.empty())
-					{
-						auto data = ResourceManager::getInstance()->getFileData(path);
-						if (data.ptr)
-						{
-							res.set_content((char*)data.ptr.get(), data.length, getMimeType(path).c_str());
-							return;
-						}
-
+					if (!path.empty() && sendFile(req, res, path))
 						return;
-					}
 				}
 			}
 		}
@@ -1,8 +1,10 @@
 #include "ImageIO.h"
+#include "ImageSizeCache.h"
 
 #include "Log.h"
 #include <FreeImage.h>
 #include <string.h>
+#include <stdint.h>
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
 #include <sstream>
@@ -14,8 +16,178 @@
 #include "Paths.h"
 #include "math/Vector4f.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMAGEIO_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define IMAGEIO_NEON
+#endif
+
 const MaxSizeInfo MaxSizeInfo::Empty;
 
+// Swaps the 1st & 3rd bytes of 32 bits pixels (BGRA <-> RGBA). src & dst can be the same buffer
+static void swapRedBlue(unsigned int* dst, const unsigned int* src, size_t count)
+{
+	size_t i = 0;
+
+#if defined(IMAGEIO_SSE2)
+	const __m128i maskAG = _mm_set1_epi32(0xFF00FF00);
+	const __m128i maskB = _mm_set1_epi32(0xFF);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i ag = _mm_and_si128(c, maskAG);
+		__m128i r = _mm_slli_epi32(_mm_and_si128(c, maskB), 16);
+		__m128i b = _mm_and_si128(_mm_srli_epi32(c, 16), maskB);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(ag, _mm_or_si128(r, b)));
+	}
+#elif defined(IMAGEIO_NEON)
+	for (; i + 16 <= count; i += 16)
+	{
+		uint8x16x4_t px = vld4q_u8((const uint8_t*)(src + i));
+		uint8x16_t tmp = px.val[0];
+		px.val[0] = px.val[2];
+		px.val[2] = tmp;
+		vst4q_u8((uint8_t*)(dst + i), px);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		unsigned int c = src[i];
+		dst[i] = (c & 0xFF00FF00) | ((c & 0xFF) << 16) | ((c >> 16) & 0xFF);
+	}
+}
+
+static void swapBytes(unsigned char* a, unsigned char* b, size_t length)
+{
+	size_t i = 0;
+
+#if defined(IMAGEIO_SSE2)
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+		_mm_storeu_si128((__m128i*)(a + i), vb);
+		_mm_storeu_si128((__m128i*)(b + i), va);
+	}
+#elif defined(IMAGEIO_NEON)
+	for (; i + 16 <= length; i += 16)
+	{
+		uint8x16_t va = vld1q_u8(a + i);
+		uint8x16_t vb = vld1q_u8(b + i);
+		vst1q_u8(a + i, vb);
+		vst1q_u8(b + i, va);
+	}
+#endif
+
+	for (; i < length; i++)
+		std::swap(a[i], b[i]);
+}
+
+// Adds each run of source pixels [xStart[x], xStart[x + 1]) to the 4 channel sums of the destination pixel x
+static void accumulatePixels(const unsigned char* row, const size_t* xStart, unsigned int* sums, size_t dstWidth)
+{
+#if defined(IMAGEIO_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+
+	for (size_t x = 0; x < dstWidth; x++)
+	{
+		__m128i acc = _mm_loadu_si128((const __m128i*)(sums + x * 4));
+
+		for (size_t sx = xStart[x]; sx < xStart[x + 1]; sx++)
+		{
+			int c;
+			memcpy(&c, row + sx * 4, 4);
+
+			__m128i px = _mm_unpacklo_epi8(_mm_cvtsi32_si128(c), zero);
+			acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(px, zero));
+		}
+
+		_mm_storeu_si128((__m128i*)(sums + x * 4), acc);
+	}
+#elif defined(IMAGEIO_NEON)
+	for (size_t x = 0; x < dstWidth; x++)
+	{
+		uint32x4_t acc = vld1q_u32(sums + x * 4);
+
+		for (size_t sx = xStart[x]; sx < xStart[x + 1]; sx++)
+		{
+			uint32_t c;
+			memcpy(&c, row + sx * 4, 4);
+
+			uint8x8_t px = vreinterpret_u8_u32(vdup_n_u32(c));
+			acc = vaddw_u16(acc, vget_low_u16(vmovl_u8(px)));
+		}
+
+		vst1q_u32(sums + x * 4, acc);
+	}
+#else
+	for (size_t x = 0; x < dstWidth; x++)
+	{
+		unsigned int* acc = sums + x * 4;
+
+		for (size_t sx = xStart[x]; sx < xStart[x + 1]; sx++)
+		{
+			const unsigned char* px = row + sx * 4;
+			acc[0] += px[0];
+			acc[1] += px[1];
+			acc[2] += px[2];
+			acc[3] += px[3];
+		}
+	}
+#endif
+}
+
+// Area-average downscaling of 32 bits pixels : every destination pixel is the mean of the source pixels it covers.
+// Rows keep their order & channels are averaged independently, whatever their layout
+static void downscalePixels(const unsigned char* src, size_t srcWidth, size_t srcHeight, size_t srcPitch, unsigned char* dst, size_t dstWidth, size_t dstHeight)
+{
+	std::vector<size_t> xStart(dstWidth + 1);
+	for (size_t x = 0; x <= dstWidth; x++)
+		xStart[x] = x * srcWidth / dstWidth;
+
+	// The 32 bits sums hold up to UINT32_MAX / 255 pixels : past that number of rows, they are moved to 64 bits totals
+	size_t maxRun = 1;
+	for (size_t x = 0; x < dstWidth; x++)
+		maxRun = std::max(maxRun, xStart[x + 1] - xStart[x]);
+
+	size_t rowsPerSum = std::max((size_t)1, (size_t)(UINT32_MAX / 255) / maxRun);
+
+	std::vector<unsigned int> sums(dstWidth * 4);
+	std::vector<uint64_t> totals(dstWidth * 4);
+
+	for (size_t y = 0; y < dstHeight; y++)
+	{
+		size_t y0 = y * srcHeight / dstHeight;
+		size_t y1 = std::max(y0 + 1, (y + 1) * srcHeight / dstHeight);
+
+		std::fill(totals.begin(), totals.end(), 0);
+
+		for (size_t batch = y0; batch < y1; batch += rowsPerSum)
+		{
+			std::fill(sums.begin(), sums.end(), 0);
+
+			for (size_t sy = batch; sy < std::min(y1, batch + rowsPerSum); sy++)
+				accumulatePixels(src + sy * srcPitch, xStart.data(), sums.data(), dstWidth);
+
+			for (size_t i = 0; i < totals.size(); i++)
+				totals[i] += sums[i];
+		}
+
+		unsigned char* out = dst + y * dstWidth * 4;
+
+		for (size_t x = 0; x < dstWidth; x++)
+		{
+			uint64_t count = (uint64_t)(xStart[x + 1] - xStart[x]) * (y1 - y0);
+			for (int c = 0; c < 4; c++)
+				out[x * 4 + c] = (unsigned char)((totals[x * 4 + c] + count / 2) / count);
+		}
+	}
+}
+
 unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const size_t size, size_t & width, size_t & height, MaxSizeInfo* maxSize, Vector2i* baseSize, Vector2i* packedSize, int subImageIndex)
 {
 	LOG(LogDebug) << "ImageIO::loadFromMemoryRGBA32";
@@ -85,6 +257,8 @@ unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const s
 					if (baseSize != nullptr)
 						*baseSize = Vector2i(width, height);
 
+					unsigned char* tempData = nullptr;
+
 					size_t maxX = maxSize == nullptr ? 0 : (size_t) Math::round(maxSize->x());
 					size_t maxY = maxSize == nullptr ? 0 : (size_t) Math::round(maxSize->y());
 
@@ -95,44 +269,51 @@ unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const s
 						if (sz.x() > Renderer::getScreenWidth() || sz.y() > Renderer::getScreenHeight())
 							sz = adjustPictureSize(sz, Vector2i(Renderer::getScreenWidth(), Renderer::getScreenHeight()), false);
 						
-						if (sz.x() != width || sz.y() != height)
+						if ((size_t)sz.x() != width || (size_t)sz.y() != height)
 						{
 							LOG(LogDebug) << "ImageIO : rescaling image from " << std::string(std::to_string(width) + "x" + std::to_string(height)).c_str() << " to " << std::string(std::to_string(sz.x()) + "x" + std::to_string(sz.y())).c_str();
 
-							FIBITMAP* imageRescaled = FreeImage_Rescale(fiBitmap, sz.x(), sz.y(), FILTER_BOX);
-
-							if (fiMultiBitmap != nullptr)
+							if (sz.x() > 0 && sz.y() > 0 && (size_t)sz.x() <= width && (size_t)sz.y() <= height)
 							{
-								FreeImage_UnlockPage(fiMultiBitmap, fiBitmap, false);
-								FreeImage_CloseMultiBitmap(fiMultiBitmap);
-								fiMultiBitmap = nullptr;
+								// Downscale straight into the output buffer, the pixels are swizzled below
+								tempData = new unsigned char[sz.x() * sz.y() * 4];
+								downscalePixels(FreeImage_GetBits(fiBitmap), width, height, FreeImage_GetPitch(fiBitmap), tempData, sz.x(), sz.y());
+
+								width = sz.x();
+								height = sz.y();
 							}
 							else
-								FreeImage_Unload(fiBitmap);
+							{
+								FIBITMAP* imageRescaled = FreeImage_Rescale(fiBitmap, sz.x(), sz.y(), FILTER_BOX);
+
+								if (fiMultiBitmap != nullptr)
+								{
+									FreeImage_UnlockPage(fiMultiBitmap, fiBitmap, false);
+									FreeImage_CloseMultiBitmap(fiMultiBitmap);
+									fiMultiBitmap = nullptr;
+								}
+								else
+									FreeImage_Unload(fiBitmap);
 
-							fiBitmap = imageRescaled;
+								fiBitmap = imageRescaled;
 
-							width = FreeImage_GetWidth(fiBitmap);
-							height = FreeImage_GetHeight(fiBitmap);
+								width = FreeImage_GetWidth(fiBitmap);
+								height = FreeImage_GetHeight(fiBitmap);
+							}
 
 							if (packedSize != nullptr)
 								*packedSize = Vector2i(width, height);
 						}
 					}
 
-					unsigned char* tempData = new unsigned char[width * height * 4];
-
-					int w = (int)width;
-
-					for (int y = (int)height; --y >= 0; )
+					if (tempData != nullptr)
+						swapRedBlue((unsigned int*)tempData, (const unsigned int*)tempData, width * height);
+					else
 					{
-						unsigned int* argb = (unsigned int*)FreeImage_GetScanLine(fiBitmap, y);
-						unsigned int* abgr = (unsigned int*)(tempData + (y * width * 4));
-						for (int x = w; --x >= 0;)
-						{
-							unsigned int c = argb[x];
-							abgr[x] = (c & 0xFF00FF00) | ((c & 0xFF) << 16) | ((c >> 16) & 0xFF);
-						}
+						tempData = new unsigned char[width * height * 4];
+
+						for (int y = (int)height; --y >= 0; )
+							swapRedBlue((unsigned int*)(tempData + (y * width * 4)), (const unsigned int*)FreeImage_GetScanLine(fiBitmap, y), width);
 					}
 
 					if (fiMultiBitmap)
@@ -166,17 +347,10 @@ unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const s
 
 void ImageIO::flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height)
 {
-	unsigned int temp;
-	unsigned int* arr = (unsigned int*)imagePx;
-	for(size_t y = 0; y < height / 2; y++)
-	{
-		for(size_t x = 0; x < width; x++)
-		{
-			temp = arr[x + (y * width)];
-			arr[x + (y * width)] = arr[x + (height * width) - ((y + 1) * width)];
-			arr[x + (height * width) - ((y + 1) * width)] = temp;
-		}
-	}
+	size_t rowSize = width * 4;
+
+	for (size_t y = 0; y < height / 2; y++)
+		swapBytes(imagePx + y * rowSize, imagePx + (height - y - 1) * rowSize, rowSize);
 }
 
 Vector2f ImageIO::adjustPictureSizeF(Vector2f imageSize, Vector2f maxSize, bool externSize)
@@ -275,30 +449,6 @@ Vector2f ImageIO::getPictureMinSize(Vector2f imageSize, Vector2f maxSize)
 	return Vector2f(cxDIB, cyDIB);
 }
 
-struct CachedFileInfo
-{
-	CachedFileInfo(int sz, int sx, int sy)
-	{
-		size = sz;
-		x = sx;
-		y = sy;		
-	};
-
-	CachedFileInfo()
-	{
-		size = 0;
-		x = 0;
-		y = 0;		
-	};
-
-	int size;
-	int x;
-	int y;	
-};
-
-static std::unordered_map<std::string, CachedFileInfo> sizeCache;
-static bool sizeCacheDirty = false;
-
 std::string getImageCacheFilename()
 {
 	return Paths::getUserEmulationStationPath() + "/imagecache.db";
@@ -308,139 +458,27 @@ void ImageIO::clearImageCache()
 {
 	std::string fname = getImageCacheFilename();
 	Utils::FileSystem::removeFile(fname);
-	sizeCache.clear();
+	ImageSizeCache::clear();
 }
 
 void ImageIO::loadImageCache()
 {
-	std::string fname = getImageCacheFilename();
-
-	std::ifstream f(fname.c_str());
-	if (f.fail())
-		return;
-
-	sizeCache.clear();
-
-	std::string relativeTo = Paths::getRootPath();
-
-	std::vector<std::string> splits;
-
-	std::string line;
-	while (std::getline(f, line))
-	{
-		splits.clear();
-
-		const char* src = line.c_str();
-
-		while (true)
-		{
-			const char* d = strchr(src, '|');
-			size_t len = (d) ? d - src : strlen(src);
-
-			if (len)
-				splits.push_back(std::string(src, len)); // capture token
-
-			if (d) src += len + 1; else break;
-		}
-
-		if (splits.size() == 4)
-		{
-			std::string file = Utils::FileSystem::resolveRelativePath(splits[0], relativeTo, true);
-
-			CachedFileInfo fi;
-			fi.size = Utils::String::toInteger(splits[1]);
-			fi.x = Utils::String::toInteger(splits[2]);
-			fi.y = Utils::String::toInteger(splits[3]);
-
-			sizeCache[file] = fi;
-		}
-	}
-
-	f.close();
-}
-
-static bool _isCachablePath(const std::string& path)
-{
-	return 
-		path.find("/themes/") == std::string::npos && 
-		path.find("/tmp/") == std::string::npos &&
-		path.find("/emulationstation.tmp/") == std::string::npos &&
-		path.find("/pdftmp/") == std::string::npos && 
-		path.find("/saves/") == std::string::npos;
+	ImageSizeCache::load(getImageCacheFilename());
 }
 
 void ImageIO::saveImageCache()
 {
-	if (!sizeCacheDirty)
-		return;
-
-	std::string fname = getImageCacheFilename();
-	std::ofstream f(fname.c_str(), std::ios::binary);
-	if (f.fail())
-		return;
-
-	std::string relativeTo = Paths::getRootPath();
-
-	for (auto it : sizeCache)
-	{
-		if (it.second.size < 0)
-			continue;
-
-		if (!_isCachablePath(it.first))
-			continue;
-
-		std::string path = Utils::FileSystem::createRelativePath(it.first, relativeTo, true); 
-
-		f << path;
-		f << "|";
-		f << std::to_string(it.second.size);
-		f << "|";
-		f << std::to_string(it.second.x);
-		f << "|";
-		f << std::to_string(it.second.y);
-		f << "\n";
-	}
-
-	f.close();
+	ImageSizeCache::save(getImageCacheFilename());
 }
 
-static std::mutex sizeCacheLock;
-
 void ImageIO::removeImageCache(const std::string& fn)
 {
-	std::unique_lock<std::mutex> lock(sizeCacheLock);
-
-	auto it = sizeCache.find(fn);
-	if (it != sizeCache.cend())
-		sizeCache.erase(fn);
+	ImageSizeCache::remove(fn);
 }
 
 void ImageIO::updateImageCache(const std::string& fn, int sz, int x, int y)
 {
-	std::unique_lock<std::mutex> lock(sizeCacheLock);
-
-	auto it = sizeCache.find(fn);
-	if (it != sizeCache.cend())
-	{
-		if (x != it->second.x || y != it->second.y || sz != it->second.size)
-		{
-			auto& item = it->second;
-
-			item.x = x;
-			item.y = y;
-			item.size = sz;
-
-			if (sz > 0 && x > 0 && _isCachablePath(fn))
-				sizeCacheDirty = true;
-		}
-	}
-	else
-	{
-		sizeCache[fn] = CachedFileInfo(sz, x, y);
-
-		if (sz > 0 && x > 0 && _isCachablePath(fn))
-			sizeCacheDirty = true;
-	}
+	ImageSizeCache::set(fn, CachedFileInfo(sz, x, y));
 }
 
 static bool extractSvgSize(const std::string& svgFilePath, float& width, float& height)
@@ -527,19 +565,15 @@ static bool extractSvgSize(const std::string& svgFilePath, float& width, float&
 
 bool ImageIO::loadImageSize(const std::string& fn, unsigned int *x, unsigned int *y)
 {
+	CachedFileInfo info;
+	if (ImageSizeCache::get(fn, info))
 	{
-		std::unique_lock<std::mutex> lock(sizeCacheLock);
-
-		auto it = sizeCache.find(fn);
-		if (it != sizeCache.cend())
-		{
-			if (it->second.size < 0)
-				return false;
+		if (info.size < 0)
+			return false;
 
-			*x = it->second.x;
-			*y = it->second.y;
-			return true;
-		}
+		*x = info.x;
+		*y = info.y;
+		return true;
 	}
 
 	LOG(LogDebug) << "ImageIO::loadImageSize " << fn;
@@ -0,0 +1,301 @@
+#include "ImageSizeCache.h"
+
+#include "utils/BinaryFile.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <fstream>
+
+#define IMAGECACHE_MAGIC	"ESIC"
+#define IMAGECACHE_VERSION	1
+#define IMAGECACHE_HEADER	16	// magic, version, capacity, count
+
+std::atomic<ImageSizeCache::Table*> ImageSizeCache::mTable(nullptr);
+std::mutex ImageSizeCache::mTablesLock;
+std::vector<std::unique_ptr<ImageSizeCache::Table>> ImageSizeCache::mTables;
+ImageSizeCache::Shard ImageSizeCache::mShards[ImageSizeCache::SHARD_COUNT];
+std::atomic<bool> ImageSizeCache::mDirty(false);
+
+uint64_t ImageSizeCache::hashPath(const std::string& path)
+{
+	uint64_t hash = Utils::String::hash64(path);
+	return hash == 0 ? 1 : hash;
+}
+
+bool ImageSizeCache::isCachablePath(const std::string& path)
+{
+	return
+		path.find("/themes/") == std::string::npos &&
+		path.find("/tmp/") == std::string::npos &&
+		path.find("/emulationstation.tmp/") == std::string::npos &&
+		path.find("/pdftmp/") == std::string::npos &&
+		path.find("/saves/") == std::string::npos;
+}
+
+const ImageSizeCache::Record* ImageSizeCache::Table::find(uint64_t hash) const
+{
+	uint32_t mask = capacity - 1;
+	uint32_t index = (uint32_t)hash & mask;
+
+	for (uint32_t i = 0; i < capacity; i++, index = (index + 1) & mask)
+	{
+		const Record* record = &records[index];
+		if (record->hash == hash)
+			return record;
+
+		if (record->hash == 0)
+			return nullptr;
+	}
+
+	return nullptr;
+}
+
+bool ImageSizeCache::get(const std::string& path, CachedFileInfo& info)
+{
+	uint64_t hash = hashPath(path);
+
+	Shard& shard = mShards[hash % SHARD_COUNT];
+	if (shard.count.load() > 0)
+	{
+		std::unique_lock<std::mutex> lock(shard.lock);
+
+		auto it = shard.items.find(hash);
+		if (it != shard.items.cend())
+		{
+			if (it->second.removed)
+				return false;
+
+			info = it->second.info;
+			return true;
+		}
+	}
+
+	Table* table = mTable.load(std::memory_order_acquire);
+	if (table == nullptr)
+		return false;
+
+	const Record* record = table->find(hash);
+	if (record == nullptr)
+		return false;
+
+	info.size = record->size;
+	info.x = record->x;
+	info.y = record->y;
+	return true;
+}
+
+void ImageSizeCache::set(const std::string& path, const CachedFileInfo& info)
+{
+	uint64_t hash = hashPath(path);
+
+	Shard& shard = mShards[hash % SHARD_COUNT];
+	std::unique_lock<std::mutex> lock(shard.lock);
+
+	bool changed = true;
+
+	auto it = shard.items.find(hash);
+	if (it != shard.items.cend())
+		changed = it->second.removed || it->second.info.size != info.size || it->second.info.x != info.x || it->second.info.y != info.y;
+	else
+	{
+		Table* table = mTable.load(std::memory_order_acquire);
+
+		const Record* record = (table == nullptr ? nullptr : table->find(hash));
+		if (record != nullptr)
+			changed = record->size != info.size || record->x != info.x || record->y != info.y;
+
+		shard.count++;
+	}
+
+	if (!changed)
+		return;
+
+	OverlayItem& item = shard.items[hash];
+	item.info = info;
+	item.removed = false;
+	item.cachable = isCachablePath(path);
+
+	if (info.size > 0 && info.x > 0 && item.cachable)
+		mDirty = true;
+}
+
+void ImageSizeCache::remove(const std::string& path)
+{
+	uint64_t hash = hashPath(path);
+
+	Shard& shard = mShards[hash % SHARD_COUNT];
+	std::unique_lock<std::mutex> lock(shard.lock);
+
+	auto it = shard.items.find(hash);
+	if (it == shard.items.cend())
+		shard.count++;
+
+	shard.items[hash].removed = true;
+}
+
+void ImageSizeCache::clear()
+{
+	mTable.store(nullptr, std::memory_order_release);
+
+	for (auto& shard : mShards)
+	{
+		std::unique_lock<std::mutex> lock(shard.lock);
+		shard.items.clear();
+		shard.count = 0;
+	}
+
+	mDirty = false;
+}
+
+void ImageSizeCache::load(const std::string& fileName)
+{
+	clear();
+
+	std::unique_ptr<Utils::MappedFile> file(new Utils::MappedFile(fileName));
+	if (file->data() == nullptr)
+		return;
+
+	Utils::BinaryReader reader(file->data(), file->size());
+	if (!reader.readMagic(IMAGECACHE_MAGIC))
+	{
+		// imagecache.db used to be a text file : convert it
+		if (loadLegacyFile(fileName))
+			mDirty = true;
+
+		return;
+	}
+
+	uint32_t version = reader.read<uint32_t>();
+	uint32_t capacity = reader.read<uint32_t>();
+	uint32_t count = reader.read<uint32_t>();
+
+	if (reader.failed() || version != IMAGECACHE_VERSION || capacity == 0 || (capacity & (capacity - 1)) != 0 || count > capacity ||
+		file->size() != IMAGECACHE_HEADER + (size_t)capacity * sizeof(Record))
+	{
+		LOG(LogWarning) << "ImageSizeCache : Invalid image cache, ignored";
+		return;
+	}
+
+	Table* table = new Table();
+	table->records = (const Record*)(file->data() + IMAGECACHE_HEADER);
+	table->capacity = capacity;
+	table->count = count;
+	table->file = std::move(file);
+
+	std::unique_lock<std::mutex> lock(mTablesLock);
+	mTables.push_back(std::unique_ptr<Table>(table));
+	mTable.store(table, std::memory_order_release);
+}
+
+bool ImageSizeCache::loadLegacyFile(const std::string& fileName)
+{
+	std::ifstream f(fileName.c_str());
+	if (f.fail())
+		return false;
+
+	std::string relativeTo = Paths::getRootPath();
+
+	std::vector<std::string> splits;
+
+	std::string line;
+	while (std::getline(f, line))
+	{
+		splits.clear();
+
+		const char* src = line.c_str();
+
+		while (true)
+		{
+			const char* d = strchr(src, '|');
+			size_t len = (d) ? d - src : strlen(src);
+
+			if (len)
+				splits.push_back(std::string(src, len)); // capture token
+
+			if (d) src += len + 1; else break;
+		}
+
+		if (splits.size() == 4)
+		{
+			std::string file = Utils::FileSystem::resolveRelativePath(splits[0], relativeTo, true);
+			set(file, CachedFileInfo(Utils::String::toInteger(splits[1]), Utils::String::toInteger(splits[2]), Utils::String::toInteger(splits[3])));
+		}
+	}
+
+	f.close();
+	return true;
+}
+
+void ImageSizeCache::save(const std::string& fileName)
+{
+	if (!mDirty)
+		return;
+
+	std::vector<Record> records;
+	std::unordered_map<uint64_t, bool> overridden;
+
+	for (auto& shard : mShards)
+	{
+		std::unique_lock<std::mutex> lock(shard.lock);
+
+		for (auto& item : shard.items)
+		{
+			overridden[item.first] = true;
+
+			if (item.second.removed || !item.second.cachable || item.second.info.size < 0)
+				continue;
+
+			Record record;
+			record.hash = item.first;
+			record.size = item.second.info.size;
+			record.x = item.second.info.x;
+			record.y = item.second.info.y;
+			records.push_back(record);
+		}
+	}
+
+	Table* table = mTable.load(std::memory_order_acquire);
+	if (table != nullptr)
+	{
+		for (uint32_t i = 0; i < table->capacity; i++)
+		{
+			const Record& record = table->records[i];
+			if (record.hash != 0 && overridden.find(record.hash) == overridden.cend())
+				records.push_back(record);
+		}
+	}
+
+	// Keep the load factor under 50%, so that probe sequences stay short
+	uint32_t capacity = 64;
+	while (capacity < records.size() * 2)
+		capacity <<= 1;
+
+	std::vector<Record> slots(capacity);
+	memset(slots.data(), 0, capacity * sizeof(Record));
+
+	uint32_t mask = capacity - 1;
+	for (auto& record : records)
+	{
+		uint32_t index = (uint32_t)record.hash & mask;
+		while (slots[index].hash != 0)
+			index = (index + 1) & mask;
+
+		slots[index] = record;
+	}
+
+	Utils::BinaryWriter writer;
+	writer.writeMagic(IMAGECACHE_MAGIC);
+	writer.write<uint32_t>(IMAGECACHE_VERSION);
+	writer.write<uint32_t>(capacity);
+	writer.write<uint32_t>((uint32_t)records.size());
+
+	for (auto& slot : slots)
+		writer.write<Record>(slot);
+
+	if (writer.save(fileName))
+		mDirty = false;
+	else
+		LOG(LogError) << "ImageSizeCache : Unable to write " << fileName;
+}
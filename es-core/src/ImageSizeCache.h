@@ -0,0 +1,94 @@
+#pragma once
+#ifndef ES_CORE_IMAGE_SIZE_CACHE_H
+#define ES_CORE_IMAGE_SIZE_CACHE_H
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace Utils
+{
+	class MappedFile;
+}
+
+struct CachedFileInfo
+{
+	CachedFileInfo() : size(0), x(0), y(0) { }
+	CachedFileInfo(int sz, int sx, int sy) : size(sz), x(sx), y(sy) { }
+
+	int size;	// < 0 when the image could not be read
+	int x;
+	int y;
+};
+
+// Image dimensions cache, stored in imagecache.db.
+// The file is an open-addressing hash table (path hash -> size & dimensions) that is mapped as is and never
+// modified : lookups in it take no lock. Changes made during the session go to a sharded overlay, and are
+// merged into a new table by save().
+class ImageSizeCache
+{
+public:
+	static bool get(const std::string& path, CachedFileInfo& info);
+	static void set(const std::string& path, const CachedFileInfo& info);
+	static void remove(const std::string& path);
+
+	static void load(const std::string& fileName);
+	static void save(const std::string& fileName);
+	static void clear();
+
+private:
+#pragma pack(push, 1)
+	struct Record
+	{
+		uint64_t	hash;	// 0 : empty slot
+		int32_t		size;
+		int32_t		x;
+		int32_t		y;
+	};
+#pragma pack(pop)
+
+	struct Table
+	{
+		std::unique_ptr<Utils::MappedFile> file;
+		const Record*	records;
+		uint32_t		capacity;	// Power of 2
+		uint32_t		count;
+
+		const Record* find(uint64_t hash) const;
+	};
+
+	struct OverlayItem
+	{
+		CachedFileInfo	info;
+		bool			removed;
+		bool			cachable;
+	};
+
+	struct Shard
+	{
+		Shard() : count(0) { }
+
+		std::mutex lock;
+		std::atomic<size_t> count;
+		std::unordered_map<uint64_t, OverlayItem> items;
+	};
+
+	static const int SHARD_COUNT = 16;
+
+	static uint64_t hashPath(const std::string& path);
+	static bool isCachablePath(const std::string& path);
+	static bool loadLegacyFile(const std::string& fileName);
+
+	static std::atomic<Table*> mTable;
+	static std::mutex mTablesLock;
+	static std::vector<std::unique_ptr<Table>> mTables;	// Tables are never freed before exit : lookups may still use them
+
+	static Shard mShards[SHARD_COUNT];
+	static std::atomic<bool> mDirty;
+};
+
+#endif // ES_CORE_IMAGE_SIZE_CACHE_H
@@ -13,6 +13,7 @@
 Settings* Settings::sInstance = NULL;
 static std::string mEmptyString = "";
 Delegate<ISettingsChangedEvent> Settings::settingChanged;
+std::atomic<unsigned int> Settings::sVersion(1);
 
 IMPLEMENT_STATIC_BOOL_SETTING(DebugText, false)
 IMPLEMENT_STATIC_BOOL_SETTING(DebugImage, false)
@@ -40,6 +41,8 @@ IMPLEMENT_STATIC_BOOL_SETTING(ShowNetworkIndicator, true)
 
 void Settings::updateCachedSetting(const std::string& name)
 {
+	sVersion++;
+
 	UPDATE_STATIC_BOOL_SETTING_EX("audio.bgmusic", BackgroundMusic)
 	UPDATE_STATIC_BOOL_SETTING(DebugText)
 	UPDATE_STATIC_BOOL_SETTING(DebugImage)
@@ -67,6 +70,7 @@ void Settings::updateCachedSetting(const std::string& name)
 // since they're set through command-line arguments, and not the in-program settings menu
 std::vector<const char*> settings_dont_save {
 	{ "Debug" },
+	{ "Headless" },
 	{ "DebugText" },
 	{ "DebugImage" },
 	{ "DebugGrid" },
@@ -188,6 +192,7 @@ void Settings::setDefaults()
 	mBoolMap["ShowNetworkIndicator"] = Settings::_ShowNetworkIndicator;
 
 	mBoolMap["Debug"] = false;
+	mBoolMap["Headless"] = false;
 
 	mBoolMap["InvertButtons"] = false;
 
@@ -325,10 +330,13 @@ void Settings::setDefaults()
 	mStringMap["DefaultGridSize"] = "";
 
 	mBoolMap["ThreadedLoading"] = true;
+	mBoolMap["GamelistSnapshots"] = true;
 	mBoolMap["AsyncImages"] = true;
 	mBoolMap["PreloadUI"] = false;
 	mBoolMap["PreloadMedias"] = Settings::_PreloadMedias;
 	mBoolMap["OptimizeVRAM"] = true;
+	mBoolMap["ThumbnailCache"] = true;
+	mBoolMap["CompressedTextures"] = false;
 	mBoolMap["OptimizeVideo"] = true;
 
 	mBoolMap["ShowFilenames"] = false;
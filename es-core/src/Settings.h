@@ -5,6 +5,7 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <atomic>
 #include "utils/Delegate.h"
 
 // Non-cached settings macros
@@ -93,6 +94,9 @@ public:
 	DEFINE_BOOL_SETTING(RemoveMultiDiskContent)	
 	DEFINE_BOOL_SETTING(ParseGamelistOnly)
 	DEFINE_BOOL_SETTING(ThreadedLoading)
+	DEFINE_BOOL_SETTING(GamelistSnapshots)
+	DEFINE_BOOL_SETTING(ThumbnailCache)
+	DEFINE_BOOL_SETTING(CompressedTextures)
 	DEFINE_BOOL_SETTING(CheevosCheckIndexesAtStart)
 	DEFINE_BOOL_SETTING(NetPlayCheckIndexesAtStart)
 	DEFINE_BOOL_SETTING(NetPlayShowMissingGames)			
@@ -105,8 +109,12 @@ public:
 
 	static Delegate<ISettingsChangedEvent> settingChanged;
 
+	// Changes each time a setting changes, so that values computed from settings know when they are outdated
+	static unsigned int getVersion() { return sVersion; }
+
 private:
 	static Settings* sInstance;
+	static std::atomic<unsigned int> sVersion;
 
 	Settings();
 
@@ -479,6 +479,18 @@ void Window::update(int deltaTime)
 
 			ss << "\nFont VRAM: " << fontVramUsageMb << " Tex VRAM: " << textureVramUsageMb << " Known Tex: " << textureTotalUsageMb << " Max VRAM: " << max_texture;
 
+			auto stats = TextureResource::getStats();
+			size_t requests = stats.hits + stats.misses;
+
+			ss << "\nTex RAM: " << stats.allocatedRAM / 1024.0f / 1024.0f << " Tex GPU: " << stats.allocatedVRAM / 1024.0f / 1024.0f
+				<< " Hits: " << (requests == 0 ? 100.0f : 100.0f * stats.hits / requests) << "%"
+				<< " Evicted: " << stats.evictions << " (" << stats.evictedBytes / 1024.0f / 1024.0f << ")"
+				<< " Loaded: " << stats.residentCount << " [" << stats.residentBySizeClass[0] << "/" << stats.residentBySizeClass[1] << "/" << stats.residentBySizeClass[2] << "/" << stats.residentBySizeClass[3] << "]";
+
+			auto renderStats = Renderer::getStatistics();
+			ss << "\nDraw calls: " << renderStats.drawCalls << " State changes: " << renderStats.stateChanges << " Batched: " << renderStats.batchedDraws
+				<< " Uploaded: " << renderStats.uploadedBytes / 1024.0f << " KB";
+
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(0)->buildTextCache(ss.str(), Vector2f(50.f, 50.f), 0xFFFF40FF, 0.0f, ALIGN_LEFT, 1.2f));			
 		}
 
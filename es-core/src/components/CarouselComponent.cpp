@@ -12,6 +12,7 @@
 // buffer values for scrolling velocity (left, stopped, right)
 const int logoBuffersLeft[] = { -5, -2, -1 };
 const int logoBuffersRight[] = { 1, 2, 5 };
+const int logoPrefetchCount = 5;
 
 CarouselComponent::CarouselComponent(Window* window) :
 	IList<CarouselComponentData, IBindable*>(window, LIST_SCROLL_STYLE_SLOW, LIST_ALWAYS_LOOP)
@@ -496,12 +497,18 @@ void CarouselComponent::renderCarousel(const Transform4x4f& trans)
 	};
 
 
+	int first = center - logoCount / 2 + bufferLeft;
+	int last = center + logoCount / 2 + bufferRight;
+
 	std::vector<int> activePositions;
-	for (int i = center - logoCount / 2 + bufferLeft; i <= center + logoCount / 2 + bufferRight; i++)
+	std::vector<int> drawnIndexes;
+	for (int i = first; i <= last; i++)
 	{
 		int index = i % (int)mEntries.size();
 		if (index < 0)
 			index += (int)mEntries.size();
+
+		drawnIndexes.push_back(index);
 	
 		if (index == mCursor)
 			activePositions.push_back(i);
@@ -511,6 +518,30 @@ void CarouselComponent::renderCarousel(const Transform4x4f& trans)
 	
 	for (auto activePos : activePositions)
 		renderLogo(activePos);
+
+	if (!isShowing())
+		return;
+
+	// Logos in the loading buffers are drawn, so their textures are already requested : load the next ones
+	// past both ends ahead, the nearest first. Small lists wrap around to logos that are drawn, these are skipped
+	for (int distance = 1; distance <= logoPrefetchCount; distance++)
+	{
+		for (int i : { first - distance, last + distance })
+		{
+			int index = i % (int)mEntries.size();
+			if (index < 0)
+				index += (int)mEntries.size();
+
+			if (std::find(drawnIndexes.cbegin(), drawnIndexes.cend(), index) != drawnIndexes.cend())
+				continue;
+
+			ensureLogo(mEntries.at(index));
+
+			ImageComponent* image = dynamic_cast<ImageComponent*>(mEntries.at(index).data.logo.get());
+			if (image != nullptr)
+				image->prefetch(distance);
+		}
+	}
 }
 
 void CarouselComponent::getCarouselFromTheme(const ThemeData::ThemeElement* elem)
@@ -1072,6 +1072,15 @@ void GridTileComponent::resetImages()
 	stopVideo();
 }
 
+void GridTileComponent::prefetch(int priority)
+{
+	if (mImage != nullptr)
+		mImage->prefetch(priority);
+
+	if (mMarquee != nullptr)
+		mMarquee->prefetch(priority);
+}
+
 void GridTileComponent::setLabel(std::string name)
 {
 	if (mLabel.getText() == name)
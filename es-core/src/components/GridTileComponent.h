@@ -215,6 +215,7 @@ public:
 	bool isSelected() const;
 
 	void resetImages();
+	void prefetch(int priority);
 
 	void setLabel(std::string name);
 	void setVideo(const std::string& path, float defaultDelay = -1.0);
@@ -85,12 +85,14 @@ protected:
 	const ListLoopType mLoopType;
 
 	std::vector<Entry> mEntries;
+	unsigned int mEntriesVersion; // Changes whenever an entry is added or removed
 	
 public:
 	IList(Window* window, const ScrollTierList& tierList = LIST_SCROLL_STYLE_QUICK, const ListLoopType& loopType = LIST_PAUSE_AT_END) : GuiComponent(window), 
 		mGradient(window), mTierList(tierList), mLoopType(loopType)
 	{
 		mCursor = 0;
+		mEntriesVersion = 0;
 		mScrollTier = 0;
 		mScrollVelocity = 0;
 		mScrollTierAccumulator = 0;
@@ -156,6 +158,7 @@ public:
 	virtual void clear()
 	{
 		mEntries.clear();
+		mEntriesVersion++;
 		mCursor = 0;
 		listInput(0);
 		onCursorChanged(CURSOR_STOPPED);
@@ -214,6 +217,7 @@ public:
 	void add(const Entry& e)
 	{
 		mEntries.push_back(e);
+		mEntriesVersion++;
 	}
 
 	bool remove(const UserData& obj)
@@ -252,6 +256,7 @@ protected:
 		int index = it - mEntries.cbegin();
 
 		mEntries.erase(it);
+		mEntriesVersion++;
 
 		if (mEntries.size() > 0 && (index <= mCursor || mCursor >= mEntries.size()))
 		{
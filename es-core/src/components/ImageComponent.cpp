@@ -985,6 +985,17 @@ void ImageComponent::onShow()
 	}
 }
 
+void ImageComponent::prefetch(int priority)
+{
+	if (mLoadingTexture != nullptr)
+	{
+		if (!mLoadingTexture->isLoaded())
+			mLoadingTexture->prefetch(priority);
+	}
+	else if (mTexture != nullptr && !mTexture->isLoaded())
+		mTexture->prefetch(priority);
+}
+
 void ImageComponent::onHide()
 {
 	if (mTexture)
@@ -100,6 +100,9 @@ public:
 
 	std::shared_ptr<TextureResource> getTexture() { return mTexture; };
 
+	// Loads the image before it gets displayed, the lowest priorities first (see TextureResource::prefetch)
+	void prefetch(int priority);
+
 	const MaxSizeInfo getMaxSizeInfo();
 	void setHorizontalAlignment(Alignment align) { mHorizontalAlignment = align; }
 	void setVerticalAlignment(Alignment align) { mVerticalAlignment = align; }
@@ -13,6 +13,7 @@
 #include "LocaleES.h"
 #include "components/ScrollbarComponent.h"
 #include <set>
+#include <unordered_set>
 #include "InputManager.h"
 #include "utils/Delegate.h"
 #include "BindingManager.h"
@@ -64,6 +65,7 @@ class ImageGridComponent : public IList<ImageGridData, T>
 {
 protected:
 	using IList<ImageGridData, T>::mEntries;
+	using IList<ImageGridData, T>::mEntriesVersion;
 	using IList<ImageGridData, T>::mScrollTier;
 	using IList<ImageGridData, T>::listUpdate;
 	using IList<ImageGridData, T>::listInput;
@@ -145,9 +147,12 @@ private:
 	void		calcGridDimension();
 	
 	void		ensureVisibleTileExist();
+	void		prefetchTile(const std::shared_ptr<GridTileComponent>& tile, int index, const Vector2i& range, int dimOpposite);
 	Vector2i	getVisibleRange();
 	void		loadTile(std::shared_ptr<GridTileComponent> tile, typename IList<ImageGridData, T>::Entry& entry);
 	std::shared_ptr<GridTileComponent> createTile(int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition);
+	void		recycleTile(const std::shared_ptr<GridTileComponent>& tile);
+	void		updateTileEntries();
 
 	inline bool isVertical() { return mScrollDirection == SCROLL_VERTICALLY; };
 
@@ -155,6 +160,7 @@ private:
 
 	int mLastCursor;
 	CursorState mLastCursorState;
+	bool mScrollingForward;
 
 	std::string mDefaultGameTexture;
 	std::string mDefaultFolderTexture;
@@ -162,6 +168,14 @@ private:
 
 	std::vector<std::shared_ptr<GridTileComponent>> mVisibleTiles;
 
+	// Entries holding a tile. Rebuilt when entries are added or removed, as indexes change
+	std::unordered_set<int> mTileEntries;
+	unsigned int mTileEntriesVersion;
+	bool mTileEntriesValid;
+
+	// Tiles released by entries far from the visible range, reused for the entries coming in
+	std::vector<std::shared_ptr<GridTileComponent>> mTilePool;
+
 	// TILES
 	bool mLastRowPartial;
 	bool mAnimateSelection;
@@ -246,9 +260,6 @@ Vector2i ImageGridComponent<T>::getVisibleRange()
 template<typename T>
 std::shared_ptr<GridTileComponent> ImageGridComponent<T>::createTile(int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition)
 {
-	// Create tiles
-	auto tile = std::make_shared<GridTileComponent>(mWindow);
-
 	int X = i % (int)dimOpposite;
 	int Y = i / (int)dimOpposite;
 
@@ -261,6 +272,20 @@ std::shared_ptr<GridTileComponent> ImageGridComponent<T>::createTile(int i, int
 	if (!isVertical())
 		std::swap(X, Y);
 
+	// Pooled tiles already have the size & the theme of the grid
+	if (!mTilePool.empty())
+	{
+		auto tile = mTilePool.back();
+		mTilePool.pop_back();
+
+		tile->setPosition(X * tileDistance.x() + startPosition.x(), Y * tileDistance.y() + startPosition.y());
+		tile->setVisible(true);
+		return tile;
+	}
+
+	// Create tiles
+	auto tile = std::make_shared<GridTileComponent>(mWindow);
+
 	tile->setOrigin(0.5f, 0.5f);
 	tile->setPosition(X * tileDistance.x() + startPosition.x(), Y * tileDistance.y() + startPosition.y());
 	tile->setSize(mTileSize);
@@ -274,9 +299,45 @@ std::shared_ptr<GridTileComponent> ImageGridComponent<T>::createTile(int i, int
 	return tile;
 }
 
+template<typename T>
+void ImageGridComponent<T>::recycleTile(const std::shared_ptr<GridTileComponent>& tile)
+{
+	if (tile->isSelected())
+		tile->setSelected(false, false, nullptr, true);
+
+	if (tile->isShowing())
+		tile->onHide();
+
+	tile->setVisible(false);
+	tile->resetImages();
+
+	// Enough tiles for a whole screen
+	if (mTilePool.size() < mGridDimension.x() * mGridDimension.y())
+		mTilePool.push_back(tile);
+}
+
+template<typename T>
+void ImageGridComponent<T>::updateTileEntries()
+{
+	if (mTileEntriesValid && mTileEntriesVersion == mEntriesVersion)
+		return;
+
+	mTileEntries.clear();
+
+	for (int i = 0; i < mEntries.size(); i++)
+		if (mEntries[i].data.tile != nullptr)
+			mTileEntries.insert(i);
+
+	mTileEntriesVersion = mEntriesVersion;
+	mTileEntriesValid = true;
+}
+
 template<typename T>
 void ImageGridComponent<T>::preloadTiles()
 {
+	if (mEntries.size() == 0)
+		return;
+
 	int dimOpposite = Math::max(1, isVertical() ? mGridDimension.x() : mGridDimension.y());
 
 	Vector2f startPosition = mTileSize / 2;
@@ -284,7 +345,16 @@ void ImageGridComponent<T>::preloadTiles()
 
 	Vector2f tileDistance = mTileSize + mMargin;
 
-	for (int i = 0; i < mEntries.size(); i++)
+	updateTileEntries();
+
+	// Entries farther than a screen from the visible range are loaded when they come closer
+	auto range = getVisibleRange();
+	int margin = range.y() - range.x() + 1;
+
+	int from = Math::max(0, range.x() - margin);
+	int to = Math::min((int)mEntries.size() - 1, range.y() + margin);
+
+	for (int i = from; i <= to; i++)
 	{
 		typename IList<ImageGridData, T>::Entry& entry = mEntries[i];
 		if (entry.data.tile != nullptr)
@@ -296,6 +366,7 @@ void ImageGridComponent<T>::preloadTiles()
 		loadTile(tile, entry);
 		
 		entry.data.tile = tile;
+		mTileEntries.insert(i);
 	}
 }
 
@@ -325,13 +396,18 @@ void ImageGridComponent<T>::ensureVisibleTileExist()
 	Vector2f startPosition = mTileSize / 2;
 	startPosition += Vector2f(mPadding.x(), mPadding.y());
 
-	auto oldScrollLoopTiles = mScrollLoopTiles;	
-	mScrollLoopTiles.clear();
+	updateTileEntries();
+
+	std::map<int, std::shared_ptr<GridTileComponent>> oldScrollLoopTiles;
+	oldScrollLoopTiles.swap(mScrollLoopTiles);
+
+	// Only the entries of the visible range are visited, then the ones holding a tile outside of it
+	int from = mScrollLoop ? range.x() : startIndex;
+	int to = mScrollLoop ? range.y() : endIndex;
 
-	int from = mScrollLoop ? Math::min(range.x(), 0) : 0;
-	int to = mScrollLoop ? Math::max(range.y(), mEntries.size()) : mEntries.size();
+	std::unordered_set<int> visibleEntries;
 
-	for (int idx = from; idx < to; idx++)
+	for (int idx = from; idx <= to; idx++)
 	{
 		int i = idx;
 
@@ -357,73 +433,138 @@ void ImageGridComponent<T>::ensureVisibleTileExist()
 
 		typename IList<ImageGridData, T>::Entry& entry = mEntries[i];
 
-		if ((mScrollLoop && idx >= range.x() && idx <= range.y()) || (!mScrollLoop && i >= startIndex && i <= endIndex))
+		visibleEntries.insert(i);
+
+		if (entry.data.tile == nullptr)
 		{
-			if (entry.data.tile == nullptr)
-			{
-				// Create tiles
-				auto tile = createTile(i, dimOpposite, tileDistance, startPosition);
-				loadTile(tile, entry);
+			// Create tiles
+			auto tile = createTile(i, dimOpposite, tileDistance, startPosition);
+			loadTile(tile, entry);
 
-				entry.data.tile = tile;
+			entry.data.tile = tile;
+			mTileEntries.insert(i);
 
-				if (tile->isVisible())
-					mVisibleTiles.push_back(tile);
+			if (tile->isVisible())
+				mVisibleTiles.push_back(tile);
 
-				if (mCursor == i)
+			if (mCursor == i)
+			{
+				auto curTile = getSelectedTile();
+				while (curTile != nullptr)
 				{
-					auto curTile = getSelectedTile();
-					while (curTile != nullptr)
-					{
-						curTile->setSelected(false, false, nullptr, true);
-						curTile = getSelectedTile();
-					}
-
-					mLastCursor = mCursor;
-					tile->setSelected(true, true, nullptr, true);
+					curTile->setSelected(false, false, nullptr, true);
+					curTile = getSelectedTile();
 				}
 
-				if (mShowing)
-					tile->onShow();
+				mLastCursor = mCursor;
+				tile->setSelected(true, true, nullptr, true);
 			}
-			else if (!entry.data.tile->isVisible())
-			{
-				loadTile(entry.data.tile, entry);
-				entry.data.tile->setVisible(true);
 
-				mVisibleTiles.push_back(entry.data.tile);
+			if (mShowing)
+				tile->onShow();
+		}
+		else if (!entry.data.tile->isVisible())
+		{
+			loadTile(entry.data.tile, entry);
+			entry.data.tile->setVisible(true);
 
-				if (mShowing)
-					entry.data.tile->onShow();
-			}
+			mVisibleTiles.push_back(entry.data.tile);
 
-			if (mScrollLoop && i < startIndex || i > endIndex)
+			if (mShowing)
+				entry.data.tile->onShow();
+		}
+
+		if (mScrollLoop && i < startIndex || i > endIndex)
+		{
+			auto it = oldScrollLoopTiles.find(idx);
+			if (it != oldScrollLoopTiles.cend())
+			{
+				mScrollLoopTiles[idx] = it->second;
+				oldScrollLoopTiles.erase(it);
+			}
+			else
 			{
 				auto tile = createTile(idx, dimOpposite, tileDistance, startPosition);
 				loadTile(tile, entry);
 				mScrollLoopTiles[idx] = tile;
 			}
 		}
-		else if (entry.data.tile != nullptr)
+
+		if (mShowing && entry.data.tile != nullptr)
+			prefetchTile(entry.data.tile, idx, range, dimOpposite);
+	}
+
+	for (auto scrollLoopTile : oldScrollLoopTiles)
+		recycleTile(scrollLoopTile.second);
+
+	// Tiles within a screen of the visible range are kept hidden for when the user scrolls back, the others are recycled
+	int margin = to - from + 1;
+
+	for (auto it = mTileEntries.begin(); it != mTileEntries.end(); )
+	{
+		int i = *it;
+		if (visibleEntries.find(i) != visibleEntries.cend())
+		{
+			it++;
+			continue;
+		}
+
+		typename IList<ImageGridData, T>::Entry& entry = mEntries[i];
+		if (entry.data.tile == nullptr)
 		{
-			if (entry.data.tile->isVisible())
-				entry.data.tile->setVisible(false);
+			it = mTileEntries.erase(it);
+			continue;
+		}
 
-			auto it = std::find(mVisibleTiles.cbegin(), mVisibleTiles.cend(), entry.data.tile);
-			if (it != mVisibleTiles.cend())
-				mVisibleTiles.erase(it);
+		if (entry.data.tile->isVisible())
+			entry.data.tile->setVisible(false);
 
-			if (!mShowing)
-			{				
-				entry.data.tile->resetImages();
-				entry.data.tile = nullptr;
-			}
-			else if (entry.data.tile->isShowing())
-				entry.data.tile->onHide();
+		auto vt = std::find(mVisibleTiles.cbegin(), mVisibleTiles.cend(), entry.data.tile);
+		if (vt != mVisibleTiles.cend())
+			mVisibleTiles.erase(vt);
+
+		if (!mShowing || i < startIndex - margin || i > endIndex + margin)
+		{
+			recycleTile(entry.data.tile);
+			entry.data.tile = nullptr;
+			it = mTileEntries.erase(it);
+			continue;
 		}
+
+		if (entry.data.tile->isShowing())
+			entry.data.tile->onHide();
+
+		it++;
 	}
 }
 
+template<typename T>
+void ImageGridComponent<T>::prefetchTile(const std::shared_ptr<GridTileComponent>& tile, int index, const Vector2i& range, int dimOpposite)
+{
+	// The EXTRAITEMS rows before & after the screen are loaded ahead of time, the ones in the scrolling direction first.
+	// Tiles on screen are loaded when they are drawn
+	int row = (index - range.x()) / dimOpposite;
+	int lastRow = (range.y() - range.x()) / dimOpposite - 1;
+
+	int distance;
+	bool ahead;
+
+	if (row < EXTRAITEMS)
+	{
+		distance = EXTRAITEMS - row;
+		ahead = !mScrollingForward;
+	}
+	else if (row > lastRow - EXTRAITEMS)
+	{
+		distance = row - lastRow + EXTRAITEMS;
+		ahead = mScrollingForward;
+	}
+	else
+		return;
+
+	tile->prefetch(ahead ? distance : distance + EXTRAITEMS + 1);
+}
+
 template<typename T>
 ImageGridComponent<T>::ImageGridComponent(Window* window) : IList<ImageGridData, T>(window), mScrollbar(window)
 {
@@ -446,9 +587,11 @@ ImageGridComponent<T>::ImageGridComponent(Window* window) : IList<ImageGridData,
 	mName = "grid";
 	mStartPosition = 0;
 	mEntriesDirty = true;
+	mTileEntriesValid = false;
 
 	mLastCursor = -1;
 	mLastCursorState = CursorState::CURSOR_STOPPED;
+	mScrollingForward = true;
 
 	mDefaultGameTexture = ":/cartridge.svg";
 	mDefaultFolderTexture = ":/folder.svg";
@@ -1091,6 +1234,8 @@ void ImageGridComponent<T>::onCursorChanged(const CursorState& state)
 		}
 	}
 
+	mScrollingForward = direction;
+
 	int oldStart = mStartPosition;
 
 	float dimScrollable = isVertical() ? mGridDimension.y() - 2 * EXTRAITEMS : mGridDimension.x() - 2 * EXTRAITEMS;
@@ -1377,6 +1522,8 @@ template<typename T>
 void ImageGridComponent<T>::resetGrid()
 {
 	mVisibleTiles.clear();
+	mTilePool.clear();
+	mTileEntriesValid = false;
 
 	if (mGridSizeOverride.x() != 0 && mGridSizeOverride.y() != 0)
 		mAutoLayout = mGridSizeOverride;
@@ -3,6 +3,7 @@
 #include "Renderer_GL21.h"
 #include "Renderer_GLES10.h"
 #include "Renderer_GLES20.h"
+#include "Renderer_Null.h"
 
 #include "math/Transform4x4f.h"
 #include "math/Vector2i.h"
@@ -796,6 +797,9 @@ namespace Renderer
 
 	static IRenderer* createRenderer()
 	{
+		if (Settings::getInstance()->getBool("Headless"))
+			return new NullRenderer();
+
 		IRenderer* instance = getRendererFromName(Settings::getInstance()->getString("Renderer"));
 		if (instance == nullptr)
 		{
@@ -877,6 +881,16 @@ namespace Renderer
 		Instance()->bindTexture(_texture);
 	}
 
+	bool supportsTextureType(const Texture::Type _type)
+	{
+		return Instance()->supportsTextureType(_type);
+	}
+
+	unsigned int createCompressedTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, const void* _data, const size_t _length)
+	{
+		return Instance()->createCompressedTexture(_type, _linear, _repeat, _width, _height, _data, _length);
+	}
+
 	void drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
 		Instance()->drawLines(_vertices, _numVertices, _srcBlendFactor, _dstBlendFactor);
@@ -971,6 +985,11 @@ namespace Renderer
 		return Instance()->getTotalMemUsage();
 	}
 
+	Statistics getStatistics()
+	{
+		return Instance()->getStatistics();
+	}
+
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	bool  ScreenSettings::isSmallScreen()
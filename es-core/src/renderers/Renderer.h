@@ -37,8 +37,10 @@ namespace Renderer
 	{
 		enum Type
 		{
-			RGBA  = 0,
-			ALPHA = 1
+			RGBA      = 0,
+			ALPHA     = 1,
+			ETC2_RGB  = 2, // GL_COMPRESSED_RGB8_ETC2
+			ETC2_RGBA = 3  // GL_COMPRESSED_RGBA8_ETC2_EAC
 
 		}; // Type
 
@@ -58,6 +60,18 @@ namespace Renderer
 
 	}; // Rect
 
+	// Counters of the last rendered frame
+	struct Statistics
+	{
+		Statistics() : drawCalls(0), stateChanges(0), batchedDraws(0), uploadedBytes(0) { }
+
+		unsigned int drawCalls;
+		unsigned int stateChanges; // Program, texture & blending changes
+		unsigned int batchedDraws; // Draws merged with others before being submitted
+		size_t		 uploadedBytes; // Vertices & texture pixels
+
+	}; // Statistics
+
 	struct ShaderInfo
 	{
 		std::string path;
@@ -116,6 +130,9 @@ namespace Renderer
 		virtual void         updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data) = 0;
 		virtual void         bindTexture(const unsigned int _texture) = 0;
 
+		virtual bool         supportsTextureType(const Texture::Type _type) { return _type == Texture::RGBA || _type == Texture::ALPHA; }
+		virtual unsigned int createCompressedTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, const void* _data, const size_t _length) { return 0; }
+
 		virtual void         drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA) = 0;
 		virtual void         drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA, bool verticesChanged = true) = 0;
 		virtual void		 drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA) = 0;
@@ -136,6 +153,7 @@ namespace Renderer
 		virtual void		 postProcessShader(const std::string& path, const float _x, const float _y, const float _w, const float _h, const std::map<std::string, std::string>& parameters, unsigned int* data = nullptr) { };
 
 		virtual size_t		 getTotalMemUsage() { return (size_t) -1; };
+		virtual Statistics	 getStatistics() { return Statistics(); };
 
 		virtual bool		 supportShaders() { return false; }
 		virtual bool		 shaderSupportsCornerSize(const std::string& shader) { return false; };
@@ -189,6 +207,8 @@ namespace Renderer
 	void         destroyTexture    (const unsigned int _texture);
 	void         updateTexture     (const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data);
 	void         bindTexture       (const unsigned int _texture);
+	bool         supportsTextureType(const Texture::Type _type);
+	unsigned int createCompressedTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, const void* _data, const size_t _length);
 	void         drawLines         (const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA);
 	void         drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor = Blend::SRC_ALPHA, const Blend::Factor _dstBlendFactor = Blend::ONE_MINUS_SRC_ALPHA, bool verticesChanged = true);
 	void		 drawSolidRectangle(const float _x, const float _y, const float _w, const float _h, const unsigned int _fillColor, const unsigned int _borderColor, float borderWidth = 1, float cornerRadius = 0);
@@ -204,6 +224,7 @@ namespace Renderer
 	void		 postProcessShader (const std::string& path, const float _x, const float _y, const float _w, const float _h, const std::map<std::string, std::string>& parameters, unsigned int* data = nullptr);
 
 	size_t		 getTotalMemUsage  ();
+	Statistics	 getStatistics     ();
 
 	bool		 supportShaders();
 	bool		 shaderSupportsCornerSize(const std::string& shader);
@@ -28,6 +28,7 @@ namespace Renderer
 	{
 		GLenum type;
 		Vector2f size;
+		size_t length; // Compressed textures only
 	};
 
 	static SDL_GLContext	sdlContext       = nullptr;
@@ -45,6 +46,14 @@ namespace Renderer
 	static std::map<unsigned int, TextureInfo*> _textures;
 
 	static unsigned int		boundTexture = 0;
+	static TextureInfo*		boundTextureInfo = nullptr;
+	static bool				boundTextureInfoValid = false;
+
+	static Statistics		frameStatistics;
+	static Statistics		lastFrameStatistics;
+
+	static bool				supportsETC2RGB  = false;
+	static bool				supportsETC2RGBA = false;
 
 	extern std::string SHADER_VERSION_STRING;
 
@@ -52,12 +61,12 @@ namespace Renderer
 
 	static ShaderProgram* currentProgram = nullptr;
 	
-	static void useProgram(ShaderProgram* program)
+	static void useProgram(ShaderProgram* program, Transform4x4f& matrix = mvpMatrix)
 	{
 		if (program == currentProgram)
 		{
 			if (currentProgram != nullptr)
-				currentProgram->setMatrix(mvpMatrix);
+				currentProgram->setMatrix(matrix);
 
 			return;
 		}
@@ -70,7 +79,9 @@ namespace Renderer
 		if (currentProgram != nullptr)
 		{
 			currentProgram->select();
-			currentProgram->setMatrix(mvpMatrix);
+			currentProgram->setMatrix(matrix);
+
+			frameStatistics.stateChanges++;
 		}
 	}
 
@@ -363,13 +374,57 @@ namespace Renderer
 
 //////////////////////////////////////////////////////////////////////////
 
+	// The vertex buffer is used as a ring : every draw writes its vertices after the previous ones with glBufferSubData,
+	// and the storage is orphaned when the end is reached, so the driver never waits for pending draws to complete
+	#define VERTEX_RING_SIZE 16384
+
+	static unsigned int		vertexRingPosition = 0;
+	static bool				vertexRingAllocated = false;
+
+	static const Vertex*	lastUploadSource = nullptr;
+	static GLint			lastUploadFirst = 0;
+
 	static void setupVertexBuffer()
 	{
 		GL_CHECK_ERROR(glGenBuffers(1, &vertexBuffer));
 		GL_CHECK_ERROR(glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer));
 
+		vertexRingPosition = 0;
+		vertexRingAllocated = false;
+		lastUploadSource = nullptr;
+
 	} // setupVertexBuffer
 
+	// Returns the index of the first uploaded vertex, to pass to glDrawArrays
+	static GLint uploadVertices(const Vertex* _vertices, const unsigned int _numVertices)
+	{
+		lastUploadSource = _vertices;
+		frameStatistics.uploadedBytes += sizeof(Vertex) * _numVertices;
+
+		if (_numVertices > VERTEX_RING_SIZE)
+		{
+			// Too large for the ring : the storage is replaced, and reallocated by the next upload
+			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_STREAM_DRAW));
+			vertexRingAllocated = false;
+			lastUploadFirst = 0;
+			return lastUploadFirst;
+		}
+
+		if (!vertexRingAllocated || vertexRingPosition + _numVertices > VERTEX_RING_SIZE)
+		{
+			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * VERTEX_RING_SIZE, nullptr, GL_STREAM_DRAW));
+			vertexRingAllocated = true;
+			vertexRingPosition = 0;
+		}
+
+		GL_CHECK_ERROR(glBufferSubData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertexRingPosition, sizeof(Vertex) * _numVertices, _vertices));
+
+		lastUploadFirst = vertexRingPosition;
+		vertexRingPosition += _numVertices;
+		return lastUploadFirst;
+
+	} // uploadVertices
+
 //////////////////////////////////////////////////////////////////////////
 
 	static GLenum convertBlendFactor(const Blend::Factor _blendFactor)
@@ -408,6 +463,177 @@ namespace Renderer
 
 	} // convertTextureType
 
+//////////////////////////////////////////////////////////////////////////
+
+	#ifndef GL_COMPRESSED_RGB8_ETC2
+	#define GL_COMPRESSED_RGB8_ETC2 0x9274
+	#endif
+
+	#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+	#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+	#endif
+
+	static GLenum convertCompressedTextureType(const Texture::Type _type)
+	{
+		switch(_type)
+		{
+			case Texture::ETC2_RGB:  { return GL_COMPRESSED_RGB8_ETC2;      } break;
+			case Texture::ETC2_RGBA: { return GL_COMPRESSED_RGBA8_ETC2_EAC; } break;
+			default:                 { return GL_ZERO;                      }
+		}
+
+	} // convertCompressedTextureType
+
+//////////////////////////////////////////////////////////////////////////
+
+	static bool				blendEnabled = false;
+	static Blend::Factor	blendSrcFactor = Blend::ONE;
+	static Blend::Factor	blendDstFactor = Blend::ZERO;
+
+	static void setBlendState(const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		if (_srcBlendFactor == Blend::ONE || _dstBlendFactor == Blend::ONE)
+		{
+			if (blendEnabled)
+			{
+				GL_CHECK_ERROR(glDisable(GL_BLEND));
+				blendEnabled = false;
+				frameStatistics.stateChanges++;
+			}
+
+			return;
+		}
+
+		if (!blendEnabled)
+		{
+			GL_CHECK_ERROR(glEnable(GL_BLEND));
+			blendEnabled = true;
+			frameStatistics.stateChanges++;
+		}
+
+		if (blendSrcFactor != _srcBlendFactor || blendDstFactor != _dstBlendFactor)
+		{
+			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
+			blendSrcFactor = _srcBlendFactor;
+			blendDstFactor = _dstBlendFactor;
+			frameStatistics.stateChanges++;
+		}
+
+	} // setBlendState
+
+	static void resetBlendState()
+	{
+		GL_CHECK_ERROR(glDisable(GL_BLEND));
+		GL_CHECK_ERROR(glBlendFunc(GL_ONE, GL_ZERO));
+
+		blendEnabled = false;
+		blendSrcFactor = Blend::ONE;
+		blendDstFactor = Blend::ZERO;
+
+	} // resetBlendState
+
+	static void drawArrays(const GLenum _mode, const GLint _first, const GLsizei _count)
+	{
+		GL_CHECK_ERROR(glDrawArrays(_mode, _first, _count));
+		frameStatistics.drawCalls++;
+
+	} // drawArrays
+
+//////////////////////////////////////////////////////////////////////////
+
+	// Consecutive triangle strips using the same program, blend factors & saturation are merged into one strip, joined
+	// by degenerate triangles, and drawn with a single call. A texture change flushes the batch (see bindTexture).
+	// Vertices are transformed on the CPU, so a batch can span several setMatrix calls : it is drawn with the projection only.
+	struct VertexBatch
+	{
+		ShaderProgram*		program;
+		Blend::Factor		srcBlendFactor;
+		Blend::Factor		dstBlendFactor;
+		float				saturation;
+		std::vector<Vertex> vertices;
+	};
+
+	static VertexBatch batch;
+
+	static bool flushBatch()
+	{
+		if (batch.vertices.empty())
+			return false;
+
+		GLint first = uploadVertices(batch.vertices.data(), batch.vertices.size());
+
+		useProgram(batch.program, projectionMatrix);
+
+		if (batch.program == &shaderProgramColorTexture)
+		{
+			batch.program->setSaturation(batch.saturation);
+			batch.program->setCornerRadius(0.0f);
+		}
+
+		setBlendState(batch.srcBlendFactor, batch.dstBlendFactor);
+		drawArrays(GL_TRIANGLE_STRIP, first, batch.vertices.size());
+
+		batch.vertices.clear();
+		return true;
+
+	} // flushBatch
+
+	static void addToBatch(const Vertex* _vertices, const unsigned int _numVertices, ShaderProgram* _program, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, const float _saturation)
+	{
+		if (!batch.vertices.empty() && (batch.program != _program || batch.srcBlendFactor != _srcBlendFactor || batch.dstBlendFactor != _dstBlendFactor ||
+			batch.saturation != _saturation || batch.vertices.size() + _numVertices + 2 > VERTEX_RING_SIZE))
+			flushBatch();
+
+		size_t degenerate = batch.vertices.size();
+
+		if (batch.vertices.empty())
+		{
+			batch.program = _program;
+			batch.srcBlendFactor = _srcBlendFactor;
+			batch.dstBlendFactor = _dstBlendFactor;
+			batch.saturation = _saturation;
+		}
+		else
+		{
+			// Repeat the last vertex of the batch & the first vertex of the strip
+			batch.vertices.push_back(batch.vertices.back());
+			batch.vertices.push_back(Vertex());
+		}
+
+		size_t start = batch.vertices.size();
+		batch.vertices.resize(start + _numVertices);
+
+		const float* tm = (const float*)&worldViewMatrix;
+
+		for (unsigned int i = 0; i < _numVertices; i++)
+		{
+			const Vector2f& pos = _vertices[i].pos;
+
+			Vertex& vertex = batch.vertices[start + i];
+			vertex = _vertices[i];
+			vertex.pos = Vector2f(tm[0] * pos.x() + tm[4] * pos.y() + tm[12], tm[1] * pos.x() + tm[5] * pos.y() + tm[13]);
+		}
+
+		if (degenerate != start)
+			batch.vertices[degenerate + 1] = batch.vertices[start];
+
+		frameStatistics.batchedDraws++;
+
+	} // addToBatch
+
+	static TextureInfo* getBoundTextureInfo()
+	{
+		if (!boundTextureInfoValid)
+		{
+			auto it = _textures.find(boundTexture);
+			boundTextureInfo = (it == _textures.cend() ? nullptr : it->second);
+			boundTextureInfoValid = true;
+		}
+
+		return boundTextureInfo;
+
+	} // getBoundTextureInfo
+
 //////////////////////////////////////////////////////////////////////////
 
 	#ifndef GL_GPU_MEM_INFO_CURRENT_AVAILABLE_MEM_NVX
@@ -562,12 +788,34 @@ namespace Renderer
 
 		LOG(LogInfo) << " ARB_texture_non_power_of_two: " << (extensions.find("ARB_texture_non_power_of_two") != std::string::npos ? "ok" : "MISSING");
 
+#if defined(USE_OPENGLES_20)
+		// ETC2 is core in OpenGL ES 3.0, but many ES 2.0 drivers (Mali...) also list it in their compressed formats
+		GLint formatCount = 0;
+		glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &formatCount);
+		if (formatCount > 0)
+		{
+			std::vector<GLint> formats(formatCount);
+			glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+
+			for (auto format : formats)
+			{
+				if (format == GL_COMPRESSED_RGB8_ETC2)
+					supportsETC2RGB = true;
+				else if (format == GL_COMPRESSED_RGBA8_ETC2_EAC)
+					supportsETC2RGBA = true;
+			}
+		}
+
+		LOG(LogInfo) << " ETC2 compressed textures: " << (supportsETC2RGB && supportsETC2RGBA ? "ok" : (supportsETC2RGB ? "RGB only" : "MISSING"));
+#endif
+
 #if OPENGL_EXTENSIONS
 		initializeGlExtensions();
 #endif
 
 		setupDefaultShaders();
 		setupVertexBuffer();
+		resetBlendState();
 
 		GL_CHECK_ERROR(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
 
@@ -586,6 +834,7 @@ namespace Renderer
 
 	void GLES20Renderer::resetCache()
 	{
+		flushBatch();
 		bindTexture(0);
 
 		for (auto customShader : _customShaderBatch)
@@ -635,6 +884,8 @@ namespace Renderer
 		unsigned int texture = -1;
 		GL_CHECK_ERROR(glGenTextures(1, &texture));
 
+		boundTextureInfoValid = false;
+
 		if (texture == -1)
 		{
 			LOG(LogError) << "CreateTexture error: glGenTextures failed ";
@@ -669,6 +920,8 @@ namespace Renderer
 			glTexImage2D(GL_TEXTURE_2D, 0, type, _width, _height, 0, type, GL_UNSIGNED_BYTE, la_data);
 			delete[] la_data;
 
+			frameStatistics.uploadedBytes += _width * _height * 2;
+
 			if (glGetError() != GL_NO_ERROR)
 			{
 				LOG(LogError) << "CreateTexture error: glTexImage2D failed";
@@ -687,6 +940,9 @@ namespace Renderer
 				destroyTexture(texture);
 				return 0;
 			}
+
+			if (_data != nullptr)
+				frameStatistics.uploadedBytes += _width * _height * (type == GL_ALPHA ? 1 : 4);
 		}
 
 		if (texture != 0)
@@ -696,12 +952,14 @@ namespace Renderer
 			{
 				it->second->type = type;
 				it->second->size = Vector2f(_width, _height);
+				it->second->length = 0;
 			}
 			else
 			{
 				auto info = new TextureInfo();
 				info->type = type;
 				info->size = Vector2f(_width, _height);
+				info->length = 0;
 				_textures[texture] = info;
 			}
 		}
@@ -710,10 +968,80 @@ namespace Renderer
 
 	} // createTexture
 
+//////////////////////////////////////////////////////////////////////////
+
+	bool GLES20Renderer::supportsTextureType(const Texture::Type _type)
+	{
+		switch (_type)
+		{
+			case Texture::ETC2_RGB:  { return supportsETC2RGB;  } break;
+			case Texture::ETC2_RGBA: { return supportsETC2RGBA; } break;
+			default:                 { return IRenderer::supportsTextureType(_type); }
+		}
+
+	} // supportsTextureType
+
+//////////////////////////////////////////////////////////////////////////
+
+	unsigned int GLES20Renderer::createCompressedTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, const void* _data, const size_t _length)
+	{
+#if defined(USE_OPENGLES_20)
+		if (!supportsTextureType(_type) || _data == nullptr)
+			return 0;
+
+		const GLenum format = convertCompressedTextureType(_type);
+
+		unsigned int texture = 0;
+		GL_CHECK_ERROR(glGenTextures(1, &texture));
+
+		boundTextureInfoValid = false;
+
+		if (texture == 0)
+		{
+			LOG(LogError) << "CreateCompressedTexture error: glGenTextures failed ";
+			return 0;
+		}
+
+		bindTexture(0);
+		bindTexture(texture);
+
+		GL_CHECK_ERROR(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE));
+		GL_CHECK_ERROR(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE));
+
+		GL_CHECK_ERROR(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+		GL_CHECK_ERROR(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _linear ? GL_LINEAR : GL_NEAREST));
+
+		glCompressedTexImage2D(GL_TEXTURE_2D, 0, format, _width, _height, 0, _length, _data);
+		frameStatistics.uploadedBytes += _length;
+		if (glGetError() != GL_NO_ERROR)
+		{
+			LOG(LogError) << "CreateCompressedTexture error: glCompressedTexImage2D failed";
+			destroyTexture(texture);
+			return 0;
+		}
+
+		auto info = new TextureInfo();
+		info->type = format;
+		info->size = Vector2f(_width, _height);
+		info->length = _length;
+		_textures[texture] = info;
+
+		return texture;
+#else
+		return 0;
+#endif
+	} // createCompressedTexture
+
 //////////////////////////////////////////////////////////////////////////
 
 	void GLES20Renderer::destroyTexture(const unsigned int _texture)
 	{
+		// Pending vertices may use it
+		if (_texture == boundTexture)
+			flushBatch();
+
+		boundTextureInfoValid = false;
+
 		auto it = _textures.find(_texture);
 		if (it != _textures.cend())
 		{
@@ -736,7 +1064,12 @@ namespace Renderer
 	{
 		const GLenum type = convertTextureType(_type);
 
+		// Pending vertices sample the bound texture : draw them before its pixels change (font atlas updates)
+		if (_texture == boundTexture)
+			flushBatch();
+
 		bindTexture(_texture);
+		boundTextureInfoValid = false;
 
 		// Regular GL_ALPHA textures are black + alpha in shaders
 		// Create a GL_LUMINANCE_ALPHA texture instead so its white + alpha
@@ -753,9 +1086,14 @@ namespace Renderer
 
 			GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, _x, _y, _width, _height, type, GL_UNSIGNED_BYTE, la_data));
 			delete[] la_data;
+
+			frameStatistics.uploadedBytes += _width * _height * 2;
 		}
 		else
+		{
 			GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, _x, _y, _width, _height, type, GL_UNSIGNED_BYTE, _data));
+			frameStatistics.uploadedBytes += _width * _height * (type == GL_ALPHA ? 1 : 4);
+		}
 
 		if (_texture != 0)
 		{
@@ -764,12 +1102,14 @@ namespace Renderer
 			{
 				it->second->type = type;
 				it->second->size = Vector2f(_width, _height);
+				it->second->length = 0;
 			}
 			else
 			{
 				auto info = new TextureInfo();
 				info->type = type;
 				info->size = Vector2f(_width, _height);
+				info->length = 0;
 				_textures[_texture] = info;
 			}
 		}
@@ -785,7 +1125,11 @@ namespace Renderer
 		if (boundTexture == _texture)
 			return;
 
+		flushBatch();
+
 		boundTexture = _texture;
+		boundTextureInfoValid = false;
+		frameStatistics.stateChanges++;
 
 		if(_texture == 0)
 		{
@@ -804,24 +1148,16 @@ namespace Renderer
 
 	void GLES20Renderer::drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{
+		flushBatch();
+
 		// Pass buffer data
-		GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_DYNAMIC_DRAW));
+		GLint first = uploadVertices(_vertices, _numVertices);
 
 		useProgram(&shaderProgramColorNoTexture);
 
 		// Do rendering
-		if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
-		{
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
-			GL_CHECK_ERROR(glDrawArrays(GL_LINES, 0, _numVertices));
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-		}
-		else
-		{
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-			GL_CHECK_ERROR(glDrawArrays(GL_LINES, 0, _numVertices));
-		}
+		setBlendState(_srcBlendFactor, _dstBlendFactor);
+		drawArrays(GL_LINES, first, _numVertices);
 
 	} // drawLines
 
@@ -843,18 +1179,19 @@ namespace Renderer
 			return;
 		}
 
+		flushBatch();
+
 		bindTexture(0);
 		useProgram(&shaderProgramColorNoTexture);
 
-		GL_CHECK_ERROR(glEnable(GL_BLEND));
-		GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(Blend::SRC_ALPHA), convertBlendFactor(Blend::ONE_MINUS_SRC_ALPHA)));
+		setBlendState(Blend::SRC_ALPHA, Blend::ONE_MINUS_SRC_ALPHA);
 
 		auto inner = createRoundRect(_x + borderWidth, _y + borderWidth, _w - borderWidth - borderWidth, _h - borderWidth - borderWidth, cornerRadius, _fillColor);
 
 		if ((_fillColor) & 0xFF)
 		{
-			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * inner.size(), inner.data(), GL_DYNAMIC_DRAW));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, inner.size()));
+			GLint first = uploadVertices(inner.data(), inner.size());
+			drawArrays(GL_TRIANGLE_FAN, first, inner.size());
 		}
 
 		if ((_borderColor) & 0xFF && borderWidth > 0)
@@ -864,32 +1201,33 @@ namespace Renderer
 			setStencil(inner.data(), inner.size());
 			GL_CHECK_ERROR(glStencilFunc(GL_NOTEQUAL, 1, ~0));
 
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(Blend::SRC_ALPHA), convertBlendFactor(Blend::ONE_MINUS_SRC_ALPHA)));
+			useProgram(&shaderProgramColorNoTexture);
+			setBlendState(Blend::SRC_ALPHA, Blend::ONE_MINUS_SRC_ALPHA);
 
-			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * outer.size(), outer.data(), GL_DYNAMIC_DRAW));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, outer.size()));
+			GLint first = uploadVertices(outer.data(), outer.size());
+			drawArrays(GL_TRIANGLE_FAN, first, outer.size());
 			
 			disableStencil();
 		}
-
-		GL_CHECK_ERROR(glDisable(GL_BLEND));
 	}
 
 	void GLES20Renderer::drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, bool verticesChanged)
 	{
-		if (verticesChanged)
-			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_DYNAMIC_DRAW));
+		if (_numVertices == 0)
+			return;
+
+		TextureInfo* texture = nullptr;
+		ShaderProgram* shader = &shaderProgramColorNoTexture;
 
 		// Setup shader
 		if (boundTexture != 0)
 		{
-			auto it = _textures.find(boundTexture);
-			if (it != _textures.cend() && it->second != nullptr && it->second->type == GL_ALPHA)
-				useProgram(&shaderProgramAlpha);
+			texture = getBoundTextureInfo();
+			if (texture != nullptr && texture->type == GL_ALPHA)
+				shader = &shaderProgramAlpha;
 			else
 			{
-				ShaderProgram* shader = &shaderProgramColorTexture;
+				shader = &shaderProgramColorTexture;
 
 				if (_vertices->customShader != nullptr && !_vertices->customShader->path.empty())
 				{
@@ -897,58 +1235,63 @@ namespace Renderer
 					if (customShader != nullptr)
 						shader = customShader;
 				}
+			}
+		}
 
-				useProgram(shader);
+		// Default shaders without rounded corners only depend on the vertices & the saturation
+		if (shader != &shaderProgramColorTexture || _vertices->cornerRadius == 0.0f)
+		{
+			if (shader == &shaderProgramColorTexture || shader == &shaderProgramAlpha || shader == &shaderProgramColorNoTexture)
+			{
+				addToBatch(_vertices, _numVertices, shader, _srcBlendFactor, _dstBlendFactor, shader == &shaderProgramColorTexture ? _vertices->saturation : 1.0f);
+				return;
+			}
+		}
 
-				// Update Shader Uniforms				
-				shader->setSaturation(_vertices->saturation);
-				shader->setCornerRadius(_vertices->cornerRadius);
-				shader->setResolution();
-				shader->setFrameCount(Renderer::getCurrentFrame());
+		flushBatch();
 
-				if (shader->supportsTextureSize() && it != _textures.cend() && it->second != nullptr)
-				{
-					shader->setInputSize(it->second->size);
-					shader->setTextureSize(it->second->size);
-				}
-				
-				if (_numVertices > 0)
-				{
-					Vector2f vec = _vertices[_numVertices - 1].pos;
-					if (_numVertices == 4)
-					{
-						vec.x() -= _vertices[0].pos.x();
-						vec.y() -= _vertices[0].pos.y();
-					}
+		// Vertices can only be reused if nothing else was uploaded since
+		GLint first = lastUploadFirst;
+		if (verticesChanged || lastUploadSource != _vertices)
+			first = uploadVertices(_vertices, _numVertices);
 
-					// Inverted rendering
-					if (_vertices[_numVertices - 1].tex.y() == 1 && _vertices[0].tex.y() == 0)
-						vec.y() = -vec.y();
+		useProgram(shader);
 
-					shader->setOutputSize(vec);						
-					shader->setOutputOffset(_vertices[0].pos);
-				}
+		if (shader != &shaderProgramAlpha && shader != &shaderProgramColorNoTexture)
+		{
+			// Update Shader Uniforms				
+			shader->setSaturation(_vertices->saturation);
+			shader->setCornerRadius(_vertices->cornerRadius);
+			shader->setResolution();
+			shader->setFrameCount(Renderer::getCurrentFrame());
 
-				if (_vertices->customShader != nullptr && !_vertices->customShader->path.empty())
-					shader->setCustomUniformsParameters(_vertices->customShader->parameters);
+			if (shader->supportsTextureSize() && texture != nullptr)
+			{
+				shader->setInputSize(texture->size);
+				shader->setTextureSize(texture->size);
+			}
+
+			Vector2f vec = _vertices[_numVertices - 1].pos;
+			if (_numVertices == 4)
+			{
+				vec.x() -= _vertices[0].pos.x();
+				vec.y() -= _vertices[0].pos.y();
 			}
+
+			// Inverted rendering
+			if (_vertices[_numVertices - 1].tex.y() == 1 && _vertices[0].tex.y() == 0)
+				vec.y() = -vec.y();
+
+			shader->setOutputSize(vec);
+			shader->setOutputOffset(_vertices[0].pos);
+
+			if (_vertices->customShader != nullptr && !_vertices->customShader->path.empty())
+				shader->setCustomUniformsParameters(_vertices->customShader->parameters);
 		}
-		else
-			useProgram(&shaderProgramColorNoTexture);
 
 		// Do rendering
-		if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
-		{
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVertices));
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-		}
-		else
-		{
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, _numVertices));
-		}
+		setBlendState(_srcBlendFactor, _dstBlendFactor);
+		drawArrays(GL_TRIANGLE_STRIP, first, _numVertices);
 
 	} // drawTriangleStrips
 
@@ -956,6 +1299,8 @@ namespace Renderer
 
 	void GLES20Renderer::setProjection(const Transform4x4f& _projection)
 	{
+		flushBatch();
+
 		projectionMatrix = _projection;
 		mvpMatrix = projectionMatrix * worldViewMatrix;
 	} // setProjection
@@ -973,6 +1318,8 @@ namespace Renderer
 
 	void GLES20Renderer::setViewport(const Rect& _viewport)
 	{
+		flushBatch();
+
 		// glViewport starts at the bottom left of the window
 		GL_CHECK_ERROR(glViewport( _viewport.x, getWindowHeight() - _viewport.y - _viewport.h, _viewport.w, _viewport.h));
 
@@ -982,6 +1329,8 @@ namespace Renderer
 
 	void GLES20Renderer::setScissor(const Rect& _scissor)
 	{
+		flushBatch();
+
 		if((_scissor.x == 0) && (_scissor.y == 0) && (_scissor.w == 0) && (_scissor.h == 0))
 		{
 			GL_CHECK_ERROR(glDisable(GL_SCISSOR_TEST));
@@ -1020,8 +1369,12 @@ namespace Renderer
 
 	void GLES20Renderer::swapBuffers()
 	{
+		flushBatch();
 		useProgram(nullptr);
 
+		lastFrameStatistics = frameStatistics;
+		frameStatistics = Statistics();
+
 #ifdef WIN32		
 		glFlush();
 		Sleep(0);
@@ -1034,14 +1387,16 @@ namespace Renderer
 	
 	void GLES20Renderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
 	{		
+		flushBatch();
+
 		// Pass buffer data
-		GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_DYNAMIC_DRAW));
+		GLint first = uploadVertices(_vertices, _numVertices);
 
 		// Setup shader
 		if (boundTexture != 0)
 		{
-			auto it = _textures.find(boundTexture);
-			if (it != _textures.cend() && it->second != nullptr && it->second->type == GL_ALPHA)
+			TextureInfo* texture = getBoundTextureInfo();
+			if (texture != nullptr && texture->type == GL_ALPHA)
 				useProgram(&shaderProgramAlpha);
 			else
 			{
@@ -1054,22 +1409,14 @@ namespace Renderer
 			useProgram(&shaderProgramColorNoTexture);
 
 		// Do rendering
-		if (_srcBlendFactor != Blend::ONE && _dstBlendFactor != Blend::ONE)
-		{
-			GL_CHECK_ERROR(glEnable(GL_BLEND));
-			GL_CHECK_ERROR(glBlendFunc(convertBlendFactor(_srcBlendFactor), convertBlendFactor(_dstBlendFactor)));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices));
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-		}
-		else
-		{
-			GL_CHECK_ERROR(glDisable(GL_BLEND));
-			GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices));			
-		}
+		setBlendState(_srcBlendFactor, _dstBlendFactor);
+		drawArrays(GL_TRIANGLE_FAN, first, _numVertices);
 	}
 
 	void GLES20Renderer::setStencil(const Vertex* _vertices, const unsigned int _numVertices)
 	{
+		flushBatch();
+
 		useProgram(&shaderProgramColorNoTexture);
 
 		glEnable(GL_STENCIL_TEST);
@@ -1083,11 +1430,9 @@ namespace Renderer
 		glStencilFunc(GL_ALWAYS, 1, ~0);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
 
-		glEnable(GL_BLEND);
-		glBlendFunc(convertBlendFactor(Blend::SRC_ALPHA), convertBlendFactor(Blend::ONE_MINUS_SRC_ALPHA));
-		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * _numVertices, _vertices, GL_DYNAMIC_DRAW);
-		glDrawArrays(GL_TRIANGLE_FAN, 0, _numVertices);
-		glDisable(GL_BLEND);
+		setBlendState(Blend::SRC_ALPHA, Blend::ONE_MINUS_SRC_ALPHA);
+		GLint first = uploadVertices(_vertices, _numVertices);
+		drawArrays(GL_TRIANGLE_FAN, first, _numVertices);
 
 		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 		glDepthMask(GL_TRUE);
@@ -1098,9 +1443,15 @@ namespace Renderer
 
 	void GLES20Renderer::disableStencil()
 	{
+		flushBatch();
 		glDisable(GL_STENCIL_TEST);
 	}
 
+	Statistics GLES20Renderer::getStatistics()
+	{
+		return lastFrameStatistics;
+	}
+
 	size_t GLES20Renderer::getTotalMemUsage()
 	{
 		size_t total = 0;
@@ -1109,7 +1460,7 @@ namespace Renderer
 		{
 			if (tex.first != 0 && tex.second)
 			{
-				size_t size = tex.second->size.x() * tex.second->size.y() * (tex.second->type == GL_ALPHA ? 1 : 4);
+				size_t size = tex.second->length != 0 ? tex.second->length : tex.second->size.x() * tex.second->size.y() * (tex.second->type == GL_ALPHA ? 1 : 4);
 				total += size;
 			}
 		}	
@@ -1139,6 +1490,8 @@ namespace Renderer
 		if (shaderBatch == nullptr || shaderBatch->size() == 0)
 			return;
 
+		flushBatch();
+
 		if (mFrameBuffer == -1)
 			GL_CHECK_ERROR(glGenFramebuffers(1, &mFrameBuffer));
 
@@ -1235,7 +1588,7 @@ namespace Renderer
 			for (int i = 0; i < 4; ++i)
 				vertices[i].pos.round();
 
-			GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 4, &vertices, GL_DYNAMIC_DRAW));
+			GLint first = uploadVertices(vertices, 4);
 
 			for (int i = 0; i < shaderBatch->size(); i++)
 			{
@@ -1283,7 +1636,7 @@ namespace Renderer
 
 						for (int i = 0; i < 4; ++i) vertices[i].pos.round();
 
-						GL_CHECK_ERROR(glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 4, &vertices, GL_DYNAMIC_DRAW));
+						first = uploadVertices(vertices, 4);
 
 						GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, 0));
 					}
@@ -1311,8 +1664,8 @@ namespace Renderer
 
 				customShader->setCustomUniformsParameters(params);
 
-				GL_CHECK_ERROR(glDisable(GL_BLEND));
-				GL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+				setBlendState(Blend::ONE, Blend::ONE);
+				drawArrays(GL_TRIANGLE_STRIP, first, 4);
 			}
 
 			if (data != nullptr)
@@ -0,0 +1,326 @@
+#include "Renderer_Null.h"
+
+#include <SDL.h>
+
+// Size of the vertex ring buffer of the GLES20 renderer : a batch never holds more vertices
+#define BATCH_MAX_VERTICES	16384
+
+namespace Renderer
+{
+	// Programs of the GLES20 renderer that can be batched
+	enum BatchProgram : int
+	{
+		PROGRAM_COLOR = 0,
+		PROGRAM_ALPHA = 1,
+		PROGRAM_TEXTURE = 2
+	};
+
+	NullRenderer::NullRenderer() : mNextTexture(1), mBoundTexture(0), mSrcBlendFactor(Blend::ONE), mDstBlendFactor(Blend::ZERO),
+		mBatchProgram(PROGRAM_COLOR), mBatchSrcBlendFactor(Blend::ONE), mBatchDstBlendFactor(Blend::ZERO), mBatchSaturation(1.0f), mBatchVertices(0)
+	{
+
+	}
+
+	std::string NullRenderer::getDriverName()
+	{
+		return "NULL";
+	}
+
+	std::vector<std::pair<std::string, std::string>> NullRenderer::getDriverInformation()
+	{
+		std::vector<std::pair<std::string, std::string>> info;
+		info.push_back(std::pair<std::string, std::string>("GRAPHICS API", getDriverName()));
+		return info;
+	}
+
+	unsigned int NullRenderer::getWindowFlags()
+	{
+		return SDL_WINDOW_HIDDEN;
+
+	} // getWindowFlags
+
+	void NullRenderer::setupWindow()
+	{
+
+	} // setupWindow
+
+	void NullRenderer::createContext()
+	{
+
+	} // createContext
+
+	void NullRenderer::destroyContext()
+	{
+		resetCache();
+
+	} // destroyContext
+
+	void NullRenderer::resetCache()
+	{
+		flushBatch();
+		mBoundTexture = 0;
+
+	} // resetCache
+
+//////////////////////////////////////////////////////////////////////////
+
+	static size_t getTextureSize(const Texture::Type _type, const unsigned int _width, const unsigned int _height)
+	{
+		return (size_t)_width * _height * (_type == Texture::ALPHA ? 1 : 4);
+	}
+
+	unsigned int NullRenderer::createTexture(const Texture::Type _type, const bool _linear, const bool _repeat, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		unsigned int texture = mNextTexture++;
+
+		TextureInfo info;
+		info.size = getTextureSize(_type, _width, _height);
+		info.type = _type;
+		mTextures[texture] = info;
+
+		if (_data != nullptr)
+			mFrameStatistics.uploadedBytes += getTextureSize(_type, _width, _height);
+
+		return texture;
+
+	} // createTexture
+
+	void NullRenderer::destroyTexture(const unsigned int _texture)
+	{
+		if (mBoundTexture == _texture)
+			flushBatch();
+
+		mTextures.erase(_texture);
+
+		if (mBoundTexture == _texture)
+			mBoundTexture = 0;
+
+	} // destroyTexture
+
+	void NullRenderer::updateTexture(const unsigned int _texture, const Texture::Type _type, const unsigned int _x, const unsigned _y, const unsigned int _width, const unsigned int _height, void* _data)
+	{
+		if (mBoundTexture == _texture)
+			flushBatch();
+
+		auto it = mTextures.find(_texture);
+		if (it != mTextures.cend())
+			it->second.type = _type;
+
+		mFrameStatistics.uploadedBytes += getTextureSize(_type, _width, _height);
+
+	} // updateTexture
+
+	void NullRenderer::bindTexture(const unsigned int _texture)
+	{
+		if (mBoundTexture == _texture)
+			return;
+
+		flushBatch();
+
+		mBoundTexture = _texture;
+		mFrameStatistics.stateChanges++;
+
+	} // bindTexture
+
+//////////////////////////////////////////////////////////////////////////
+
+	void NullRenderer::draw(const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		if (mSrcBlendFactor != _srcBlendFactor || mDstBlendFactor != _dstBlendFactor)
+		{
+			mSrcBlendFactor = _srcBlendFactor;
+			mDstBlendFactor = _dstBlendFactor;
+			mFrameStatistics.stateChanges++;
+		}
+
+		mFrameStatistics.drawCalls++;
+		mFrameStatistics.uploadedBytes += sizeof(Vertex) * _numVertices;
+
+	} // draw
+
+	void NullRenderer::addToBatch(const unsigned int _numVertices, const int _program, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, const float _saturation)
+	{
+		if (mBatchVertices != 0 && (mBatchProgram != _program || mBatchSrcBlendFactor != _srcBlendFactor || mBatchDstBlendFactor != _dstBlendFactor ||
+			mBatchSaturation != _saturation || mBatchVertices + _numVertices + 2 > BATCH_MAX_VERTICES))
+			flushBatch();
+
+		if (mBatchVertices == 0)
+		{
+			mBatchProgram = _program;
+			mBatchSrcBlendFactor = _srcBlendFactor;
+			mBatchDstBlendFactor = _dstBlendFactor;
+			mBatchSaturation = _saturation;
+		}
+		else
+			mBatchVertices += 2; // Degenerate triangles joining the strips
+
+		mBatchVertices += _numVertices;
+		mFrameStatistics.batchedDraws++;
+
+	} // addToBatch
+
+	void NullRenderer::flushBatch()
+	{
+		if (mBatchVertices == 0)
+			return;
+
+		draw(mBatchVertices, mBatchSrcBlendFactor, mBatchDstBlendFactor);
+		mBatchVertices = 0;
+
+	} // flushBatch
+
+	void NullRenderer::drawLines(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		flushBatch();
+		draw(_numVertices, _srcBlendFactor, _dstBlendFactor);
+
+	} // drawLines
+
+	void NullRenderer::drawTriangleStrips(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor, bool verticesChanged)
+	{
+		if (_numVertices == 0)
+			return;
+
+		// Same program selection as GLES20Renderer::drawTriangleStrips
+		int program = PROGRAM_COLOR;
+		bool customShader = false;
+
+		if (mBoundTexture != 0)
+		{
+			auto it = mTextures.find(mBoundTexture);
+			if (it != mTextures.cend() && it->second.type == Texture::ALPHA)
+				program = PROGRAM_ALPHA;
+			else
+			{
+				program = PROGRAM_TEXTURE;
+				customShader = _vertices->customShader != nullptr && !_vertices->customShader->path.empty();
+			}
+		}
+
+		if (!customShader && (program != PROGRAM_TEXTURE || _vertices->cornerRadius == 0.0f))
+		{
+			addToBatch(_numVertices, program, _srcBlendFactor, _dstBlendFactor, program == PROGRAM_TEXTURE ? _vertices->saturation : 1.0f);
+			return;
+		}
+
+		flushBatch();
+		draw(verticesChanged ? _numVertices : 0, _srcBlendFactor, _dstBlendFactor);
+
+	} // drawTriangleStrips
+
+	void NullRenderer::drawTriangleFan(const Vertex* _vertices, const unsigned int _numVertices, const Blend::Factor _srcBlendFactor, const Blend::Factor _dstBlendFactor)
+	{
+		flushBatch();
+		draw(_numVertices, _srcBlendFactor, _dstBlendFactor);
+
+	} // drawTriangleFan
+
+	void NullRenderer::drawSolidRectangle(const float _x, const float _y, const float _w, const float _h, const unsigned int _fillColor, const unsigned int _borderColor, float borderWidth, float cornerRadius)
+	{
+		// Rounded rectangles are drawn as fans, the border through the stencil
+		if (cornerRadius != 0.0f)
+		{
+			flushBatch();
+			bindTexture(0);
+
+			if (_fillColor & 0xFF)
+				draw(0, Blend::SRC_ALPHA, Blend::ONE_MINUS_SRC_ALPHA);
+
+			if ((_borderColor & 0xFF) && borderWidth > 0)
+			{
+				setStencil(nullptr, 0);
+				draw(0, Blend::SRC_ALPHA, Blend::ONE_MINUS_SRC_ALPHA);
+				disableStencil();
+			}
+
+			return;
+		}
+
+		if (_fillColor != 0)
+			drawRect(_x + borderWidth, _y + borderWidth, _w - borderWidth - borderWidth, _h - borderWidth - borderWidth, _fillColor);
+
+		if (_borderColor != 0 && borderWidth > 0)
+		{
+			drawRect(_x, _y, _w, borderWidth, _borderColor);
+			drawRect(_x + _w - borderWidth, _y + borderWidth, borderWidth, _h - borderWidth, _borderColor);
+			drawRect(_x, _y + _h - borderWidth, _w - borderWidth, borderWidth, _borderColor);
+			drawRect(_x, _y + borderWidth, borderWidth, _h - borderWidth - borderWidth, _borderColor);
+		}
+
+	} // drawSolidRectangle
+
+//////////////////////////////////////////////////////////////////////////
+
+	void NullRenderer::setProjection(const Transform4x4f& _projection)
+	{
+		flushBatch();
+
+	} // setProjection
+
+	void NullRenderer::setMatrix(const Transform4x4f& _matrix)
+	{
+
+	} // setMatrix
+
+	void NullRenderer::setViewport(const Rect& _viewport)
+	{
+		flushBatch();
+		mFrameStatistics.stateChanges++;
+
+	} // setViewport
+
+	void NullRenderer::setScissor(const Rect& _scissor)
+	{
+		flushBatch();
+		mFrameStatistics.stateChanges++;
+
+	} // setScissor
+
+	void NullRenderer::setStencil(const Vertex* _vertices, const unsigned int _numVertices)
+	{
+		flushBatch();
+		draw(_numVertices, Blend::SRC_ALPHA, Blend::ONE_MINUS_SRC_ALPHA);
+		mFrameStatistics.stateChanges++;
+
+	} // setStencil
+
+	void NullRenderer::disableStencil()
+	{
+		flushBatch();
+		mFrameStatistics.stateChanges++;
+
+	} // disableStencil
+
+	void NullRenderer::setSwapInterval()
+	{
+
+	} // setSwapInterval
+
+	void NullRenderer::swapBuffers()
+	{
+		flushBatch();
+		mLastFrameStatistics = mFrameStatistics;
+		mFrameStatistics = Statistics();
+
+	} // swapBuffers
+
+//////////////////////////////////////////////////////////////////////////
+
+	size_t NullRenderer::getTotalMemUsage()
+	{
+		size_t total = 0;
+
+		for (auto tex : mTextures)
+			total += tex.second.size;
+
+		return total;
+
+	} // getTotalMemUsage
+
+	Statistics NullRenderer::getStatistics()
+	{
+		return mLastFrameStatistics;
+
+	} // getStatistics
+
+} // Renderer::
@@ -0,0 +1,540 @@
+#include "resources/ETC2Codec.h"
+
+#include <algorithm>
+#include <climits>
+#include <string.h>
+#include <stdint.h>
+
+// Intensity modifiers of individual & differential modes : { small, large }
+static const int etcModifiers[8][2] = { { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 } };
+
+// Distances of T & H modes
+static const int etcDistances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int eacModifiers[16][8] =
+{
+	{ -3, -6, -9, -15, 2, 5, 8, 14 },
+	{ -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5, -8, -13, 1, 4, 7, 12 },
+	{ -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 },
+	{ -3, -7, -9, -11, 2, 6, 8, 10 },
+	{ -4, -7, -8, -11, 3, 6, 7, 10 },
+	{ -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 },
+	{ -2, -5, -8, -10, 1, 4, 7, 9 },
+	{ -2, -4, -8, -10, 1, 3, 7, 9 },
+	{ -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 },
+	{ -1, -2, -3, -10, 0, 1, 2, 9 },
+	{ -4, -6, -8, -9, 3, 5, 7, 8 },
+	{ -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+#define EAC_ZERO_TABLE		13	// Its modifier 4 is 0
+#define EAC_ZERO_MODIFIER	4
+
+static inline int clamp255(int value) { return value < 0 ? 0 : (value > 255 ? 255 : value); }
+
+static inline int extend4(int value) { return (value << 4) | value; }
+static inline int extend5(int value) { return (value << 3) | (value >> 2); }
+static inline int extend6(int value) { return (value << 2) | (value >> 4); }
+static inline int extend7(int value) { return (value << 1) | (value >> 6); }
+
+static inline int signed3(int value) { return value >= 4 ? value - 8 : value; }
+
+static inline int getBits(uint64_t block, int high, int low) { return (int)((block >> low) & ((1ULL << (high - low + 1)) - 1)); }
+
+// Blocks are stored big endian
+static inline uint64_t readBlock(const unsigned char* src)
+{
+	uint64_t block = 0;
+	for (int i = 0; i < 8; i++)
+		block = (block << 8) | src[i];
+
+	return block;
+}
+
+static inline void writeBlock(unsigned char* dst, uint64_t block)
+{
+	for (int i = 7; i >= 0; i--)
+	{
+		dst[i] = (unsigned char)(block & 0xFF);
+		block >>= 8;
+	}
+}
+
+// In a block, pixel indices are numbered column by column. The 4x4 RGBA buffers used here are row by row
+static inline int getPixelIndex(int pixel) { return (pixel & 3) * 4 + (pixel >> 2); }
+
+//////////////////////////////////////////////////////////////////////////
+// Decoder
+
+static void decodePaintColors(uint64_t block, const int paint[4][3], unsigned char* pixels)
+{
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		int index = getPixelIndex(pixel);
+		int selector = (getBits(block, 16 + index, 16 + index) << 1) | getBits(block, index, index);
+
+		for (int c = 0; c < 3; c++)
+			pixels[pixel * 4 + c] = (unsigned char)clamp255(paint[selector][c]);
+	}
+}
+
+static void decodeTMode(uint64_t block, unsigned char* pixels)
+{
+	int c1[3] = { extend4((getBits(block, 60, 59) << 2) | getBits(block, 57, 56)), extend4(getBits(block, 55, 52)), extend4(getBits(block, 51, 48)) };
+	int c2[3] = { extend4(getBits(block, 47, 44)), extend4(getBits(block, 43, 40)), extend4(getBits(block, 39, 36)) };
+	int d = etcDistances[(getBits(block, 35, 34) << 1) | getBits(block, 32, 32)];
+
+	int paint[4][3];
+	for (int c = 0; c < 3; c++)
+	{
+		paint[0][c] = c1[c];
+		paint[1][c] = c2[c] + d;
+		paint[2][c] = c2[c];
+		paint[3][c] = c2[c] - d;
+	}
+
+	decodePaintColors(block, paint, pixels);
+}
+
+static void decodeHMode(uint64_t block, unsigned char* pixels)
+{
+	int c1[3] = { extend4(getBits(block, 62, 59)), extend4((getBits(block, 58, 56) << 1) | getBits(block, 52, 52)), extend4((getBits(block, 51, 51) << 3) | getBits(block, 49, 47)) };
+	int c2[3] = { extend4(getBits(block, 46, 43)), extend4(getBits(block, 42, 39)), extend4(getBits(block, 38, 35)) };
+
+	// The order of the base colors holds the lowest bit of the distance
+	int order = ((c1[0] << 16) | (c1[1] << 8) | c1[2]) >= ((c2[0] << 16) | (c2[1] << 8) | c2[2]) ? 1 : 0;
+	int d = etcDistances[(getBits(block, 34, 34) << 2) | (getBits(block, 32, 32) << 1) | order];
+
+	int paint[4][3];
+	for (int c = 0; c < 3; c++)
+	{
+		paint[0][c] = c1[c] + d;
+		paint[1][c] = c1[c] - d;
+		paint[2][c] = c2[c] + d;
+		paint[3][c] = c2[c] - d;
+	}
+
+	decodePaintColors(block, paint, pixels);
+}
+
+static void decodePlanarMode(uint64_t block, unsigned char* pixels)
+{
+	int o[3] = { extend6(getBits(block, 62, 57)), extend7((getBits(block, 56, 56) << 6) | getBits(block, 54, 49)), extend6((getBits(block, 48, 48) << 5) | (getBits(block, 44, 43) << 3) | getBits(block, 41, 39)) };
+	int h[3] = { extend6((getBits(block, 38, 34) << 1) | getBits(block, 32, 32)), extend7(getBits(block, 31, 25)), extend6(getBits(block, 24, 19)) };
+	int v[3] = { extend6(getBits(block, 18, 13)), extend7(getBits(block, 12, 6)), extend6(getBits(block, 5, 0)) };
+
+	for (int y = 0; y < 4; y++)
+		for (int x = 0; x < 4; x++)
+			for (int c = 0; c < 3; c++)
+				pixels[(y * 4 + x) * 4 + c] = (unsigned char)clamp255((x * (h[c] - o[c]) + y * (v[c] - o[c]) + 4 * o[c] + 2) >> 2);
+}
+
+static void decodeColorBlock(uint64_t block, unsigned char* pixels)
+{
+	for (int pixel = 0; pixel < 16; pixel++)
+		pixels[pixel * 4 + 3] = 255;
+
+	int c1[3], c2[3];
+
+	if (getBits(block, 33, 33) == 0)
+	{
+		// Individual mode
+		for (int c = 0; c < 3; c++)
+		{
+			c1[c] = extend4(getBits(block, 63 - c * 8, 60 - c * 8));
+			c2[c] = extend4(getBits(block, 59 - c * 8, 56 - c * 8));
+		}
+	}
+	else
+	{
+		// Differential mode. An overflowing second color selects one of the ETC2 modes
+		int base[3], second[3];
+		for (int c = 0; c < 3; c++)
+		{
+			base[c] = getBits(block, 63 - c * 8, 59 - c * 8);
+			second[c] = base[c] + signed3(getBits(block, 58 - c * 8, 56 - c * 8));
+		}
+
+		if (second[0] < 0 || second[0] > 31)
+			return decodeTMode(block, pixels);
+
+		if (second[1] < 0 || second[1] > 31)
+			return decodeHMode(block, pixels);
+
+		if (second[2] < 0 || second[2] > 31)
+			return decodePlanarMode(block, pixels);
+
+		for (int c = 0; c < 3; c++)
+		{
+			c1[c] = extend5(base[c]);
+			c2[c] = extend5(second[c]);
+		}
+	}
+
+	int tables[2] = { getBits(block, 39, 37), getBits(block, 36, 34) };
+	bool flip = getBits(block, 32, 32) != 0;
+
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		int x = pixel & 3;
+		int y = pixel >> 2;
+		int subBlock = flip ? (y >= 2) : (x >= 2);
+
+		int index = getPixelIndex(pixel);
+		int modifier = etcModifiers[tables[subBlock]][getBits(block, index, index)];
+		if (getBits(block, 16 + index, 16 + index))
+			modifier = -modifier;
+
+		const int* color = subBlock ? c2 : c1;
+		for (int c = 0; c < 3; c++)
+			pixels[pixel * 4 + c] = (unsigned char)clamp255(color[c] + modifier);
+	}
+}
+
+static void decodeAlphaBlock(uint64_t block, unsigned char* pixels)
+{
+	int base = getBits(block, 63, 56);
+	int multiplier = getBits(block, 55, 52);
+	const int* modifiers = eacModifiers[getBits(block, 51, 48)];
+
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		int index = getPixelIndex(pixel);
+		pixels[pixel * 4 + 3] = (unsigned char)clamp255(base + modifiers[getBits(block, 47 - index * 3, 45 - index * 3)] * multiplier);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Encoder
+
+// Chooses the modifier of each pixel of a sub block, returns the squared error
+static int fitSubBlock(const unsigned char* pixels, const int* subPixels, const int* color, int table, int* selectors)
+{
+	int candidates[4][3];
+	for (int selector = 0; selector < 4; selector++)
+	{
+		int modifier = etcModifiers[table][selector & 1];
+		if (selector & 2)
+			modifier = -modifier;
+
+		for (int c = 0; c < 3; c++)
+			candidates[selector][c] = clamp255(color[c] + modifier);
+	}
+
+	int error = 0;
+
+	for (int p = 0; p < 8; p++)
+	{
+		const unsigned char* px = pixels + subPixels[p] * 4;
+
+		int bestError = INT_MAX;
+		for (int selector = 0; selector < 4; selector++)
+		{
+			int dr = candidates[selector][0] - px[0];
+			int dg = candidates[selector][1] - px[1];
+			int db = candidates[selector][2] - px[2];
+
+			int e = dr * dr + dg * dg + db * db;
+			if (e < bestError)
+			{
+				bestError = e;
+				selectors[p] = selector;
+			}
+		}
+
+		error += bestError;
+	}
+
+	return error;
+}
+
+static uint64_t encodeColorBlock(const unsigned char* pixels)
+{
+	uint64_t bestBlock = 0;
+	int bestError = INT_MAX;
+
+	for (int flip = 0; flip < 2 && bestError > 0; flip++)
+	{
+		int subPixels[2][8];
+		int count[2] = { 0, 0 };
+		int average[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
+
+		for (int pixel = 0; pixel < 16; pixel++)
+		{
+			int subBlock = flip ? (pixel >> 2) >= 2 : (pixel & 3) >= 2;
+			subPixels[subBlock][count[subBlock]++] = pixel;
+
+			for (int c = 0; c < 3; c++)
+				average[subBlock][c] += pixels[pixel * 4 + c];
+		}
+
+		for (int s = 0; s < 2; s++)
+			for (int c = 0; c < 3; c++)
+				average[s][c] = (average[s][c] + 4) / 8;
+
+		for (int diff = 0; diff < 2 && bestError > 0; diff++)
+		{
+			int quantized[2][3];
+			int colors[2][3];
+
+			for (int c = 0; c < 3; c++)
+			{
+				if (diff)
+				{
+					// The second color is stored as a 3 bits delta of the first one
+					quantized[0][c] = (average[0][c] * 31 + 127) / 255;
+					quantized[1][c] = quantized[0][c] + std::max(-4, std::min(3, (average[1][c] * 31 + 127) / 255 - quantized[0][c]));
+					colors[0][c] = extend5(quantized[0][c]);
+					colors[1][c] = extend5(quantized[1][c]);
+				}
+				else
+				{
+					quantized[0][c] = (average[0][c] * 15 + 127) / 255;
+					quantized[1][c] = (average[1][c] * 15 + 127) / 255;
+					colors[0][c] = extend4(quantized[0][c]);
+					colors[1][c] = extend4(quantized[1][c]);
+				}
+			}
+
+			int error = 0;
+			int tables[2] = { 0, 0 };
+			int selectors[2][8];
+
+			for (int s = 0; s < 2; s++)
+			{
+				int subBlockError = INT_MAX;
+				int candidates[8];
+
+				for (int table = 0; table < 8 && subBlockError > 0; table++)
+				{
+					int e = fitSubBlock(pixels, subPixels[s], colors[s], table, candidates);
+					if (e < subBlockError)
+					{
+						subBlockError = e;
+						tables[s] = table;
+						memcpy(selectors[s], candidates, sizeof(candidates));
+					}
+				}
+
+				error += subBlockError;
+			}
+
+			if (error >= bestError)
+				continue;
+
+			bestError = error;
+
+			uint64_t block = 0;
+
+			for (int c = 0; c < 3; c++)
+			{
+				if (diff)
+				{
+					block |= (uint64_t)quantized[0][c] << (59 - c * 8);
+					block |= (uint64_t)((quantized[1][c] - quantized[0][c]) & 7) << (56 - c * 8);
+				}
+				else
+				{
+					block |= (uint64_t)quantized[0][c] << (60 - c * 8);
+					block |= (uint64_t)quantized[1][c] << (56 - c * 8);
+				}
+			}
+
+			block |= (uint64_t)tables[0] << 37;
+			block |= (uint64_t)tables[1] << 34;
+			block |= (uint64_t)diff << 33;
+			block |= (uint64_t)flip << 32;
+
+			for (int s = 0; s < 2; s++)
+			{
+				for (int p = 0; p < 8; p++)
+				{
+					int index = getPixelIndex(subPixels[s][p]);
+					block |= (uint64_t)(selectors[s][p] >> 1) << (16 + index);
+					block |= (uint64_t)(selectors[s][p] & 1) << index;
+				}
+			}
+
+			bestBlock = block;
+		}
+	}
+
+	return bestBlock;
+}
+
+static uint64_t encodeAlphaBlock(const unsigned char* pixels)
+{
+	int minAlpha = 255;
+	int maxAlpha = 0;
+
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		minAlpha = std::min(minAlpha, (int)pixels[pixel * 4 + 3]);
+		maxAlpha = std::max(maxAlpha, (int)pixels[pixel * 4 + 3]);
+	}
+
+	if (minAlpha == maxAlpha)
+	{
+		uint64_t block = ((uint64_t)minAlpha << 56) | (1ULL << 52) | ((uint64_t)EAC_ZERO_TABLE << 48);
+		for (int index = 0; index < 16; index++)
+			block |= (uint64_t)EAC_ZERO_MODIFIER << (45 - index * 3);
+
+		return block;
+	}
+
+	uint64_t bestBlock = 0;
+	int bestError = INT_MAX;
+
+	for (int table = 0; table < 16 && bestError > 0; table++)
+	{
+		const int* modifiers = eacModifiers[table];
+		int span = modifiers[7] - modifiers[3];
+
+		// Multipliers around the one that makes the table cover the alpha range
+		int multiplier = (maxAlpha - minAlpha + span - 1) / span;
+
+		for (int m = std::max(1, multiplier - 1); m <= std::min(15, multiplier + 1); m++)
+		{
+			int twice = minAlpha + maxAlpha - (modifiers[3] + modifiers[7]) * m;
+			int base = clamp255(twice >= 0 ? (twice + 1) / 2 : twice / 2);
+
+			int error = 0;
+			uint64_t block = ((uint64_t)base << 56) | ((uint64_t)m << 52) | ((uint64_t)table << 48);
+
+			int values[8];
+			for (int i = 0; i < 8; i++)
+				values[i] = clamp255(base + modifiers[i] * m);
+
+			for (int pixel = 0; pixel < 16 && error < bestError; pixel++)
+			{
+				int alpha = pixels[pixel * 4 + 3];
+
+				int pixelError = INT_MAX;
+				int selector = 0;
+
+				for (int i = 0; i < 8; i++)
+				{
+					int e = std::abs(values[i] - alpha);
+					if (e < pixelError)
+					{
+						pixelError = e;
+						selector = i;
+					}
+				}
+
+				error += pixelError * pixelError;
+				block |= (uint64_t)selector << (45 - getPixelIndex(pixel) * 3);
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				bestBlock = block;
+			}
+		}
+	}
+
+	return bestBlock;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+size_t ETC2Codec::getCompressedSize(size_t width, size_t height, bool alpha)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * (alpha ? 16 : 8);
+}
+
+bool ETC2Codec::hasAlpha(const unsigned char* dataRGBA, size_t width, size_t height)
+{
+	size_t count = width * height;
+	for (size_t i = 0; i < count; i++)
+		if (dataRGBA[i * 4 + 3] != 255)
+			return true;
+
+	return false;
+}
+
+unsigned char* ETC2Codec::encode(const unsigned char* dataRGBA, size_t width, size_t height, bool alpha, size_t& length)
+{
+	length = 0;
+
+	if (dataRGBA == nullptr || width == 0 || height == 0)
+		return nullptr;
+
+	length = getCompressedSize(width, height, alpha);
+
+	unsigned char* data = new unsigned char[length];
+	unsigned char* dst = data;
+
+	unsigned char pixels[16 * 4];
+
+	for (size_t by = 0; by < height; by += 4)
+	{
+		for (size_t bx = 0; bx < width; bx += 4)
+		{
+			// Blocks crossing the image borders repeat its last row & column
+			for (int y = 0; y < 4; y++)
+			{
+				size_t sy = std::min(by + y, height - 1);
+				for (int x = 0; x < 4; x++)
+				{
+					size_t sx = std::min(bx + x, width - 1);
+					memcpy(pixels + (y * 4 + x) * 4, dataRGBA + (sy * width + sx) * 4, 4);
+				}
+			}
+
+			if (alpha)
+			{
+				writeBlock(dst, encodeAlphaBlock(pixels));
+				dst += 8;
+			}
+
+			writeBlock(dst, encodeColorBlock(pixels));
+			dst += 8;
+		}
+	}
+
+	return data;
+}
+
+unsigned char* ETC2Codec::decode(const unsigned char* data, size_t length, size_t width, size_t height, bool alpha)
+{
+	if (data == nullptr || width == 0 || height == 0 || length < getCompressedSize(width, height, alpha))
+		return nullptr;
+
+	unsigned char* dataRGBA = new unsigned char[width * height * 4];
+	const unsigned char* src = data;
+
+	unsigned char pixels[16 * 4];
+
+	for (size_t by = 0; by < height; by += 4)
+	{
+		for (size_t bx = 0; bx < width; bx += 4)
+		{
+			uint64_t alphaBlock = 0;
+			if (alpha)
+			{
+				alphaBlock = readBlock(src);
+				src += 8;
+			}
+
+			decodeColorBlock(readBlock(src), pixels);
+			src += 8;
+
+			if (alpha)
+				decodeAlphaBlock(alphaBlock, pixels);
+
+			size_t rows = std::min((size_t)4, height - by);
+			size_t columns = std::min((size_t)4, width - bx);
+
+			for (size_t y = 0; y < rows; y++)
+				memcpy(dataRGBA + ((by + y) * width + bx) * 4, pixels + y * 16, columns * 4);
+		}
+	}
+
+	return dataRGBA;
+}
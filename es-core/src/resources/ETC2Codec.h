@@ -0,0 +1,24 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_ETC2_CODEC_H
+#define ES_CORE_RESOURCES_ETC2_CODEC_H
+
+#include <stdlib.h>
+
+// ETC2 texture compression (GL_COMPRESSED_RGB8_ETC2 & GL_COMPRESSED_RGBA8_ETC2_EAC).
+// Blocks of 4x4 pixels are stored in 8 bytes, plus 8 bytes of EAC alpha when the image has transparency.
+// The encoder writes ETC1 compatible (individual & differential) blocks, the decoder reads every ETC2 mode :
+// it is used when the GPU can't sample a compressed texture.
+class ETC2Codec
+{
+public:
+	static size_t getCompressedSize(size_t width, size_t height, bool alpha);
+
+	// Returns true if any pixel is not fully opaque
+	static bool hasAlpha(const unsigned char* dataRGBA, size_t width, size_t height);
+
+	// Both return new[] allocated buffers
+	static unsigned char* encode(const unsigned char* dataRGBA, size_t width, size_t height, bool alpha, size_t& length);
+	static unsigned char* decode(const unsigned char* data, size_t length, size_t width, size_t height, bool alpha);
+};
+
+#endif // ES_CORE_RESOURCES_ETC2_CODEC_H
@@ -3,6 +3,8 @@
 #include "math/Misc.h"
 #include "renderers/Renderer.h"
 #include "resources/ResourceManager.h"
+#include "resources/TextureDiskCache.h"
+#include "resources/ETC2Codec.h"
 #include "ImageIO.h"
 #include "Log.h"
 #include <nanosvg/nanosvg.h>
@@ -24,12 +26,16 @@
 
 IPdfHandler* TextureData::PdfHandler = nullptr;
 
+std::atomic<size_t> TextureData::sTotalRAMUsage(0);
+std::atomic<size_t> TextureData::sTotalVRAMUsage(0);
+
 TextureData::TextureData(bool tile, bool linear) : 
-	mTile(tile), mLinear(linear), mTextureID(0), mDataRGBA(nullptr), mScalable(false), mDynamic(true), mReloadable(false),	
-	mSize(Vector2i::Zero()), mPhysicalSize(Vector2f::Zero()), mMaxSize(MaxSizeInfo::Empty)
+	mTile(tile), mLinear(linear), mTextureID(0), mDataRGBA(nullptr), mDataType(Renderer::Texture::RGBA), mDataLength(0), mScalable(false), mDynamic(true), mReloadable(false),	
+	mSize(Vector2i::Zero()), mPhysicalSize(Vector2f::Zero()), mMaxSize(MaxSizeInfo::Empty), mAllocatedRAM(0), mAllocatedVRAM(0)
 {
 	mIsExternalDataRGBA = false;
 	mRequired = false;
+	mLastFrame = -1;
 }
 
 TextureData::~TextureData()
@@ -38,6 +44,20 @@ TextureData::~TextureData()
 	releaseRAM();
 }
 
+void TextureData::setAllocatedRAM(size_t bytes)
+{
+	sTotalRAMUsage += bytes;
+	sTotalRAMUsage -= mAllocatedRAM;
+	mAllocatedRAM = bytes;
+}
+
+void TextureData::setAllocatedVRAM(size_t bytes)
+{
+	sTotalVRAMUsage += bytes;
+	sTotalVRAMUsage -= mAllocatedVRAM;
+	mAllocatedVRAM = bytes;
+}
+
 void TextureData::initFromPath(const std::string& path)
 {
 	// Just set the path. It will be loaded later
@@ -153,22 +173,30 @@ bool TextureData::initSVGFromMemory(const unsigned char* fileData, size_t length
 	ImageIO::flipPixelsVert(dataRGBA, width, height);
 
 	mDataRGBA = dataRGBA;
+	mDataType = Renderer::Texture::RGBA;
+	mDataLength = width * height * 4;
+	setAllocatedRAM(mDataLength);
 
 	return true;
 }
 
-bool TextureData::initImageFromMemory(const unsigned char* fileData, size_t length, int subImageIndex)
+MaxSizeInfo TextureData::getLoadMaxSize()
 {
-	// If already initialised then don't read again
-	if (isLoaded())
-		return true;
-
 	// Don't load images greater than screen resolution
 	MaxSizeInfo maxSize(Renderer::getScreenWidth(), Renderer::getScreenHeight(), false);
 	if (!mMaxSize.empty() && mMaxSize.x() < maxSize.x() && mMaxSize.y() < maxSize.y())
 		maxSize = mMaxSize;
-		
-	auto oldSize = mSize;
+
+	return maxSize;
+}
+
+bool TextureData::initImageFromMemory(const unsigned char* fileData, size_t length, int subImageIndex, const std::string& diskCacheKey)
+{
+	// If already initialised then don't read again
+	if (isLoaded())
+		return true;
+
+	MaxSizeInfo maxSize = getLoadMaxSize();
 
 	size_t width, height;
 	Vector2i size;
@@ -185,9 +213,100 @@ bool TextureData::initImageFromMemory(const unsigned char* fileData, size_t leng
 		return false;
 	}
 
+	// Only rescaled images are worth caching : others are as fast to decode from their own file
+	if (!diskCacheKey.empty() && !size.empty())
+		return initFromScaledRGBA(imageRGBA, width, height, diskCacheKey, false);
+
 	return initFromRGBA(imageRGBA, width, height, false);
 }
 
+Renderer::Texture::Type TextureData::getCompressedType(const unsigned char* dataRGBA, size_t width, size_t height)
+{
+	if (!Settings::getInstance()->getBool("CompressedTextures"))
+		return Renderer::Texture::RGBA;
+
+	// Opaque images use half the size
+	auto type = ETC2Codec::hasAlpha(dataRGBA, width, height) ? Renderer::Texture::ETC2_RGBA : Renderer::Texture::ETC2_RGB;
+	return Renderer::supportsTextureType(type) ? type : Renderer::Texture::RGBA;
+}
+
+bool TextureData::initFromScaledRGBA(unsigned char* dataRGBA, size_t width, size_t height, const std::string& diskCacheKey, bool cached)
+{
+	auto type = getCompressedType(dataRGBA, width, height);
+	if (type != Renderer::Texture::RGBA)
+	{
+		size_t length;
+		unsigned char* data = ETC2Codec::encode(dataRGBA, width, height, type == Renderer::Texture::ETC2_RGBA, length);
+		if (data != nullptr)
+		{
+			// Also replaces the RGBA entries written before compression was enabled
+			TextureDiskCache::save(diskCacheKey, data, length, type, width, height, mPhysicalSize);
+
+			delete[] dataRGBA;
+			return initFromCompressedData(data, length, type, width, height);
+		}
+	}
+
+	if (!cached)
+		TextureDiskCache::save(diskCacheKey, dataRGBA, width * height * 4, Renderer::Texture::RGBA, width, height, mPhysicalSize);
+
+	return initFromRGBA(dataRGBA, width, height, false);
+}
+
+bool TextureData::initFromCompressedData(unsigned char* data, size_t length, Renderer::Texture::Type type, size_t width, size_t height)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	if (mIsExternalDataRGBA)
+	{
+		mIsExternalDataRGBA = false;
+		mDataRGBA = nullptr;
+	}
+
+	if (mDataRGBA)
+	{
+		delete[] data;
+		return true;
+	}
+
+	mDataRGBA = data;
+	mDataType = type;
+	mDataLength = length;
+	setAllocatedRAM(length);
+	mSize = Vector2i(width, height);
+
+	return true;
+}
+
+bool TextureData::loadFromDiskCache(const std::string& key)
+{
+	if (isLoaded())
+		return true;
+
+	size_t width, height, length;
+	Vector2f physicalSize;
+	Renderer::Texture::Type type;
+
+	unsigned char* data = TextureDiskCache::load(key, width, height, physicalSize, type, length);
+	if (data == nullptr)
+		return false;
+
+	if (type != Renderer::Texture::RGBA && !Settings::getInstance()->getBool("CompressedTextures"))
+	{
+		// Compression was turned off : decode the image again, at full quality
+		delete[] data;
+		return false;
+	}
+
+	mPhysicalSize = physicalSize;
+	mScalable = false;
+
+	if (type == Renderer::Texture::RGBA)
+		return initFromScaledRGBA(data, width, height, key, true);
+
+	return initFromCompressedData(data, length, type, width, height);
+}
+
 bool TextureData::initFromRGBA(unsigned char* dataRGBA, size_t width, size_t height, bool copyData)
 {
 	// If already initialised then don't read again
@@ -211,6 +330,9 @@ bool TextureData::initFromRGBA(unsigned char* dataRGBA, size_t width, size_t hei
 	else
 		mDataRGBA = dataRGBA;
 
+	mDataType = Renderer::Texture::RGBA;
+	mDataLength = width * height * 4;
+	setAllocatedRAM(mDataLength);
 	mSize = Vector2i(width, height);
 
 	if (copyData)
@@ -227,14 +349,29 @@ bool TextureData::updateFromExternalRGBA(unsigned char* dataRGBA, size_t width,
 	if (!mIsExternalDataRGBA && mDataRGBA != nullptr)
 		delete[] mDataRGBA;
 
+	// A compressed texture can't be updated with pixels
+	if (mTextureID != 0 && mDataType != Renderer::Texture::RGBA)
+	{
+		Renderer::destroyTexture(mTextureID);
+		mTextureID = 0;
+		setAllocatedVRAM(0);
+	}
+
+	// External pixels belong to the caller
 	mIsExternalDataRGBA = true;
 	mDataRGBA = dataRGBA;
+	mDataType = Renderer::Texture::RGBA;
+	mDataLength = width * height * 4;
+	setAllocatedRAM(0);
 
 	mSize = Vector2i(width, height);
 	mPhysicalSize = Vector2f(width, height);
 
 	if (mTextureID != 0)
+	{
 		Renderer::updateTexture(mTextureID, Renderer::Texture::RGBA, 0, 0, width, height, mDataRGBA);
+		setAllocatedVRAM(width * height * 4);
+	}
 
 	return true;
 }
@@ -458,6 +595,19 @@ bool TextureData::load(bool updateCache)
 		path = mPath.substr(0, idx);
 	}
 
+	std::string diskCacheKey;
+	if (ext != ".svg" && subImageIndex < 0 && !mMaxSize.empty() && TextureDiskCache::isEnabled())
+	{
+		diskCacheKey = TextureDiskCache::getKey(path, getLoadMaxSize());
+		if (loadFromDiskCache(diskCacheKey))
+		{
+			if (updateCache)
+				ImageIO::updateImageCache(mPath, Utils::FileSystem::getFileSize(path), Math::round((int)mPhysicalSize.x()), Math::round((int)mPhysicalSize.y()));
+
+			return true;
+		}
+	}
+
 	const ResourceData& data = ResourceManager::getInstance()->getFileData(path);
 
 	// is it an SVG?
@@ -467,7 +617,7 @@ bool TextureData::load(bool updateCache)
 		return initSVGFromMemory((const unsigned char*)data.ptr.get(), data.length);
 	}
 
-	bool retval = initImageFromMemory((const unsigned char*)data.ptr.get(), data.length, subImageIndex);
+	bool retval = initImageFromMemory((const unsigned char*)data.ptr.get(), data.length, subImageIndex, diskCacheKey);
 
 	if (updateCache && retval)
 		ImageIO::updateImageCache(mPath, data.length, Math::round((int)mPhysicalSize.x()), Math::round((int)mPhysicalSize.y()));
@@ -501,14 +651,37 @@ bool TextureData::uploadAndBind()
 		}
 
 		// Upload texture
-		mTextureID = Renderer::createTexture(Renderer::Texture::RGBA, mLinear, mTile, mSize.x(), mSize.y(), mDataRGBA);
+		if (mDataType != Renderer::Texture::RGBA)
+		{
+			mTextureID = Renderer::createCompressedTexture(mDataType, mLinear, mTile, mSize.x(), mSize.y(), mDataRGBA, mDataLength);
+			if (mTextureID == 0)
+			{
+				// The GPU refused the format : decode the blocks in software
+				unsigned char* dataRGBA = ETC2Codec::decode(mDataRGBA, mDataLength, mSize.x(), mSize.y(), mDataType == Renderer::Texture::ETC2_RGBA);
+				if (dataRGBA == nullptr)
+					return false;
+
+				delete[] mDataRGBA;
+				mDataRGBA = dataRGBA;
+				mDataType = Renderer::Texture::RGBA;
+				mDataLength = mSize.x() * mSize.y() * 4;
+				setAllocatedRAM(mDataLength);
+			}
+		}
+
+		if (mTextureID == 0)
+			mTextureID = Renderer::createTexture(Renderer::Texture::RGBA, mLinear, mTile, mSize.x(), mSize.y(), mDataRGBA);
+
 		if (mTextureID == 0)
 			return false;
 
+		setAllocatedVRAM(mDataLength);
+
 		if (mDataRGBA != nullptr && !mIsExternalDataRGBA)
 			delete[] mDataRGBA;
 
 		mDataRGBA = nullptr;
+		setAllocatedRAM(0);
 	}
 
 	return true;
@@ -521,6 +694,7 @@ void TextureData::releaseVRAM()
 	{
 		Renderer::destroyTexture(mTextureID);
 		mTextureID = 0;
+		setAllocatedVRAM(0);
 	}
 }
 
@@ -532,6 +706,7 @@ void TextureData::releaseRAM()
 		delete[] mDataRGBA;
 
 	mDataRGBA = 0;
+	setAllocatedRAM(0);
 }
 
 void TextureData::setStoredSize(float width, float height)
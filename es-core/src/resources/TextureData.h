@@ -2,10 +2,12 @@
 #ifndef ES_CORE_RESOURCES_TEXTURE_DATA_H
 #define ES_CORE_RESOURCES_TEXTURE_DATA_H
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <vector>
 #include "ImageIO.h"
+#include "renderers/Renderer.h"
 
 class TextureResource;
 
@@ -29,7 +31,7 @@ public:
 	//!!!! Needs to be canonical path. Caller should check for duplicates before calling this
 	void initFromPath(const std::string& path);
 	bool initSVGFromMemory(const unsigned char* fileData, size_t length);
-	bool initImageFromMemory(const unsigned char* fileData, size_t length, int subImageIndex = -1);
+	bool initImageFromMemory(const unsigned char* fileData, size_t length, int subImageIndex = -1, const std::string& diskCacheKey = "");
 	bool initFromRGBA(unsigned char* dataRGBA, size_t width, size_t height, bool copyData = true);
 
 	// Read the data into memory if necessary
@@ -51,8 +53,16 @@ public:
 	void releaseRAM();
 
 	// Get the amount of VRAM currenty used by this texture
-	inline size_t getEstimatedVRAMUsage() { return mSize.x() * mSize.y() * 4; }
-	inline size_t getVRAMUsage() { return mTextureID != 0 || mDataRGBA != nullptr ? mSize.x() * mSize.y() * 4 : 0; }
+	inline size_t getEstimatedVRAMUsage() { return mDataType == Renderer::Texture::RGBA ? mSize.x() * mSize.y() * 4 : mDataLength; }
+	inline size_t getVRAMUsage() { return mTextureID != 0 || mDataRGBA != nullptr ? getEstimatedVRAMUsage() : 0; }
+
+	// Bytes actually held by the decoded pixels and by the uploaded texture
+	inline size_t getAllocatedRAM() { return mAllocatedRAM; }
+	inline size_t getAllocatedVRAM() { return mAllocatedVRAM; }
+
+	// Same, summed over every TextureData : kept up to date, so they cost nothing to read
+	static size_t getTotalAllocatedRAM() { return sTotalRAMUsage; }
+	static size_t getTotalAllocatedVRAM() { return sTotalVRAMUsage; }
 
 	const 	Vector2i& getSize() const { return mSize; }
 	const 	Vector2f& getPhysicalSize() const { return mPhysicalSize; }
@@ -67,7 +77,7 @@ public:
 	bool tiled() { return mTile; }
 
 	unsigned char* getDataRGBA() {
-		return mDataRGBA;
+		return mDataType == Renderer::Texture::RGBA ? mDataRGBA : nullptr;
 	}
 
 	void setStoredSize(float width, float height);
@@ -84,6 +94,10 @@ public:
 	inline bool isRequired() { return mRequired; };
 	void setRequired(bool value) { mRequired = value; };
 
+	// Last frame this texture was requested for drawing, -1 if never
+	inline int getLastFrame() { return mLastFrame; };
+	void setLastFrame(int frame) { mLastFrame = frame; };
+
 	inline bool isDynamic() { return mDynamic; };
 	void setDynamic(bool value) { mDynamic = value; };
 
@@ -93,14 +107,28 @@ public:
 	void setScalable(bool value) { mScalable = value; };
 
 private:
+	void setAllocatedRAM(size_t bytes);
+	void setAllocatedVRAM(size_t bytes);
+
+	MaxSizeInfo getLoadMaxSize();
+	bool loadFromDiskCache(const std::string& key);
+
+	// Scaled images are compressed when the GPU can sample ETC2 textures, and stored in the disk cache
+	bool initFromScaledRGBA(unsigned char* dataRGBA, size_t width, size_t height, const std::string& diskCacheKey, bool cached);
+	bool initFromCompressedData(unsigned char* data, size_t length, Renderer::Texture::Type type, size_t width, size_t height);
+	static Renderer::Texture::Type getCompressedType(const unsigned char* dataRGBA, size_t width, size_t height);
+
 	bool			mRequired;
+	int				mLastFrame;
 
 	std::mutex		mMutex;
 	bool			mTile;
 	bool			mLinear;
 	std::string		mPath;
 	unsigned int	mTextureID;
-	unsigned char*	mDataRGBA;
+	unsigned char*	mDataRGBA;		// Holds compressed blocks when mDataType is not RGBA
+	Renderer::Texture::Type mDataType;
+	size_t			mDataLength;
 	bool			mReloadable;
 	bool			mDynamic;
 
@@ -119,6 +147,12 @@ private:
 */
 
 	bool			mIsExternalDataRGBA;
+
+	size_t			mAllocatedRAM;
+	size_t			mAllocatedVRAM;
+
+	static std::atomic<size_t> sTotalRAMUsage;
+	static std::atomic<size_t> sTotalVRAMUsage;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_DATA_H
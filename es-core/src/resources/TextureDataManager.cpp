@@ -4,9 +4,13 @@
 #include "resources/TextureResource.h"
 #include "Settings.h"
 #include "Log.h"
+#include "renderers/Renderer.h"
 #include <algorithm>
 #include <SDL.h>
 
+// Share of the system RAM that decoded pixels may use until they are uploaded
+#define RAM_BUDGET_DIVIDER	8
+
 TextureDataManager::TextureDataManager()
 {
 	mLoader = new TextureLoader(this);
@@ -25,6 +29,7 @@ std::shared_ptr<TextureData> TextureDataManager::add(const TextureResource* key,
 	auto it = mTextureLookup.find(key);
 	if (it != mTextureLookup.cend())
 	{
+		removeResident((*(*it).second).get());
 		// Remove the list entry
 		mTextures.erase((*it).second);
 		// And the lookup
@@ -46,6 +51,8 @@ void TextureDataManager::remove(const TextureResource* key)
 	auto it = mTextureLookup.find(key);
 	if (it != mTextureLookup.cend())
 	{
+		removeResident((*(*it).second).get());
+
 		// Remove the list entry
 		mTextures.erase((*it).second);
 		// And the lookup
@@ -62,12 +69,41 @@ void TextureDataManager::cancelAsync(const TextureResource* key)
 		mLoader->remove(*(*it).second);
 }
 
+void TextureDataManager::prefetch(const TextureResource* key, int priority)
+{
+	std::unique_lock<std::recursive_mutex> lock(mMutex);
+
+	auto it = mTextureLookup.find(key);
+	if (it == mTextureLookup.cend())
+		return;
+
+	std::shared_ptr<TextureData> tex = *(*it).second;
+	if (tex->isLoaded())
+		return;
+
+	// Already queued : only update its priority
+	if (mLoader->isQueued(tex))
+	{
+		mLoader->load(tex, priority);
+		return;
+	}
+
+	// Prefetching never evicts other textures
+	size_t max_texture = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
+	if (TextureResource::getTotalMemUsage() + tex->getEstimatedVRAMUsage() >= max_texture)
+		return;
+
+	// Nor piles up decoded pixels that may never be displayed
+	if (TextureData::getTotalAllocatedRAM() + getQueueSize() + tex->getEstimatedVRAMUsage() >= getMaxRAM())
+		return;
+
+	mLoader->load(tex, priority);
+}
+
 std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key, TextureLoadMode enableLoading)
 {
 	std::unique_lock<std::recursive_mutex> lock(mMutex);
 	
-	// If it's in the cache then we want to remove it from it's current location and
-	// move it to the top
 	std::shared_ptr<TextureData> tex;
 	auto it = mTextureLookup.find(key);
 	if (it != mTextureLookup.cend())
@@ -77,20 +113,21 @@ std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key,
 		if (enableLoading == TextureLoadMode::DISABLED)
 			return tex;
 
-		if (mTextures.cbegin() != (*it).second)
+		if (enableLoading == TextureLoadMode::ENABLED)
+			tex->setLastFrame(Renderer::getCurrentFrame());
+
+		if (tex->isLoaded())
 		{
-			// Remove the list entry
-			mTextures.erase((*it).second);
-			// Put it at the top
-			mTextures.push_front(tex);
-			// Store it back in the lookup
-			mTextureLookup[key] = mTextures.cbegin();
-		}
+			// Most recently used : evicted last
+			touch(tex);
 
-		// Make sure it's loaded or queued for loading
-		if (enableLoading == TextureLoadMode::ENABLED && !tex->isLoaded())
+			if (enableLoading == TextureLoadMode::ENABLED)
+				mStats.hits++;
+		}
+		else if (enableLoading == TextureLoadMode::ENABLED)
 		{
-			//lock.unlock();
+			// Make sure it's loaded or queued for loading
+			mStats.misses++;
 			load(tex);
 		}
 	}
@@ -120,59 +157,88 @@ size_t TextureDataManager::getTotalSize()
 	return total;
 }
 
-size_t TextureDataManager::getCommittedSize()
+size_t TextureDataManager::getQueueSize()
 {
 	std::unique_lock<std::recursive_mutex> lock(mMutex);
+	return mLoader->getQueueSize();
+}
 
-	size_t total = 0;
-	for (auto tex : mTextures)
-		total += tex->getVRAMUsage();
+void TextureDataManager::touch(const std::shared_ptr<TextureData>& tex)
+{
+	// Textures that can't be reloaded from their file are never evicted
+	if (!tex->isReloadable())
+		return;
 
-	return total;
+	auto it = mResidentLookup.find(tex.get());
+	if (it == mResidentLookup.cend())
+	{
+		mResident.push_front(tex);
+		mResidentLookup[tex.get()] = mResident.begin();
+	}
+	else if (it->second != mResident.begin())
+		mResident.splice(mResident.begin(), mResident, it->second);
 }
 
-size_t TextureDataManager::getQueueSize()
+void TextureDataManager::removeResident(TextureData* tex)
 {
-	std::unique_lock<std::recursive_mutex> lock(mMutex);
-	return mLoader->getQueueSize();
+	auto it = mResidentLookup.find(tex);
+	if (it != mResidentLookup.cend())
+	{
+		mResident.erase(it->second);
+		mResidentLookup.erase(it);
+	}
 }
 
-bool compareTextures(const std::shared_ptr<TextureData>& first, const std::shared_ptr<TextureData>& second)
+bool TextureDataManager::isVisible(const std::shared_ptr<TextureData>& tex)
 {
-	bool isResource = first->getPath().rfind(":/") == 0;
-	bool secondIsResource = second->getPath().rfind(":/") == 0;
-	if (isResource && !secondIsResource)
-		return true;
+	// Bound during the current or the previous frame
+	int frame = tex->getLastFrame();
+	return frame >= 0 && Renderer::getCurrentFrame() - frame <= 1;
+}
 
-	return (second->isRequired() && !first->isRequired());
+size_t TextureDataManager::getMaxRAM()
+{
+	static size_t maxRAM = (size_t)std::max(SDL_GetSystemRAM(), 256) * 1024 * 1024 / RAM_BUDGET_DIVIDER;
+	return maxRAM;
 }
 
-void TextureDataManager::cleanupVRAM(std::shared_ptr<TextureData> exclude)
+void TextureDataManager::onLoaded(std::shared_ptr<TextureData> tex)
 {
 	std::unique_lock<std::recursive_mutex> lock(mMutex);
 
-	size_t max_texture = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
+	if (tex->isLoaded())
+		touch(tex);
+}
 
-	size_t size = TextureResource::getTotalMemUsage(false);
-	size_t queuesize = getQueueSize();
+void TextureDataManager::cleanupVRAM(std::shared_ptr<TextureData> exclude)
+{
+	std::unique_lock<std::recursive_mutex> lock(mMutex);
+
+	size_t maxVRAM = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
+	size_t maxRAM = getMaxRAM();
 
-	if (exclude)
-		size += exclude->getEstimatedVRAMUsage();
+	size_t needed = exclude ? exclude->getEstimatedVRAMUsage() : 0;
+	size_t ram = TextureData::getTotalAllocatedRAM();
+	size_t vram = TextureData::getTotalAllocatedVRAM();
+	size_t queued = getQueueSize();
 
-	if (size >= max_texture)
+	// Release the least recently used textures first
+	auto it = mResident.end();
+	while (it != mResident.begin() && ram + vram + queued + needed >= maxVRAM)
 	{
-		// First Perform cleanup on textures without considering the queue
-		for (auto it = mTextures.crbegin(); it != mTextures.crend(); ++it)
-		{
-			if (size < max_texture)
-				break;
+		--it;
 
-			auto tex = *it;
-			if (tex == exclude || !tex->isReloadable() || tex->isRequired() || !tex->isLoaded())
-				continue;
+		auto tex = *it;
+		if (tex == exclude || tex->isRequired())
+			continue;
 
-			auto textureSize = tex->getEstimatedVRAMUsage();
-			if (textureSize == 0)
+		size_t texRAM = tex->getAllocatedRAM();
+		size_t texVRAM = tex->getAllocatedVRAM();
+
+		if (texRAM != 0 || texVRAM != 0)
+		{
+			// Textures on screen, and pixels waiting for their first upload, would be loaded again right away
+			if (texVRAM == 0 || isVisible(tex))
 				continue;
 
 			LOG(LogDebug) << "Cleanup VRAM\tReleased : " << tex->getPath().c_str();
@@ -180,48 +246,57 @@ void TextureDataManager::cleanupVRAM(std::shared_ptr<TextureData> exclude)
 			tex->releaseVRAM();
 			tex->releaseRAM();
 
-			size -= textureSize;
+			ram -= std::min(ram, texRAM);
+			vram -= std::min(vram, texVRAM);
+
+			mStats.evictions++;
+			mStats.evictedBytes += texRAM + texVRAM;
 		}
+
+		// Released textures leave the list, including the ones released somewhere else
+		mResidentLookup.erase(tex.get());
+		it = mResident.erase(it);
 	}
 
-	// Perform cleanup including the queue
-	size += queuesize;
-	if (size < max_texture)
-		return;
+	// Then drop the prefetched textures waiting to be loaded
+	size_t total = ram + vram + queued + needed;
+	size_t excess = total >= maxVRAM ? total - maxVRAM + 1 : 0;
 
-	for (auto it = mTextures.crbegin(); it != mTextures.crend(); ++it)
-	{
-		if (size < max_texture)
-			break;
+	// Decoded pixels can't be released before their upload : only the queue makes room for them
+	if (ram + queued + needed >= maxRAM)
+		excess = std::max(excess, ram + queued + needed - maxRAM + 1);
 
-		auto tex = *it;
-		if (tex == exclude || !tex->isReloadable() || tex->isRequired())
-			continue;
+	if (excess != 0)
+		mLoader->trimQueue(excess, exclude);
+}
 
-		auto textureSize = tex->getEstimatedVRAMUsage();
-		if (textureSize == 0)
-			continue;
+TextureDataManager::Stats TextureDataManager::getStats()
+{
+	std::unique_lock<std::recursive_mutex> lock(mMutex);
 
-		if (tex->isLoaded())
-		{
-			LOG(LogDebug) << "Cleanup VRAM\tReleased : " << tex->getPath().c_str();
+	Stats stats = mStats;
+	stats.allocatedRAM = TextureData::getTotalAllocatedRAM();
+	stats.allocatedVRAM = TextureData::getTotalAllocatedVRAM();
+	stats.residentCount = mResident.size();
 
-			tex->releaseVRAM();
-			tex->releaseRAM();
+	for (auto& tex : mResident)
+		stats.residentBySizeClass[Stats::getSizeClass(tex->getAllocatedRAM() + tex->getAllocatedVRAM())]++;
 
-			size -= textureSize;
-		}
-		else if (mLoader->remove(tex))
-		{
-			LOG(LogDebug) << "Cleanup VRAM\tRemoved from queue : " << tex->getPath().c_str();
-			size -= textureSize;
-		}
-	}
+	return stats;
+}
 
-	if (size > max_texture)
-	{
-		LOG(LogDebug) << "Cleanup VRAM\tRemoved from queue";
-	}
+int TextureDataManager::Stats::getSizeClass(size_t bytes)
+{
+	if (bytes < 64 * 1024)
+		return 0;
+
+	if (bytes < 512 * 1024)
+		return 1;
+
+	if (bytes < 2 * 1024 * 1024)
+		return 2;
+
+	return 3;
 }
 
 void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
@@ -245,10 +320,13 @@ void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
 	if (!block)
 		mLoader->load(tex);
 	else
+	{
 		tex->load();
+		onLoaded(tex);
+	}
 }
 
-TextureLoader::TextureLoader(TextureDataManager* mgr) : mManager(mgr), mExit(false)
+TextureLoader::TextureLoader(TextureDataManager* mgr) : mManager(mgr), mExit(false), mQueueOrder(0)
 {
 	int num_threads = std::thread::hardware_concurrency() / 2;
 	if (num_threads == 0)
@@ -284,10 +362,10 @@ void TextureLoader::threadProc()
 
 		if (!mTextureDataQ.empty())
 		{
-			std::shared_ptr<TextureData> textureData = mTextureDataQ.front();
+			std::shared_ptr<TextureData> textureData = mTextureDataQ.cbegin()->second;
 
-			mTextureDataQ.pop_front();
-			mTextureDataQSet.erase(textureData);
+			mTextureDataQ.erase(mTextureDataQ.cbegin());
+			mTextureDataQIndex.erase(textureData.get());
 
 			if (textureData && !textureData->isLoaded())
 			{
@@ -296,7 +374,8 @@ void TextureLoader::threadProc()
 				lock.unlock();
 				std::this_thread::yield();
 				
-				textureData->load(true);
+				if (textureData->load(true))
+					mManager->onLoaded(textureData);
 				
 				std::this_thread::yield();
 				lock.lock();
@@ -312,7 +391,7 @@ void TextureLoader::threadProc()
 
 bool TextureLoader::paused = false;
 
-void TextureLoader::load(std::shared_ptr<TextureData> textureData)
+void TextureLoader::load(std::shared_ptr<TextureData> textureData, int priority)
 {
 //	if (paused)
 	//	return;
@@ -328,16 +407,21 @@ void TextureLoader::load(std::shared_ptr<TextureData> textureData)
 		return;
 
 	// Remove it from the queue if it is already there
-	if (mTextureDataQSet.erase(textureData) > 0)
+	auto it = mTextureDataQIndex.find(textureData.get());
+	if (it != mTextureDataQIndex.cend())
 	{
-		auto tx = std::find(mTextureDataQ.cbegin(), mTextureDataQ.cend(), textureData);
-		if (tx != mTextureDataQ.cend())
-			mTextureDataQ.erase(tx);
+		// Prefetch requests are repeated while scrolling, keep their place if the priority did not change
+		if (priority != 0 && it->second.priority == priority)
+			return;
+
+		mTextureDataQ.erase(it->second);
+		mTextureDataQIndex.erase(it);
 	}
 
-	// Put it on the start of the queue as we want the newly requested textures to load first
-	mTextureDataQ.push_front(textureData);
-	mTextureDataQSet.insert(textureData);
+	// Newly requested textures load first among the ones with the same priority
+	QueueKey key(priority, ++mQueueOrder);
+	mTextureDataQ.emplace(key, textureData);
+	mTextureDataQIndex.emplace(textureData.get(), key);
 
 	mEvent.notify_one();
 }
@@ -347,16 +431,21 @@ bool TextureLoader::remove(std::shared_ptr<TextureData> textureData)
 	// Just remove it from the queue so we don't attempt to load it
 	std::unique_lock<std::mutex> lock(mLoaderLock);
 
-	if (mTextureDataQSet.erase(textureData) > 0)
-	{
-		auto tx = std::find(mTextureDataQ.cbegin(), mTextureDataQ.cend(), textureData);
-		if (tx != mTextureDataQ.cend())
-			mTextureDataQ.erase(tx);
+	auto it = mTextureDataQIndex.find(textureData.get());
+	if (it == mTextureDataQIndex.cend())
+		return false;
 
-		return true;
-	}
+	mTextureDataQ.erase(it->second);
+	mTextureDataQIndex.erase(it);
+	return true;
+}
+
+bool TextureLoader::isQueued(std::shared_ptr<TextureData> textureData)
+{
+	std::unique_lock<std::mutex> lock(mLoaderLock);
 
-	return false;
+	return mTextureDataQIndex.find(textureData.get()) != mTextureDataQIndex.cend() ||
+		mProcessingTextureDataQ.find(textureData) != mProcessingTextureDataQ.cend();
 }
 
 size_t TextureLoader::getQueueSize()
@@ -367,8 +456,8 @@ size_t TextureLoader::getQueueSize()
 	// the queue are loaded
 	size_t mem = 0;
 
-	for (auto tex : mTextureDataQ)
-		mem += tex->getEstimatedVRAMUsage();
+	for (auto& item : mTextureDataQ)
+		mem += item.second->getEstimatedVRAMUsage();
 
 	for (auto tex : mProcessingTextureDataQ)
 		mem += tex->getEstimatedVRAMUsage();
@@ -376,12 +465,42 @@ size_t TextureLoader::getQueueSize()
 	return mem;
 }
 
+size_t TextureLoader::trimQueue(size_t bytes, std::shared_ptr<TextureData> exclude)
+{
+	std::unique_lock<std::mutex> lock(mLoaderLock);
+
+	size_t removed = 0;
+
+	// The end of the queue holds the furthest & oldest requests
+	auto it = mTextureDataQ.end();
+	while (removed < bytes && it != mTextureDataQ.begin())
+	{
+		--it;
+
+		// Textures being displayed are never dropped, and sort before every prefetched one
+		if (it->first.priority == 0)
+			break;
+
+		auto tex = it->second;
+		if (tex == exclude)
+			continue;
+
+		LOG(LogDebug) << "Cleanup VRAM\tRemoved from queue : " << tex->getPath().c_str();
+
+		removed += tex->getEstimatedVRAMUsage();
+		mTextureDataQIndex.erase(tex.get());
+		it = mTextureDataQ.erase(it);
+	}
+
+	return removed;
+}
+
 void TextureLoader::clearQueue()
 {
 	std::unique_lock<std::mutex> lock(mLoaderLock);
 
 	// Just abort any waiting texture
-	mTextureDataQSet.clear();
+	mTextureDataQIndex.clear();
 	mTextureDataQ.clear();	
 }
 
@@ -11,6 +11,7 @@
 #include <vector>
 #include <set>
 #include <unordered_map>
+#include <cstring>
 
 class TextureDataManager;
 class TextureData;
@@ -22,9 +23,14 @@ public:
 	TextureLoader(TextureDataManager* mgr);
 	~TextureLoader();
 
-	void load(std::shared_ptr<TextureData> textureData);
+	// Lowest priorities are loaded first : 0 for textures being displayed, then the distance to the screen for prefetched ones.
+	// Among the same priority, the latest requested texture is loaded first
+	void load(std::shared_ptr<TextureData> textureData, int priority = 0);
 	bool remove(std::shared_ptr<TextureData> textureData);
+	bool isQueued(std::shared_ptr<TextureData> textureData);
 	void clearQueue();
+	// Removes the least important prefetched textures, until their estimated size reaches bytes. Returns the size removed
+	size_t trimQueue(size_t bytes, std::shared_ptr<TextureData> exclude);
 
 	size_t getQueueSize();
 
@@ -35,9 +41,26 @@ public:
 private:	
 	void threadProc();
 
+	struct QueueKey
+	{
+		QueueKey(int p, unsigned int o) : priority(p), order(o) { }
+
+		int				priority;
+		unsigned int	order;
+
+		bool operator<(const QueueKey& other) const
+		{
+			if (priority != other.priority)
+				return priority < other.priority;
+
+			return order > other.order;
+		}
+	};
+
 	std::set<std::shared_ptr<TextureData>> 											mProcessingTextureDataQ;
-	std::list<std::shared_ptr<TextureData>> 										mTextureDataQ;
-	std::set<std::shared_ptr<TextureData>> 											mTextureDataQSet;
+	std::map<QueueKey, std::shared_ptr<TextureData>> 								mTextureDataQ;
+	std::unordered_map<TextureData*, QueueKey> 										mTextureDataQIndex;
+	unsigned int																	mQueueOrder;
 
 	std::vector<std::thread>	mThreads;
 	std::mutex					mLoaderLock;
@@ -62,12 +85,37 @@ private:
 // to releaseRAM() which frees the memory buffer if the texture can be reloaded from
 // disk if needed again
 //
+// Loaded textures are kept in a least recently used list : when the MaxVRAM budget is
+// exceeded, textures are released from its tail, so eviction costs nothing per texture
+// that stays loaded. Textures bound during the last frame and pixels waiting for their
+// upload are never released : decoded pixels have their own budget, taken from the system
+// RAM, which only limits the prefetched textures
+//
 class TextureDataManager
 {
 public:
 	TextureDataManager();
 	~TextureDataManager();
 
+	struct Stats
+	{
+		Stats() : hits(0), misses(0), evictions(0), evictedBytes(0), allocatedRAM(0), allocatedVRAM(0), residentCount(0)
+		{
+			memset(residentBySizeClass, 0, sizeof(residentBySizeClass));
+		}
+
+		size_t hits;			// Textures requested while loaded
+		size_t misses;			// Textures requested while not loaded
+		size_t evictions;
+		size_t evictedBytes;
+		size_t allocatedRAM;
+		size_t allocatedVRAM;
+		size_t residentCount;
+		size_t residentBySizeClass[4];	// < 64 KB, < 512 KB, < 2 MB, larger
+
+		static int getSizeClass(size_t bytes);
+	};
+
 	enum TextureLoadMode : int
 	{
 		ENABLED = 0,
@@ -83,13 +131,13 @@ public:
 	void remove(const TextureResource* key);
 
 	void cancelAsync(const TextureResource* key);
+	// Queues a texture that is not displayed yet, as long as it fits in the free VRAM budget
+	void prefetch(const TextureResource* key, int priority);
 	std::shared_ptr<TextureData> get(const TextureResource* key, TextureLoadMode enableLoading = TextureLoadMode::ENABLED);
 	bool bind(const TextureResource* key);
 
 	// Get the total size of all textures managed by this object, loaded and unloaded in bytes
 	size_t	getTotalSize();
-	// Get the total size of all committed textures (in VRAM) in bytes
-	size_t	getCommittedSize();
 	// Get the total size of all load-pending textures in the queue - these will
 	// be committed to VRAM as the queue is processed
 	size_t  getQueueSize();
@@ -100,12 +148,29 @@ public:
 	
 	void cleanupVRAM(std::shared_ptr<TextureData> exclude = nullptr);
 
+	// Called by the loader threads once a texture is loaded
+	void onLoaded(std::shared_ptr<TextureData> tex);
+
+	Stats getStats();
+
 private:
 
 	std::shared_ptr<TextureData> getBlankTexture();
 
+	// Moves a loaded texture to the head of the resident list
+	void touch(const std::shared_ptr<TextureData>& tex);
+	void removeResident(TextureData* tex);
+
+	static bool isVisible(const std::shared_ptr<TextureData>& tex);
+	static size_t getMaxRAM();
+
 	std::recursive_mutex					mMutex;
 
+	std::list<std::shared_ptr<TextureData>>											mResident;
+	std::unordered_map<TextureData*, std::list<std::shared_ptr<TextureData>>::iterator>	mResidentLookup;
+
+	Stats																					mStats;
+
 	std::list<std::shared_ptr<TextureData> >												mTextures;
 	std::unordered_map<const TextureResource*, std::list<std::shared_ptr<TextureData> >::const_iterator > 	mTextureLookup;
 	std::shared_ptr<TextureData>															mBlank;
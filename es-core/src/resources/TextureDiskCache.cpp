@@ -0,0 +1,181 @@
+#include "resources/TextureDiskCache.h"
+
+#include "utils/BinaryFile.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "renderers/Renderer.h"
+#include "ImageIO.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <thread>
+
+#define TEXTURECACHE_MAGIC		"ESTC"
+#define TEXTURECACHE_VERSION	2
+
+#define TEXTURECACHE_MAX_SIZE	(256ULL * 1024 * 1024)
+#define TEXTURECACHE_TOUCH_DELAY	3600	// s
+
+bool TextureDiskCache::isEnabled()
+{
+	return Settings::getInstance()->getBool("ThumbnailCache");
+}
+
+std::string TextureDiskCache::getCachePath()
+{
+	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/thumbnails");
+}
+
+std::string TextureDiskCache::getFileName(const std::string& key)
+{
+	char hex[17];
+	snprintf(hex, sizeof(hex), "%016llx", Utils::String::hash64(key));
+	return getCachePath() + "/" + hex + ".tex";
+}
+
+std::string TextureDiskCache::getKey(const std::string& path, const MaxSizeInfo& maxSize)
+{
+	auto fileSize = Utils::FileSystem::getFileSize(path);
+	if (fileSize == 0)
+		return "";
+
+	auto lastWriteTime = Utils::FileSystem::getFileModificationDate(path).getTime();
+
+	// The screen size also limits the scaled size
+	return path + "|" + std::to_string(fileSize) + "|" + std::to_string((long long)lastWriteTime) + "|" +
+		std::to_string((int)Math::round(maxSize.x())) + "x" + std::to_string((int)Math::round(maxSize.y())) + (maxSize.externalZoom() ? "z" : "") + "|" +
+		std::to_string(Renderer::getScreenWidth()) + "x" + std::to_string(Renderer::getScreenHeight());
+}
+
+unsigned char* TextureDiskCache::load(const std::string& key, size_t& width, size_t& height, Vector2f& physicalSize, Renderer::Texture::Type& type, size_t& length)
+{
+	if (key.empty())
+		return nullptr;
+
+	std::string fileName = getFileName(key);
+
+	Utils::MappedFile file(fileName);
+	if (file.data() == nullptr)
+		return nullptr;
+
+	Utils::BinaryReader reader(file.data(), file.size());
+	if (!reader.readMagic(TEXTURECACHE_MAGIC) || reader.read<uint32_t>() != TEXTURECACHE_VERSION)
+		return nullptr;
+
+	// Different keys can share the same hash : the whole key is stored
+	if (reader.readString() != key)
+		return nullptr;
+
+	uint32_t w = reader.read<uint32_t>();
+	uint32_t h = reader.read<uint32_t>();
+	float physicalWidth = reader.read<float>();
+	float physicalHeight = reader.read<float>();
+	uint32_t dataType = reader.read<uint32_t>();
+	uint32_t dataLength = reader.read<uint32_t>();
+
+	if (dataType != Renderer::Texture::RGBA && dataType != Renderer::Texture::ETC2_RGB && dataType != Renderer::Texture::ETC2_RGBA)
+		return nullptr;
+
+	if (dataType == Renderer::Texture::RGBA && dataLength != (size_t)w * h * 4)
+		return nullptr;
+
+	const char* pixels = reader.readBytes(dataLength);
+	if (pixels == nullptr || w == 0 || h == 0 || dataLength == 0)
+		return nullptr;
+
+	unsigned char* data = new unsigned char[dataLength];
+	memcpy(data, pixels, dataLength);
+
+	width = w;
+	height = h;
+	physicalSize = Vector2f(physicalWidth, physicalHeight);
+	type = (Renderer::Texture::Type)dataType;
+	length = dataLength;
+
+	// The modification time of an entry is its last use, which trim() evicts by. It is only updated once in
+	// a while, so that reading the cache does not write to the disk every time
+	if (time(NULL) - Utils::FileSystem::getFileModificationDate(fileName).getTime() > TEXTURECACHE_TOUCH_DELAY)
+		Utils::FileSystem::touchFile(fileName);
+
+	return data;
+}
+
+void TextureDiskCache::save(const std::string& key, const unsigned char* data, size_t length, Renderer::Texture::Type type, size_t width, size_t height, const Vector2f& physicalSize)
+{
+	if (key.empty() || data == nullptr || length == 0 || width == 0 || height == 0)
+		return;
+
+	Utils::BinaryWriter writer;
+	writer.writeMagic(TEXTURECACHE_MAGIC);
+	writer.write<uint32_t>(TEXTURECACHE_VERSION);
+	writer.writeString(key);
+	writer.write<uint32_t>((uint32_t)width);
+	writer.write<uint32_t>((uint32_t)height);
+	writer.write<float>(physicalSize.x());
+	writer.write<float>(physicalSize.y());
+	writer.write<uint32_t>((uint32_t)type);
+	writer.write<uint32_t>((uint32_t)length);
+	writer.writeBytes(data, length);
+
+	if (!writer.save(getFileName(key)))
+		LOG(LogWarning) << "TextureDiskCache : Unable to write " << getFileName(key);
+}
+
+void TextureDiskCache::trim()
+{
+	std::thread([]()
+	{
+		struct CacheFile
+		{
+			std::string path;
+			unsigned long long size;
+			time_t lastUse;
+		};
+
+		std::vector<CacheFile> files;
+		unsigned long long totalSize = 0;
+
+		for (auto& fi : Utils::FileSystem::getDirectoryFiles(getCachePath()))
+		{
+			if (fi.directory)
+				continue;
+
+			CacheFile file;
+			file.path = fi.path;
+			file.size = Utils::FileSystem::getFileSize(fi.path);
+			file.lastUse = Utils::FileSystem::getFileModificationDate(fi.path).getTime();
+			files.push_back(file);
+
+			totalSize += file.size;
+		}
+
+		if (totalSize <= TEXTURECACHE_MAX_SIZE)
+			return;
+
+		// Least recently used first
+		std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) { return a.lastUse < b.lastUse; });
+
+		int count = 0;
+
+		for (auto& file : files)
+		{
+			if (totalSize <= TEXTURECACHE_MAX_SIZE * 3 / 4)
+				break;
+
+			if (Utils::FileSystem::removeFile(file.path))
+			{
+				totalSize -= file.size;
+				count++;
+			}
+		}
+
+		LOG(LogInfo) << "TextureDiskCache : " << count << " least recently used files removed";
+	}).detach();
+}
+
+void TextureDiskCache::clear()
+{
+	Utils::FileSystem::deleteDirectoryFiles(getCachePath());
+}
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef ES_CORE_RESOURCES_TEXTURE_DISK_CACHE_H
+#define ES_CORE_RESOURCES_TEXTURE_DISK_CACHE_H
+
+#include <string>
+#include "math/Vector2f.h"
+#include "renderers/Renderer.h"
+
+class MaxSizeInfo;
+
+// Disk cache of downscaled images, stored in <user>/cache/thumbnails.
+// Decoding & rescaling a large image costs much more than reading its already scaled pixels : entries are the
+// pixels as they are uploaded (RGBA or ETC2 compressed), keyed by the source file (path, size, last write time)
+// and the target size.
+class TextureDiskCache
+{
+public:
+	static bool isEnabled();
+
+	static std::string getKey(const std::string& path, const MaxSizeInfo& maxSize);
+
+	// Returns a new[] allocated buffer of length bytes, or nullptr if the entry does not exist or is outdated
+	static unsigned char* load(const std::string& key, size_t& width, size_t& height, Vector2f& physicalSize, Renderer::Texture::Type& type, size_t& length);
+	static void save(const std::string& key, const unsigned char* data, size_t length, Renderer::Texture::Type type, size_t width, size_t height, const Vector2f& physicalSize);
+
+	// Removes the least recently used entries when the cache grows past its size limit, in a background thread
+	static void trim();
+	static void clear();
+
+private:
+	static std::string getCachePath();
+	static std::string getFileName(const std::string& key);
+};
+
+#endif // ES_CORE_RESOURCES_TEXTURE_DISK_CACHE_H
@@ -264,6 +264,12 @@ void TextureResource::prioritize() const
 		sTextureDataManager.get(this, TextureDataManager::TextureLoadMode::MOVETOTOPONLY);
 }
 
+void TextureResource::prefetch(int priority) const
+{
+	if (mTextureData == nullptr)
+		sTextureDataManager.prefetch(this, priority);
+}
+
 void TextureResource::setRequired(bool value) const
 {
 	if (mTextureData != nullptr)
@@ -320,14 +326,8 @@ bool TextureResource::isLoaded() const
 
 size_t TextureResource::getTotalMemUsage(bool includeQueueSize)
 {
-	size_t total = 0;
-
-	// Count up all textures that manage their own texture data
-	for (auto tex : sNonDynamicTextureResources)
-		total += tex->mTextureData->getVRAMUsage();
-
-	// Now get the committed memory from the manager
-	total += sTextureDataManager.getCommittedSize();
+	// Decoded pixels & uploaded textures, whether they are managed or not
+	size_t total = TextureData::getTotalAllocatedRAM() + TextureData::getTotalAllocatedVRAM();
 
 	// And the size of the loading queue
 	if (includeQueueSize)
@@ -377,6 +377,11 @@ void TextureResource::reload()
 		sTextureDataManager.get(this);
 }
 
+TextureDataManager::Stats TextureResource::getStats()
+{
+	return sTextureDataManager.getStats();
+}
+
 void TextureResource::clearQueue()
 {
 	sTextureDataManager.clearQueue();
@@ -40,6 +40,8 @@ public:
 	bool isLoaded() const;
 	bool isTiled() const;
 	void prioritize() const;
+	// Starts an asynchronous load before the texture is displayed. Lowest priorities load first, 0 being on screen
+	void prefetch(int priority) const;
 	void setRequired(bool value) const;
 	bool isScalable() const;
 
@@ -47,6 +49,7 @@ public:
 
 	static size_t getTotalMemUsage(bool includeQueueSize = true); // returns an approximation of total VRAM used by textures (in bytes)
 	static size_t getTotalTextureSize(); // returns the number of bytes that would be used if all textures were in memory
+	static TextureDataManager::Stats getStats();
 	
 	virtual bool unload();
 	virtual void reload();
@@ -0,0 +1,93 @@
+#define _FILE_OFFSET_BITS 64
+
+#include "utils/BinaryFile.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+
+#include <sys/stat.h>
+#include <fstream>
+
+#if WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+namespace Utils
+{
+	MappedFile::MappedFile(const std::string& path) : mData(nullptr), mSize(0), mMapped(false)
+	{
+#if WIN32
+		std::ifstream stream(Utils::String::convertToWideString(path), std::ios::binary | std::ios::ate);
+		if (!stream.is_open())
+			return;
+
+		mSize = (size_t)stream.tellg();
+		if (mSize == 0)
+			return;
+
+		mBuffer.resize(mSize);
+		stream.seekg(0, std::ios::beg);
+		if (stream.read(mBuffer.data(), mSize))
+			mData = mBuffer.data();
+		else
+			mSize = 0;
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return;
+
+		struct stat64 info;
+		if (fstat64(fd, &info) == 0 && info.st_size > 0)
+		{
+			void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED)
+			{
+				mData = (const char*)data;
+				mSize = (size_t)info.st_size;
+				mMapped = true;
+			}
+		}
+
+		close(fd);
+#endif
+	}
+
+	MappedFile::~MappedFile()
+	{
+#if !WIN32
+		if (mMapped)
+			munmap((void*)mData, mSize);
+#endif
+	}
+
+	bool BinaryWriter::save(const std::string& path)
+	{
+		std::string folder = Utils::FileSystem::getParent(path);
+		if (!Utils::FileSystem::exists(folder))
+			Utils::FileSystem::createDirectory(folder);
+
+		std::string tmpPath = path + ".tmp";
+
+#if WIN32
+		std::ofstream stream(Utils::String::convertToWideString(tmpPath), std::ios::binary);
+#else
+		std::ofstream stream(tmpPath, std::ios::binary);
+#endif
+		if (!stream.is_open())
+			return false;
+
+		stream.write(mBuffer.c_str(), mBuffer.size());
+		stream.close();
+
+		if (stream.fail() || !Utils::FileSystem::renameFile(tmpPath, path))
+		{
+			Utils::FileSystem::removeFile(tmpPath);
+			return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+#ifndef ES_CORE_UTILS_BINARYFILE_H
+#define ES_CORE_UTILS_BINARYFILE_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+
+namespace Utils
+{
+	// Read-only view of a whole file : mapped in memory when the platform allows it
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::string& path);
+		~MappedFile();
+
+		const char* data() const { return mData; }
+		size_t size() const { return mSize; }
+
+	private:
+		const char*			mData;
+		size_t				mSize;
+		bool				mMapped;
+		std::vector<char>	mBuffer;
+	};
+
+	// Bounds-checked reader : once a read goes past the end, every following read fails & returns default values
+	class BinaryReader
+	{
+	public:
+		BinaryReader(const char* data, size_t size) : mPtr(data), mEnd(data + size), mFailed(data == nullptr) { }
+
+		bool failed() const { return mFailed; }
+		// Marks data read successfully but holding invalid values
+		void fail() { mFailed = true; }
+		bool eof() const { return mPtr >= mEnd; }
+
+		template<typename T> T read()
+		{
+			T value = T();
+			if (mFailed || (size_t)(mEnd - mPtr) < sizeof(T))
+			{
+				mFailed = true;
+				return value;
+			}
+
+			memcpy(&value, mPtr, sizeof(T));
+			mPtr += sizeof(T);
+			return value;
+		}
+
+		std::string readString()
+		{
+			uint32_t length = read<uint32_t>();
+			if (mFailed || (size_t)(mEnd - mPtr) < length)
+			{
+				mFailed = true;
+				return std::string();
+			}
+
+			std::string value(mPtr, length);
+			mPtr += length;
+			return value;
+		}
+
+		// Returns a pointer to the next length bytes, without copying them
+		const char* readBytes(size_t length)
+		{
+			if (mFailed || (size_t)(mEnd - mPtr) < length)
+			{
+				mFailed = true;
+				return nullptr;
+			}
+
+			const char* value = mPtr;
+			mPtr += length;
+			return value;
+		}
+
+		bool readMagic(const char* magic)
+		{
+			size_t length = strlen(magic);
+			if (mFailed || (size_t)(mEnd - mPtr) < length || memcmp(mPtr, magic, length) != 0)
+			{
+				mFailed = true;
+				return false;
+			}
+
+			mPtr += length;
+			return true;
+		}
+
+	private:
+		const char* mPtr;
+		const char* mEnd;
+		bool		mFailed;
+	};
+
+	class BinaryWriter
+	{
+	public:
+		template<typename T> void write(const T& value)
+		{
+			mBuffer.append((const char*)&value, sizeof(T));
+		}
+
+		void writeString(const std::string& value)
+		{
+			write<uint32_t>((uint32_t)value.size());
+			mBuffer.append(value);
+		}
+
+		void writeBytes(const void* data, size_t length) { mBuffer.append((const char*)data, length); }
+
+		void writeMagic(const char* magic) { mBuffer.append(magic, strlen(magic)); }
+
+		const std::string& buffer() const { return mBuffer; }
+
+		// Writes to a temporary file then renames it, so that readers never see a partial file
+		bool save(const std::string& path);
+
+	private:
+		std::string mBuffer;
+	};
+}
+
+#endif // ES_CORE_UTILS_BINARYFILE_H
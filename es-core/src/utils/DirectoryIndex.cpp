@@ -0,0 +1,407 @@
+#define _FILE_OFFSET_BITS 64
+
+#include "utils/DirectoryIndex.h"
+#include "utils/BinaryFile.h"
+#include "utils/StringUtil.h"
+#include "Paths.h"
+#include "Log.h"
+
+#include <sys/stat.h>
+
+#if WIN32
+#define stat64 _stat64
+#define S_ISDIR(x) (((x) & S_IFMT) == S_IFDIR)
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#define INDEX_MAGIC		"ESDI"
+#define INDEX_VERSION	1
+
+// inotify watches are a per-user resource (fs.inotify.max_user_watches), leave some for other applications
+#define MAX_WATCHES		4096
+
+// Folders written less than this number of seconds before being listed are not indexed :
+// with coarse file system timestamps, a following change could keep the same last write time
+#define RECENT_WRITE_DELAY	2
+
+namespace Utils
+{
+	std::mutex DirectoryIndex::mLock;
+	bool DirectoryIndex::mLoaded = false;
+	bool DirectoryIndex::mDirty = false;
+
+	std::unordered_map<std::string, DirectoryIndex::IndexedDirectory> DirectoryIndex::mDirectories;
+	std::unordered_map<std::string, bool> DirectoryIndex::mPendingScans;
+
+	int DirectoryIndex::mNotifyHandle = -1;
+	std::unordered_map<int, std::string> DirectoryIndex::mWatches;
+	std::thread* DirectoryIndex::mWatchThread = nullptr;
+	std::atomic<bool> DirectoryIndex::mWatchRunning(false);
+
+	static time_t getFolderLastWriteTime(const std::string& path)
+	{
+		struct stat64 info;
+
+#if WIN32
+		if (_wstat64(Utils::String::convertToWideString(path).c_str(), &info) != 0)
+			return 0;
+#else
+		if (stat64(path.c_str(), &info) != 0)
+			return 0;
+#endif
+
+		return S_ISDIR(info.st_mode) ? info.st_mtime : 0;
+	}
+
+	std::string DirectoryIndex::getIndexPath()
+	{
+		return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/cache/directories.cache");
+	}
+
+	Utils::FileSystem::fileList DirectoryIndex::getDirectoryFiles(const std::string& path)
+	{
+		std::string folder = Utils::FileSystem::getGenericPath(path);
+
+		Utils::FileSystem::fileList ret;
+
+		auto toFileList = [&ret, &folder](const IndexedDirectory& indexed)
+		{
+			for (auto& file : indexed.files)
+			{
+				Utils::FileSystem::FileInfo fi;
+				fi.path = folder + "/" + file.name;
+				fi.hidden = (file.flags & ENTRY_HIDDEN) != 0;
+				fi.directory = (file.flags & ENTRY_DIRECTORY) != 0;
+#if WIN32
+				fi.lastWriteTime = 0;
+#endif
+				ret.push_back(fi);
+			}
+		};
+
+		time_t indexedTime = 0;
+		bool watched = false;
+
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+
+			if (!mLoaded)
+				load();
+
+			auto it = mDirectories.find(folder);
+			if (it != mDirectories.cend())
+			{
+				it->second.used = true;
+
+				// Any change since the watch was set would have removed the listing
+				if (it->second.watched)
+				{
+					toFileList(it->second);
+					lock.unlock();
+
+					Utils::FileSystem::addDirectoryFilesToCache(folder, ret);
+					return ret;
+				}
+
+				indexedTime = it->second.lastWriteTime;
+			}
+
+			// Watch before checking/listing, so that no change can happen unnoticed in between
+			watched = addWatch(folder);
+			mPendingScans[folder] = false;
+		}
+
+		time_t lastWriteTime = getFolderLastWriteTime(folder);
+
+		if (lastWriteTime != 0 && lastWriteTime == indexedTime)
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+
+			auto it = mDirectories.find(folder);
+			if (it != mDirectories.cend() && !mPendingScans[folder])
+			{
+				mPendingScans.erase(folder);
+
+				it->second.watched = watched;
+				toFileList(it->second);
+				lock.unlock();
+
+				Utils::FileSystem::addDirectoryFilesToCache(folder, ret);
+				return ret;
+			}
+
+			mPendingScans[folder] = false;
+		}
+
+		ret = Utils::FileSystem::getDirectoryFiles(folder);
+
+		std::unique_lock<std::mutex> lock(mLock);
+
+		bool changed = mPendingScans[folder];
+		mPendingScans.erase(folder);
+
+		if (lastWriteTime == 0 || changed || lastWriteTime + RECENT_WRITE_DELAY >= time(NULL))
+		{
+			if (mDirectories.erase(folder) > 0)
+				mDirty = true;
+
+			return ret;
+		}
+
+		IndexedDirectory& indexed = mDirectories[folder];
+		indexed.lastWriteTime = lastWriteTime;
+		indexed.watched = watched;
+		indexed.used = true;
+		indexed.files.clear();
+		indexed.files.reserve(ret.size());
+
+		size_t prefixLength = folder.size() + 1;
+
+		for (auto& fi : ret)
+		{
+			IndexedFile file;
+			file.name = fi.path.substr(prefixLength);
+			file.flags = (fi.hidden ? ENTRY_HIDDEN : 0) | (fi.directory ? ENTRY_DIRECTORY : 0);
+			indexed.files.push_back(file);
+		}
+
+		mDirty = true;
+		return ret;
+	}
+
+	void DirectoryIndex::keep(const std::string& path)
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		if (!mLoaded)
+			load();
+
+		auto it = mDirectories.find(Utils::FileSystem::getGenericPath(path));
+		if (it != mDirectories.cend())
+			it->second.used = true;
+	}
+
+	void DirectoryIndex::invalidate(const std::string& path)
+	{
+		if (mDirectories.erase(path) > 0)
+			mDirty = true;
+
+		auto pending = mPendingScans.find(path);
+		if (pending != mPendingScans.cend())
+			pending->second = true;
+	}
+
+	void DirectoryIndex::load()
+	{
+		mLoaded = true;
+
+		Utils::MappedFile file(getIndexPath());
+		if (file.data() == nullptr)
+			return;
+
+		Utils::BinaryReader reader(file.data(), file.size());
+		if (!reader.readMagic(INDEX_MAGIC) || reader.read<uint32_t>() != INDEX_VERSION)
+			return;
+
+		uint32_t count = reader.read<uint32_t>();
+		for (uint32_t i = 0; i < count && !reader.failed(); i++)
+		{
+			std::string path = reader.readString();
+
+			IndexedDirectory indexed;
+			indexed.lastWriteTime = (time_t)reader.read<int64_t>();
+
+			uint32_t fileCount = reader.read<uint32_t>();
+			indexed.files.reserve(fileCount);
+
+			for (uint32_t f = 0; f < fileCount && !reader.failed(); f++)
+			{
+				IndexedFile file;
+				file.name = reader.readString();
+				file.flags = reader.read<uint8_t>();
+				indexed.files.push_back(file);
+			}
+
+			mDirectories[path] = indexed;
+		}
+
+		if (reader.failed())
+		{
+			LOG(LogWarning) << "DirectoryIndex : Corrupted index, ignored";
+			mDirectories.clear();
+		}
+	}
+
+	void DirectoryIndex::save()
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		// Folders of removed systems, or that don't exist anymore, would stay in the index forever
+		auto isKept = [](const IndexedDirectory& indexed) { return indexed.used && indexed.lastWriteTime != 0; };
+
+		uint32_t count = 0;
+		for (auto& item : mDirectories)
+			if (isKept(item.second))
+				count++;
+
+		if (!mDirty && count == mDirectories.size())
+			return;
+
+		Utils::BinaryWriter writer;
+		writer.writeMagic(INDEX_MAGIC);
+		writer.write<uint32_t>(INDEX_VERSION);
+		writer.write<uint32_t>(count);
+
+		for (auto& item : mDirectories)
+		{
+			if (!isKept(item.second))
+				continue;
+
+			writer.writeString(item.first);
+			writer.write<int64_t>((int64_t)item.second.lastWriteTime);
+			writer.write<uint32_t>((uint32_t)item.second.files.size());
+
+			for (auto& file : item.second.files)
+			{
+				writer.writeString(file.name);
+				writer.write<uint8_t>(file.flags);
+			}
+		}
+
+		if (writer.save(getIndexPath()))
+			mDirty = false;
+		else
+			LOG(LogError) << "DirectoryIndex : Unable to write " << getIndexPath();
+	}
+
+	void DirectoryIndex::clear()
+	{
+		std::unique_lock<std::mutex> lock(mLock);
+
+		mDirectories.clear();
+		mLoaded = true;
+		mDirty = false;
+
+		for (auto& pending : mPendingScans)
+			pending.second = true;
+
+		Utils::FileSystem::removeFile(getIndexPath());
+	}
+
+	bool DirectoryIndex::addWatch(const std::string& path)
+	{
+#if defined(__linux__)
+		if (mNotifyHandle == -1)
+		{
+			mNotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (mNotifyHandle < 0)
+			{
+				LOG(LogWarning) << "DirectoryIndex : inotify is not available, folders will be checked using their last write time";
+				mNotifyHandle = -2;
+			}
+		}
+
+		if (mNotifyHandle < 0 || mWatches.size() >= MAX_WATCHES)
+			return false;
+
+		int wd = inotify_add_watch(mNotifyHandle, path.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+		if (wd < 0)
+			return false;
+
+		mWatches[wd] = path;
+
+		if (mWatchThread == nullptr)
+		{
+			mWatchRunning = true;
+			mWatchThread = new std::thread(&DirectoryIndex::watchThread);
+		}
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void DirectoryIndex::watchThread()
+	{
+#if defined(__linux__)
+		char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+		while (mWatchRunning)
+		{
+			struct pollfd pfd;
+			pfd.fd = mNotifyHandle;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+
+			if (poll(&pfd, 1, 500) <= 0)
+				continue;
+
+			ssize_t length = read(mNotifyHandle, buffer, sizeof(buffer));
+			if (length <= 0)
+				continue;
+
+			std::unique_lock<std::mutex> lock(mLock);
+
+			const struct inotify_event* event;
+			for (char* ptr = buffer; ptr < buffer + length; ptr += sizeof(struct inotify_event) + event->len)
+			{
+				event = (const struct inotify_event*)ptr;
+
+				if (event->mask & IN_Q_OVERFLOW)
+				{
+					// Events were lost : go back to checking last write times
+					LOG(LogDebug) << "DirectoryIndex : inotify queue overflow";
+
+					for (auto& indexed : mDirectories)
+						indexed.second.watched = false;
+
+					for (auto& pending : mPendingScans)
+						pending.second = true;
+
+					continue;
+				}
+
+				auto it = mWatches.find(event->wd);
+				if (it == mWatches.cend())
+					continue;
+
+				invalidate(it->second);
+
+				if (event->mask & IN_IGNORED)
+					mWatches.erase(it);
+			}
+		}
+#endif
+	}
+
+	void DirectoryIndex::stop()
+	{
+		if (mWatchThread != nullptr)
+		{
+			mWatchRunning = false;
+			mWatchThread->join();
+
+			delete mWatchThread;
+			mWatchThread = nullptr;
+		}
+
+		std::unique_lock<std::mutex> lock(mLock);
+
+#if defined(__linux__)
+		if (mNotifyHandle >= 0)
+			close(mNotifyHandle);
+#endif
+
+		mNotifyHandle = -2;
+		mWatches.clear();
+
+		for (auto& indexed : mDirectories)
+			indexed.second.watched = false;
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef ES_CORE_UTILS_DIRECTORYINDEX_H
+#define ES_CORE_UTILS_DIRECTORYINDEX_H
+
+#include "utils/FileSystemUtil.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <time.h>
+
+namespace Utils
+{
+	// Persistent index of folder listings, kept across boots in <user>/cache/directories.cache.
+	// A listing is reused while the folder's last write time is unchanged. On Linux, indexed folders are also
+	// watched with inotify : a watched folder is trusted without any stat, and any change in it drops its listing.
+	class DirectoryIndex
+	{
+	public:
+		// Same result as Utils::FileSystem::getDirectoryFiles, only enumerates the folder if it changed
+		static Utils::FileSystem::fileList getDirectoryFiles(const std::string& path);
+
+		// The folder was checked by other means (gamelist snapshots) : keep its listing in the next save
+		static void keep(const std::string& path);
+
+		// Only writes the folders used during this session
+		static void save();
+		static void clear();
+		static void stop();
+
+	private:
+		enum EntryFlags : uint8_t
+		{
+			ENTRY_HIDDEN = 1,
+			ENTRY_DIRECTORY = 2
+		};
+
+		struct IndexedFile
+		{
+			std::string name;
+			uint8_t		flags;
+		};
+
+		struct IndexedDirectory
+		{
+			IndexedDirectory() : lastWriteTime(0), watched(false), used(false) { }
+
+			time_t		lastWriteTime;
+			bool		watched;
+			bool		used;	// Looked up during this session
+			std::vector<IndexedFile> files;
+		};
+
+		static void load();
+		static void invalidate(const std::string& path);
+
+		static bool addWatch(const std::string& path);
+		static void watchThread();
+
+		static std::string getIndexPath();
+
+		static std::mutex mLock;
+		static bool mLoaded;
+		static bool mDirty;
+
+		static std::unordered_map<std::string, IndexedDirectory> mDirectories;
+		static std::unordered_map<std::string, bool> mPendingScans;	// Folders being enumerated -> changed meanwhile
+
+		static int mNotifyHandle;
+		static std::unordered_map<int, std::string> mWatches;
+		static std::thread* mWatchThread;
+		static std::atomic<bool> mWatchRunning;
+	};
+}
+
+#endif // ES_CORE_UTILS_DIRECTORYINDEX_H
@@ -17,6 +17,7 @@
 #include <Windows.h>
 #include <mutex>
 #include <io.h> 
+#include <sys/utime.h>
 #define getcwd _getcwd
 #define mkdir(x,y) _mkdir(x)
 #define snprintf _snprintf
@@ -27,6 +28,7 @@
 #else // _WIN32
 #include <dirent.h>
 #include <unistd.h>
+#include <utime.h>
 #include <mutex>
 #endif // _WIN32
 
@@ -438,6 +440,24 @@ namespace Utils
 
 		} // getDirectoryFiles
 
+		void addDirectoryFilesToCache(const std::string& _path, const fileList& files)
+		{
+			if (!FileCache::isEnabled())
+				return;
+
+			std::string path = getGenericPath(_path);
+
+			// tell filecache we enumerated the folder
+			FileCache::add(path + "/*", FileCache(true, true));
+
+			for (auto& file : files)
+			{
+				FileCache cache(true, file.directory);
+				cache.hidden = file.hidden;
+				FileCache::add(file.path, cache);
+			}
+		}
+
 		std::vector<std::string> getPathList(const std::string& _path)
 		{
 			std::vector<std::string>  pathList;
@@ -1210,6 +1230,33 @@ namespace Utils
 			return Utils::Time::DateTime();
 		}
 
+		time_t getLastWriteTime(const std::string& _path)
+		{
+			std::string path = getGenericPath(_path);
+			struct stat64 info;
+
+#if defined(_WIN32)
+			if ((_wstat64(Utils::String::convertToWideString(path).c_str(), &info) == 0))
+				return info.st_mtime;
+#else
+			if ((stat64(path.c_str(), &info) == 0))
+				return info.st_mtime;
+#endif
+			return 0;
+		}
+
+		bool touchFile(const std::string& _path)
+		{
+			std::string path = getGenericPath(_path);
+
+			// A null time sets both access & modification times to now
+#if defined(_WIN32)
+			return _wutime(Utils::String::convertToWideString(path).c_str(), nullptr) == 0;
+#else
+			return utime(path.c_str(), nullptr) == 0;
+#endif
+		}
+
 		static void skipUtf8Bom(std::ifstream& file) 
 		{
 			if (!file.is_open())
@@ -58,11 +58,14 @@ namespace Utils
 		typedef std::list<FileInfo> fileList;
 
 		fileList	getDirectoryFiles(const std::string& _path);
+		void		addDirectoryFilesToCache(const std::string& _path, const fileList& files);
 		std::string combine(const std::string& _path, const std::string& filename);
 		unsigned long long	getFileSize(const std::string& _path);
 
 		Utils::Time::DateTime getFileCreationDate(const std::string& _path);
 		Utils::Time::DateTime getFileModificationDate(const std::string& _path);
+		time_t		getLastWriteTime(const std::string& _path); // 0 if the path does not exist
+		bool		touchFile(const std::string& _path);
 
 		std::string	readAllText(const std::string& fileName);
 		stringList	readAllLines(const std::string& fileName);
@@ -0,0 +1,372 @@
+#include "utils/RoaringBitmap.h"
+
+#include <algorithm>
+#include <iterator>
+#include <bitset>
+
+namespace Utils
+{
+	static inline int popCount(uint64_t word)
+	{
+		return (int)std::bitset<64>(word).count();
+	}
+
+	bool RoaringBitmap::Container::contains(uint16_t value) const
+	{
+		if (isBitmap())
+			return (bitmap[value >> 6] >> (value & 63)) & 1;
+
+		return std::binary_search(array.cbegin(), array.cend(), value);
+	}
+
+	void RoaringBitmap::Container::toBitmap()
+	{
+		bitmap.assign(BITMAP_WORDS, 0);
+		for (auto value : array)
+			bitmap[value >> 6] |= (uint64_t)1 << (value & 63);
+
+		array.clear();
+		array.shrink_to_fit();
+	}
+
+	void RoaringBitmap::Container::toArray()
+	{
+		array.clear();
+		array.reserve(cardinality);
+
+		for (int i = 0; i < BITMAP_WORDS; i++)
+		{
+			uint64_t word = bitmap[i];
+			while (word != 0)
+			{
+				int bit = 0;
+				while (((word >> bit) & 1) == 0)
+					bit++;
+
+				array.push_back((uint16_t)((i << 6) + bit));
+				word &= word - 1;
+			}
+		}
+
+		bitmap.clear();
+		bitmap.shrink_to_fit();
+	}
+
+	RoaringBitmap::Container* RoaringBitmap::findContainer(uint16_t key)
+	{
+		auto it = std::lower_bound(mContainers.begin(), mContainers.end(), key, [](const Container& c, uint16_t k) { return c.key < k; });
+		if (it == mContainers.end() || it->key != key)
+			return nullptr;
+
+		return &(*it);
+	}
+
+	const RoaringBitmap::Container* RoaringBitmap::findContainer(uint16_t key) const
+	{
+		auto it = std::lower_bound(mContainers.cbegin(), mContainers.cend(), key, [](const Container& c, uint16_t k) { return c.key < k; });
+		if (it == mContainers.cend() || it->key != key)
+			return nullptr;
+
+		return &(*it);
+	}
+
+	void RoaringBitmap::add(uint32_t value)
+	{
+		uint16_t key = (uint16_t)(value >> 16);
+		uint16_t low = (uint16_t)(value & 0xFFFF);
+
+		auto it = std::lower_bound(mContainers.begin(), mContainers.end(), key, [](const Container& c, uint16_t k) { return c.key < k; });
+		if (it == mContainers.end() || it->key != key)
+		{
+			it = mContainers.insert(it, Container());
+			it->key = key;
+		}
+
+		Container& container = *it;
+
+		if (container.isBitmap())
+		{
+			uint64_t& word = container.bitmap[low >> 6];
+			uint64_t mask = (uint64_t)1 << (low & 63);
+			if ((word & mask) == 0)
+			{
+				word |= mask;
+				container.cardinality++;
+			}
+
+			return;
+		}
+
+		auto pos = std::lower_bound(container.array.begin(), container.array.end(), low);
+		if (pos != container.array.end() && *pos == low)
+			return;
+
+		container.array.insert(pos, low);
+		container.cardinality++;
+
+		if (container.cardinality > ARRAY_MAX)
+			container.toBitmap();
+	}
+
+	void RoaringBitmap::remove(uint32_t value)
+	{
+		uint16_t key = (uint16_t)(value >> 16);
+		uint16_t low = (uint16_t)(value & 0xFFFF);
+
+		auto it = std::lower_bound(mContainers.begin(), mContainers.end(), key, [](const Container& c, uint16_t k) { return c.key < k; });
+		if (it == mContainers.end() || it->key != key)
+			return;
+
+		Container& container = *it;
+
+		if (container.isBitmap())
+		{
+			uint64_t& word = container.bitmap[low >> 6];
+			uint64_t mask = (uint64_t)1 << (low & 63);
+			if ((word & mask) == 0)
+				return;
+
+			word &= ~mask;
+			container.cardinality--;
+
+			// Half way down only, so games toggling around the limit don't convert on each change
+			if (container.cardinality <= ARRAY_MAX / 2)
+				container.toArray();
+		}
+		else
+		{
+			auto pos = std::lower_bound(container.array.begin(), container.array.end(), low);
+			if (pos == container.array.end() || *pos != low)
+				return;
+
+			container.array.erase(pos);
+			container.cardinality--;
+		}
+
+		if (container.cardinality == 0)
+			mContainers.erase(it);
+	}
+
+	bool RoaringBitmap::contains(uint32_t value) const
+	{
+		const Container* container = findContainer((uint16_t)(value >> 16));
+		return container != nullptr && container->contains((uint16_t)(value & 0xFFFF));
+	}
+
+	size_t RoaringBitmap::cardinality() const
+	{
+		size_t ret = 0;
+		for (auto& container : mContainers)
+			ret += container.cardinality;
+
+		return ret;
+	}
+
+	void RoaringBitmap::unite(Container& dst, const Container& src)
+	{
+		if (!dst.isBitmap() && !src.isBitmap())
+		{
+			std::vector<uint16_t> merged;
+			merged.reserve(dst.array.size() + src.array.size());
+			std::set_union(dst.array.cbegin(), dst.array.cend(), src.array.cbegin(), src.array.cend(), std::back_inserter(merged));
+
+			dst.array.swap(merged);
+			dst.cardinality = (int)dst.array.size();
+
+			if (dst.cardinality > ARRAY_MAX)
+				dst.toBitmap();
+
+			return;
+		}
+
+		if (!dst.isBitmap())
+			dst.toBitmap();
+
+		if (src.isBitmap())
+		{
+			dst.cardinality = 0;
+			for (int i = 0; i < BITMAP_WORDS; i++)
+			{
+				dst.bitmap[i] |= src.bitmap[i];
+				dst.cardinality += popCount(dst.bitmap[i]);
+			}
+		}
+		else
+		{
+			for (auto value : src.array)
+			{
+				uint64_t& word = dst.bitmap[value >> 6];
+				uint64_t mask = (uint64_t)1 << (value & 63);
+				if ((word & mask) == 0)
+				{
+					word |= mask;
+					dst.cardinality++;
+				}
+			}
+		}
+	}
+
+	void RoaringBitmap::intersect(Container& dst, const Container& src)
+	{
+		if (!dst.isBitmap())
+		{
+			std::vector<uint16_t> values;
+			values.reserve(dst.array.size());
+
+			if (src.isBitmap())
+			{
+				for (auto value : dst.array)
+					if (src.contains(value))
+						values.push_back(value);
+			}
+			else
+				std::set_intersection(dst.array.cbegin(), dst.array.cend(), src.array.cbegin(), src.array.cend(), std::back_inserter(values));
+
+			dst.array.swap(values);
+			dst.cardinality = (int)dst.array.size();
+			return;
+		}
+
+		if (!src.isBitmap())
+		{
+			std::vector<uint16_t> values;
+			values.reserve(src.array.size());
+
+			for (auto value : src.array)
+				if (dst.contains(value))
+					values.push_back(value);
+
+			dst.bitmap.clear();
+			dst.bitmap.shrink_to_fit();
+			dst.array.swap(values);
+			dst.cardinality = (int)dst.array.size();
+			return;
+		}
+
+		dst.cardinality = 0;
+		for (int i = 0; i < BITMAP_WORDS; i++)
+		{
+			dst.bitmap[i] &= src.bitmap[i];
+			dst.cardinality += popCount(dst.bitmap[i]);
+		}
+
+		if (dst.cardinality <= ARRAY_MAX)
+			dst.toArray();
+	}
+
+	size_t RoaringBitmap::intersectCardinality(const Container& a, const Container& b)
+	{
+		size_t ret = 0;
+
+		if (a.isBitmap() && b.isBitmap())
+		{
+			for (int i = 0; i < BITMAP_WORDS; i++)
+				ret += popCount(a.bitmap[i] & b.bitmap[i]);
+
+			return ret;
+		}
+
+		if (a.isBitmap() || b.isBitmap())
+		{
+			const Container& arr = a.isBitmap() ? b : a;
+			const Container& bmp = a.isBitmap() ? a : b;
+
+			for (auto value : arr.array)
+				if (bmp.contains(value))
+					ret++;
+
+			return ret;
+		}
+
+		auto ia = a.array.cbegin();
+		auto ib = b.array.cbegin();
+
+		while (ia != a.array.cend() && ib != b.array.cend())
+		{
+			if (*ia < *ib)
+				ia++;
+			else if (*ib < *ia)
+				ib++;
+			else
+			{
+				ret++;
+				ia++;
+				ib++;
+			}
+		}
+
+		return ret;
+	}
+
+	RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other)
+	{
+		std::vector<Container> containers;
+		containers.reserve(mContainers.size() + other.mContainers.size());
+
+		auto it = mContainers.begin();
+		auto ot = other.mContainers.cbegin();
+
+		while (it != mContainers.end() || ot != other.mContainers.cend())
+		{
+			if (ot == other.mContainers.cend() || (it != mContainers.end() && it->key < ot->key))
+				containers.push_back(std::move(*it++));
+			else if (it == mContainers.end() || ot->key < it->key)
+				containers.push_back(*ot++);
+			else
+			{
+				unite(*it, *ot++);
+				containers.push_back(std::move(*it++));
+			}
+		}
+
+		mContainers.swap(containers);
+		return *this;
+	}
+
+	RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other)
+	{
+		std::vector<Container> containers;
+
+		auto it = mContainers.begin();
+		auto ot = other.mContainers.cbegin();
+
+		while (it != mContainers.end() && ot != other.mContainers.cend())
+		{
+			if (it->key < ot->key)
+				it++;
+			else if (ot->key < it->key)
+				ot++;
+			else
+			{
+				intersect(*it, *ot++);
+				if (it->cardinality > 0)
+					containers.push_back(std::move(*it));
+
+				it++;
+			}
+		}
+
+		mContainers.swap(containers);
+		return *this;
+	}
+
+	size_t RoaringBitmap::andCardinality(const RoaringBitmap& a, const RoaringBitmap& b)
+	{
+		size_t ret = 0;
+
+		auto ia = a.mContainers.cbegin();
+		auto ib = b.mContainers.cbegin();
+
+		while (ia != a.mContainers.cend() && ib != b.mContainers.cend())
+		{
+			if (ia->key < ib->key)
+				ia++;
+			else if (ib->key < ia->key)
+				ib++;
+			else
+				ret += intersectCardinality(*ia++, *ib++);
+		}
+
+		return ret;
+	}
+}
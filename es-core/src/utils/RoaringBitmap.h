@@ -0,0 +1,62 @@
+#pragma once
+#ifndef ES_CORE_UTILS_ROARINGBITMAP_H
+#define ES_CORE_UTILS_ROARINGBITMAP_H
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Utils
+{
+	// Compressed set of 32 bits integers (roaring bitmap).
+	// Values are grouped by their high 16 bits : each group is stored as a sorted array while it holds less than
+	// 4096 values, as a 65536 bits bitmap past that. Sparse & dense sets both stay small, and unions/intersections
+	// work a whole group at once.
+	class RoaringBitmap
+	{
+	public:
+		void add(uint32_t value);
+		void remove(uint32_t value);
+		bool contains(uint32_t value) const;
+
+		void clear() { mContainers.clear(); }
+		bool empty() const { return mContainers.empty(); }
+		size_t cardinality() const;
+
+		RoaringBitmap& operator|=(const RoaringBitmap& other);
+		RoaringBitmap& operator&=(const RoaringBitmap& other);
+
+		static size_t andCardinality(const RoaringBitmap& a, const RoaringBitmap& b);
+
+	private:
+		struct Container
+		{
+			Container() : key(0), cardinality(0) { }
+
+			uint16_t key;
+			int cardinality;
+			std::vector<uint16_t> array;	// sorted values, while cardinality <= ARRAY_MAX
+			std::vector<uint64_t> bitmap;	// 1024 words past that, until removals bring it back to ARRAY_MAX / 2
+
+			bool isBitmap() const { return !bitmap.empty(); }
+			bool contains(uint16_t value) const;
+
+			void toBitmap();
+			void toArray();
+		};
+
+		static const int ARRAY_MAX = 4096;
+		static const int BITMAP_WORDS = 1024;
+
+		static void unite(Container& dst, const Container& src);
+		static void intersect(Container& dst, const Container& src);
+		static size_t intersectCardinality(const Container& a, const Container& b);
+
+		Container* findContainer(uint16_t key);
+		const Container* findContainer(uint16_t key) const;
+
+		std::vector<Container> mContainers; // sorted by key
+	};
+}
+
+#endif // ES_CORE_UTILS_ROARINGBITMAP_H
@@ -707,6 +707,31 @@ namespace Utils
 			}
 		}
 
+		std::string toSortKey(const std::string& _string)
+		{
+			// UTF-8 keeps the order of the code points : the key is the upper case string
+			std::string key;
+			key.reserve(_string.size());
+
+			size_t p = 0;
+			while (p < _string.size())
+			{
+				char c = _string[p];
+				if ((c & 0x80) == 0)
+				{
+					if (c == 0)
+						break;
+
+					key += (c >= 'a' && c <= 'z') ? (char)(c - 0x20) : c;
+					p++;
+				}
+				else
+					key += unicode2Chars(toupperUnicode(chars2Unicode(_string, p)));
+			}
+
+			return key;
+		}
+
 		bool containsIgnoreCase(const std::string & _string, const std::string & _what)
 		{
 			auto it = std::search(
@@ -719,6 +744,11 @@ namespace Utils
 		}
 		
 		bool containsIgnoreCasePinyin(const std::string & _string, const std::string & _what)
+		{
+			return containsPinyinInitials(getPinyinInitials(_string), _what);
+		}
+
+		std::vector<const char*> getPinyinInitials(const std::string & _string)
 		{
 			std::vector<const char*> vpinyin;
 			size_t len = _string.size();
@@ -740,7 +770,15 @@ namespace Utils
 					}
 				}
 			}
-			if (!ret) return false; // all chars < 0x80
+			if (!ret) vpinyin.clear(); // all chars < 0x80
+
+			return vpinyin;
+		}
+
+		bool containsPinyinInitials(const std::vector<const char*>& vpinyin, const std::string & _what)
+		{
+			if (vpinyin.empty())
+				return false;
 
 			auto it = std::search(
 				vpinyin.begin(), vpinyin.end(),
@@ -957,6 +995,20 @@ namespace Utils
 			return count;
 		}
 
+		unsigned long long hash64(const std::string& _string)
+		{
+			// FNV-1a
+			unsigned long long hash = 14695981039346656037ULL;
+
+			for (auto c : _string)
+			{
+				hash ^= (unsigned char)c;
+				hash *= 1099511628211ULL;
+			}
+
+			return hash;
+		}
+
 		bool isPrintableChar(char c)
 		{			
 #if defined(_WIN32)
@@ -36,10 +36,14 @@ namespace Utils
 
 		std::string join(const std::vector<std::string>& items, std::string separator);
 		int			compareIgnoreCase(const std::string& name1, const std::string& name2);
+		std::string	toSortKey(const std::string& _string); // Byte strings that compare like compareIgnoreCase
 		std::string proper(const std::string& _string);
 		std::string removeHtmlTags(const std::string& html);
 		bool        containsIgnoreCase(const std::string & _string, const std::string & _what);
 		bool        containsIgnoreCasePinyin(const std::string & _string, const std::string & _what);
+		// Pinyin initials of each character (nullptr if unknown), empty if the string has no multibyte character
+		std::vector<const char*> getPinyinInitials(const std::string & _string);
+		bool        containsPinyinInitials(const std::vector<const char*>& _initials, const std::string & _what);
 		bool		startsWithIgnoreCase(const std::string& name1, const std::string& name2);
 
 		int			toInteger(const std::string& string);
@@ -53,6 +57,7 @@ namespace Utils
 		std::string padLeft(const std::string& data, const size_t& totalWidth, const char& padding);
 
 		int			occurs(const std::string& str, char target);
+		unsigned long long hash64(const std::string& _string);
 		bool		isPrintableChar(char c);
 
 #if defined(_WIN32)
@@ -8,76 +8,204 @@
 
 namespace Utils
 {
-	ThreadPool::ThreadPool(int threadByCore) : mRunning(false), mWaiting(false), mNumWork(0)
+	static thread_local ThreadPool* tlsPool = nullptr;
+	static thread_local int tlsWorkerId = -1;
+
+	ThreadPool::ThreadPool(int threadByCore) : mRunning(false), mExit(false), mNumWork(0), mNumQueued(0), mNumPriority(0), mNextQueue(0)
 	{
-		mThreadByCore = threadByCore;
+		mThreadCount = threadByCore < 0 ? abs(threadByCore) : std::thread::hardware_concurrency() * threadByCore;
+		if (mThreadCount <= 0)
+			mThreadCount = 1;
+
+		for (int i = 0; i < mThreadCount; i++)
+			mQueues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mExit = true;
+			mRunning = false;
+		}
+
+		mWorkAvailable.notify_all();
+
+		for (std::thread& t : mThreads)
+			if (t.joinable())
+				t.join();
 	}
 
 	void ThreadPool::start()
 	{
-		mRunning = true;
+		// A pool shared by several loaders can be started by their threads at the same time
+		std::unique_lock<std::mutex> startLock(mStartLock);
+
+		if (mRunning)
+			return;
+
+		// Threads left by a cancel() have already exited
+		for (std::thread& t : mThreads)
+			if (t.joinable())
+				t.join();
 
-		size_t num_threads = mThreadByCore < 0 ? abs(mThreadByCore) : std::thread::hardware_concurrency() * mThreadByCore;
+		mThreads.clear();
 
-		auto doWork = [&](size_t id)
 		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mRunning = true;
+		}
+
+		mThreads.reserve(mThreadCount);
+
+		for (int i = 0; i < mThreadCount; i++)
+			mThreads.push_back(std::thread(&ThreadPool::doWork, this, i));
+	}
+
+	void ThreadPool::doWork(int id)
+	{
 #if WIN32
-			auto mask = (static_cast<DWORD_PTR>(1) << id);
-			SetThreadAffinityMask(GetCurrentThread(), mask);
+		auto mask = (static_cast<DWORD_PTR>(1) << id);
+		SetThreadAffinityMask(GetCurrentThread(), mask);
 #endif
 
-			while (mRunning)
+		tlsPool = this;
+		tlsWorkerId = id;
+
+		work_function work;
+
+		while (true)
+		{
+			if (popWorkItem(id, work))
 			{
-				_mutex.lock();
-				if (!mWorkQueue.empty())
-				{
-					auto work = mWorkQueue.front();
-					mWorkQueue.pop();
-					_mutex.unlock();
-
-					try
-					{
-						work();
-					}
-					catch (...) {}
-					
-					mNumWork--;
-				}
-				else
-				{
-					_mutex.unlock();
+				execute(work);
+				continue;
+			}
 
-					// Extra code : Exit finished threads
-					if (mWaiting)
-						return;
+			std::unique_lock<std::mutex> lock(mLock);
+			mWorkAvailable.wait(lock, [this] { return mExit || !mRunning || mNumQueued.load() > 0; });
 
-					std::this_thread::yield();
-					std::this_thread::sleep_for(std::chrono::milliseconds(1));
-				}
+			if (mExit || !mRunning)
+				break;
+		}
+
+		tlsPool = nullptr;
+		tlsWorkerId = -1;
+	}
+
+	bool ThreadPool::popWorkItem(int id, work_function& work)
+	{
+		if (mNumPriority.load() > 0)
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			if (!mPriorityQueue.empty())
+			{
+				auto it = mPriorityQueue.begin();
+				work = std::move(it->second);
+				mPriorityQueue.erase(it);
+				mNumPriority--;
+				mNumQueued--;
+				return true;
 			}
-		};
+		}
+
+		// Own queue first, oldest item first
+		if (id >= 0)
+		{
+			auto queue = mQueues[id].get();
 
-		mThreads.reserve(num_threads);
+			std::unique_lock<std::mutex> lock(queue->lock);
+			if (!queue->items.empty())
+			{
+				work = std::move(queue->items.front());
+				queue->items.pop_front();
+				mNumQueued--;
+				return true;
+			}
+		}
+
+		// Steal the most recent item of another worker
+		for (int i = 1; i <= mThreadCount; i++)
+		{
+			int victim = (id + i) % mThreadCount;
+			if (victim == id)
+				continue;
+
+			auto queue = mQueues[victim].get();
+
+			std::unique_lock<std::mutex> lock(queue->lock);
+			if (!queue->items.empty())
+			{
+				work = std::move(queue->items.back());
+				queue->items.pop_back();
+				mNumQueued--;
+				return true;
+			}
+		}
 
-		for (size_t i = 0; i < num_threads; i++)
-			mThreads.push_back(std::thread(doWork, i));
+		return false;
 	}
 
-	ThreadPool::~ThreadPool()
+	void ThreadPool::execute(work_function& work)
 	{
-		mRunning = false;
+		try
+		{
+			work();
+		}
+		catch (...) {}
 
-		for (std::thread& t : mThreads)
-			if (t.joinable())
-				t.join();
+		// Release captured objects before signaling completion
+		work = nullptr;
+
+		if (--mNumWork == 0)
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mWorkDone.notify_all();
+		}
 	}
 
-	void ThreadPool::queueWorkItem(work_function work)
+	void ThreadPool::queueWorkItem(work_function work, int priority)
 	{
-		_mutex.lock();
-		mWorkQueue.push(work);
+		// Counters are raised first so the pending item is never missed by a waiter
 		mNumWork++;
-		_mutex.unlock();
+		mNumQueued++;
+
+		if (priority > 0)
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mPriorityQueue.emplace(priority, std::move(work));
+			mNumPriority++;
+		}
+		else
+		{
+			int id = (tlsPool == this && tlsWorkerId >= 0) ? tlsWorkerId : (int)(mNextQueue++ % mThreadCount);
+
+			auto queue = mQueues[id].get();
+
+			std::unique_lock<std::mutex> lock(queue->lock);
+			queue->items.push_back(std::move(work));
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+		}
+
+		mWorkAvailable.notify_one();
+	}
+
+	bool ThreadPool::runPendingWorkItem()
+	{
+		work_function work;
+		if (!popWorkItem(tlsPool == this ? tlsWorkerId : -1, work))
+			return false;
+
+		execute(work);
+		return true;
+	}
+
+	bool ThreadPool::isWorkerThread()
+	{
+		return tlsPool == this;
 	}
 
 	void ThreadPool::wait()
@@ -85,9 +213,8 @@ namespace Utils
 		if (!mRunning)
 			start();
 
-		mWaiting = true;
-		while (mNumWork.load() > 0)
-			std::this_thread::yield();
+		std::unique_lock<std::mutex> lock(mLock);
+		mWorkDone.wait(lock, [this] { return mNumWork.load() == 0; });
 	}
 
 	void ThreadPool::wait(work_function work, int delay)
@@ -95,34 +222,127 @@ namespace Utils
 		if (!mRunning)
 			start();
 
-		mWaiting = true;
-
 		while (mNumWork.load() > 0)
 		{
 			work();
 
-			std::this_thread::yield();
-			std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+			std::unique_lock<std::mutex> lock(mLock);
+			mWorkDone.wait_for(lock, std::chrono::milliseconds(delay), [this] { return mNumWork.load() == 0; });
 		}
 	}
 
-	void ThreadPool::stop()
+	void ThreadPool::clearQueues()
 	{
-		_mutex.lock();
+		size_t removed = 0;
 
-		while (!mWorkQueue.empty())
+		for (auto& queue : mQueues)
 		{
-			mNumWork--;
-			mWorkQueue.pop();
+			std::unique_lock<std::mutex> lock(queue->lock);
+			removed += queue->items.size();
+			queue->items.clear();
 		}
-		
-		_mutex.unlock();
-		mWaiting = true;
 
-		while (mNumWork.load() > 0)
 		{
-			std::this_thread::yield();
-			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			std::unique_lock<std::mutex> lock(mLock);
+			removed += mPriorityQueue.size();
+			mNumPriority -= mPriorityQueue.size();
+			mPriorityQueue.clear();
+
+			mNumQueued -= removed;
+			mNumWork -= removed;
 		}
+
+		mWorkDone.notify_all();
+	}
+
+	void ThreadPool::cancel()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mRunning = false;
+		}
+
+		mWorkAvailable.notify_all();
+		clearQueues();
+	}
+
+	void ThreadPool::stop()
+	{
+		clearQueues();
+
+		std::unique_lock<std::mutex> lock(mLock);
+		mWorkDone.wait(lock, [this] { return mNumWork.load() == 0; });
+	}
+
+	// TaskGroup
+
+	TaskGroup::TaskGroup(ThreadPool* pool) : mPool(pool), mState(std::make_shared<State>())
+	{
+
+	}
+
+	TaskGroup::~TaskGroup()
+	{
+		wait();
+	}
+
+	void TaskGroup::run(ThreadPool::work_function work, int priority)
+	{
+		// The token is released when the item has run, or when it is dropped by a cancel/stop of the pool
+		struct PendingToken
+		{
+			PendingToken(const std::shared_ptr<State>& state) : state(state) { state->pending++; }
+
+			~PendingToken()
+			{
+				if (--state->pending == 0)
+				{
+					std::unique_lock<std::mutex> lock(state->lock);
+					state->done.notify_all();
+				}
+			}
+
+			std::shared_ptr<State> state;
+		};
+
+		auto token = std::make_shared<PendingToken>(mState);
+
+		mPool->queueWorkItem([token, work]
+		{
+			if (!token->state->canceled)
+				work();
+		}, priority);
+	}
+
+	void TaskGroup::wait()
+	{
+		if (mPool->isWorkerThread())
+		{
+			// Waiting from a worker : help instead of blocking, or nested groups could starve the pool
+			while (mState->pending.load() > 0)
+			{
+				if (mPool->runPendingWorkItem())
+					continue;
+
+				std::unique_lock<std::mutex> lock(mState->lock);
+				mState->done.wait_for(lock, std::chrono::milliseconds(1), [this] { return mState->pending.load() == 0; });
+			}
+
+			return;
+		}
+
+		if (mState->pending.load() == 0)
+			return;
+
+		if (!mPool->isRunning())
+			mPool->start();
+
+		std::unique_lock<std::mutex> lock(mState->lock);
+		mState->done.wait(lock, [this] { return mState->pending.load() == 0; });
+	}
+
+	void TaskGroup::cancel()
+	{
+		mState->canceled = true;
 	}
 }
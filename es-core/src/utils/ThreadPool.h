@@ -3,12 +3,21 @@
 
 #include <thread>
 #include <mutex>
-#include <queue>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <vector>
+#include <memory>
+#include <future>
 #include <atomic>
 #include <functional>
 
 namespace Utils
 {
+	// Work-stealing thread pool.
+	// Every worker owns a deque : external work items are dealt round-robin, items queued from a worker
+	// stay on its own deque. Idle workers steal from the others, then sleep on a condition variable.
+	// Items queued with a priority > 0 are run before any normal item, highest priority first.
 	class ThreadPool
 	{
 	public:
@@ -18,23 +27,89 @@ namespace Utils
 		~ThreadPool();
 
 		void start();
-		void queueWorkItem(work_function work);
+		void queueWorkItem(work_function work, int priority = 0);
 		void wait();
 		void wait(work_function work, int delay = 50);
-		void cancel() { mRunning = false; }
+		void cancel();
 		void stop();
 
 		bool isRunning() { return mRunning; }
 
+		template<typename F>
+		auto queueTask(F func, int priority = 0) -> std::future<decltype(func())>
+		{
+			typedef decltype(func()) result_type;
+
+			auto task = std::make_shared<std::packaged_task<result_type()>>(func);
+			auto ret = task->get_future();
+			queueWorkItem([task] { (*task)(); }, priority);
+			return ret;
+		}
+
+		// Runs one pending item on the calling thread, if any. Used to avoid deadlocks when a work item waits for others
+		bool runPendingWorkItem();
+
+		// Returns true if the calling thread is one of this pool's workers
+		bool isWorkerThread();
+
 	private:
-		bool mRunning;
-		bool mWaiting;
-		std::queue<work_function> mWorkQueue;
-		std::atomic<size_t> mNumWork;
-		std::mutex _mutex;
+		struct WorkerQueue
+		{
+			std::mutex lock;
+			std::deque<work_function> items;
+		};
+
+		bool popWorkItem(int id, work_function& work);
+		void execute(work_function& work);
+		void clearQueues();
+		void doWork(int id);
+
+		std::atomic<bool> mRunning;
+		bool mExit;
+
+		std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+		std::multimap<int, work_function, std::greater<int>> mPriorityQueue;
+
+		std::atomic<size_t> mNumWork;	// Queued + running items
+		std::atomic<size_t> mNumQueued;	// Queued items
+		std::atomic<size_t> mNumPriority;
+		std::atomic<size_t> mNextQueue;
+
+		std::mutex mLock;						// Protects mPriorityQueue, mExit & worker sleep
+		std::condition_variable mWorkAvailable;
+		std::condition_variable mWorkDone;
+
+		std::mutex mStartLock;					// Protects mThreads
 		std::vector<std::thread> mThreads;
-		int mThreadByCore;
+		int mThreadCount;
+	};
+
+	// Set of work items sharing a pool, that can be waited for or canceled independently of the pool's other work.
+	class TaskGroup
+	{
+	public:
+		TaskGroup(ThreadPool* pool);
+		~TaskGroup();
+
+		void run(ThreadPool::work_function work, int priority = 0);
+		void wait();
+		void cancel();
+
+		bool isCanceled() { return mState->canceled; }
+
+	private:
+		struct State
+		{
+			State() : pending(0), canceled(false) { }
+
+			std::atomic<size_t> pending;
+			std::atomic<bool> canceled;
+			std::mutex lock;
+			std::condition_variable done;
+		};
 
+		ThreadPool* mPool;
+		std::shared_ptr<State> mState;
 	};
 }
 